@@ -0,0 +1,202 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "Chess/Bitboard.hpp"
+
+//-----------------------------------------------------------------------------
+//! \brief Table of 64 bitboards indexed by a square. Wrapped in a structure
+//! because std::array cannot be modified inside a C++14 constexpr function.
+//-----------------------------------------------------------------------------
+struct SquareTable
+{
+    bitboard sq[NbSquares];
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Directions of sliding pieces expressed as (row, column) offsets in
+//! the 8x8 matrix. The four first directions increase the square index (the
+//! first piece on the ray is the least significant bit) and the four last
+//! ones decrease it (the first piece is the most significant bit).
+//-----------------------------------------------------------------------------
+enum Ray { East, South, SouthEast, SouthWest, West, North, NorthEast, NorthWest };
+constexpr int c_ray_rows[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+constexpr int c_ray_cols[8] = { 1, 0, 1, -1, -1, 0, 1, -1 };
+
+//-----------------------------------------------------------------------------
+//! \brief Return the bitboard of the square (row, col) or 0 if outside the
+//! chessboard.
+//-----------------------------------------------------------------------------
+constexpr bitboard square(const int row, const int col)
+{
+    return ((row < 0) || (row > 7) || (col < 0) || (col > 7))
+            ? 0u : bit(uint8_t(row * 8 + col));
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Compute the table of leaper attacks (knight, king) from their list
+//! of relative (row, column) displacements.
+//-----------------------------------------------------------------------------
+template<size_t N>
+constexpr SquareTable leaperTable(const int (&rows)[N], const int (&cols)[N])
+{
+    SquareTable t{};
+    for (int sq = 0; sq < NbSquares; ++sq)
+    {
+        for (size_t i = 0u; i < N; ++i)
+        {
+            t.sq[sq] |= square(ROW(sq) + rows[i], COL(sq) + cols[i]);
+        }
+    }
+    return t;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Compute the table of squares of a ray (excluding the origin square)
+//! until the border of the chessboard.
+//-----------------------------------------------------------------------------
+constexpr SquareTable rayTable(const Ray ray)
+{
+    SquareTable t{};
+    for (int sq = 0; sq < NbSquares; ++sq)
+    {
+        int r = ROW(sq) + c_ray_rows[ray];
+        int c = COL(sq) + c_ray_cols[ray];
+        while (square(r, c))
+        {
+            t.sq[sq] |= square(r, c);
+            r += c_ray_rows[ray];
+            c += c_ray_cols[ray];
+        }
+    }
+    return t;
+}
+
+constexpr int c_knight_rows[8] = { -2, -1, 1, 2, 2, 1, -1, -2 };
+constexpr int c_knight_cols[8] = { 1, 2, 2, 1, -1, -2, -2, -1 };
+constexpr int c_king_rows[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+constexpr int c_king_cols[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+constexpr int c_wpawn_rows[2] = { -1, -1 };
+constexpr int c_bpawn_rows[2] = { 1, 1 };
+constexpr int c_pawn_cols[2] = { -1, 1 };
+
+//! \brief Precomputed knight attacks.
+static constexpr SquareTable c_knight_attacks = leaperTable(c_knight_rows, c_knight_cols);
+//! \brief Precomputed king attacks.
+static constexpr SquareTable c_king_attacks = leaperTable(c_king_rows, c_king_cols);
+//! \brief Precomputed pawn attacks indexed by [enum Color].
+static constexpr SquareTable c_pawn_attacks[2] =
+{
+    [Color::Black] = leaperTable(c_bpawn_rows, c_pawn_cols),
+    [Color::White] = leaperTable(c_wpawn_rows, c_pawn_cols),
+};
+//! \brief Precomputed rays indexed by [enum Ray].
+static constexpr SquareTable c_rays[8] =
+{
+    rayTable(East), rayTable(South), rayTable(SouthEast), rayTable(SouthWest),
+    rayTable(West), rayTable(North), rayTable(NorthEast), rayTable(NorthWest),
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Sliding attacks along a ray: the ray is cut after the first piece
+//! found (the nearest piece is the lsb for positive rays and the msb for
+//! negative rays).
+//-----------------------------------------------------------------------------
+template<Ray ray>
+static inline bitboard rayAttacks(const uint8_t sq, const bitboard occupancy)
+{
+    bitboard attacks = c_rays[ray].sq[sq];
+    const bitboard blockers = attacks & occupancy;
+    if (blockers)
+    {
+        const uint8_t b = (ray < West) ? lsb(blockers) : msb(blockers);
+        attacks ^= c_rays[ray].sq[b];
+    }
+    return attacks;
+}
+
+//-----------------------------------------------------------------------------
+bitboard knightAttacks(const uint8_t sq)
+{
+    return c_knight_attacks.sq[sq];
+}
+
+//-----------------------------------------------------------------------------
+bitboard kingAttacks(const uint8_t sq)
+{
+    return c_king_attacks.sq[sq];
+}
+
+//-----------------------------------------------------------------------------
+bitboard pawnAttacks(const Color side, const uint8_t sq)
+{
+    return c_pawn_attacks[side].sq[sq];
+}
+
+//-----------------------------------------------------------------------------
+bitboard bishopAttacks(const uint8_t sq, const bitboard occupancy)
+{
+    return rayAttacks<NorthEast>(sq, occupancy) | rayAttacks<NorthWest>(sq, occupancy)
+         | rayAttacks<SouthEast>(sq, occupancy) | rayAttacks<SouthWest>(sq, occupancy);
+}
+
+//-----------------------------------------------------------------------------
+bitboard rookAttacks(const uint8_t sq, const bitboard occupancy)
+{
+    return rayAttacks<North>(sq, occupancy) | rayAttacks<South>(sq, occupancy)
+         | rayAttacks<East>(sq, occupancy) | rayAttacks<West>(sq, occupancy);
+}
+
+//-----------------------------------------------------------------------------
+void Bitboards::clear()
+{
+    for (auto& color: pieces)
+        for (auto& type: color)
+            type = 0u;
+    colors[Color::White] = colors[Color::Black] = 0u;
+    occupied = 0u;
+}
+
+//-----------------------------------------------------------------------------
+void Bitboards::load(chessboard const& board)
+{
+    clear();
+    for (uint8_t ij = 0u; ij < NbSquares; ++ij)
+    {
+        if (board[ij].type != PieceType::Empty)
+        {
+            add(ij, board[ij]);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+bitboard Bitboards::attackers(const uint8_t sq, const Color side, const bitboard occ) const
+{
+    bitboard const* p = pieces[side];
+    const bitboard queens = p[PieceType::Queen];
+
+    // Note: a pawn of color side attacks sq if a pawn of the opposite color
+    // placed on sq would attack the pawn.
+    return (pawnAttacks(opposite(side), sq) & p[PieceType::Pawn])
+         | (knightAttacks(sq) & p[PieceType::Knight])
+         | (kingAttacks(sq) & p[PieceType::King])
+         | (bishopAttacks(sq, occ) & (p[PieceType::Bishop] | queens))
+         | (rookAttacks(sq, occ) & (p[PieceType::Rook] | queens));
+}
@@ -0,0 +1,154 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef CHESS_BITBOARD_HPP
+#  define CHESS_BITBOARD_HPP
+
+#  include "Chess/Board.hpp"
+#  include <cstdint>
+
+//! \brief A bitboard is a set of chessboard squares stored in a 64-bit
+//! integer: the bit i is set when the square i (enum Square) belongs to
+//! the set. Note that with our enum Square, A8 is the bit 0 and H1 is the
+//! bit 63: going north decreases the bit index.
+using bitboard = uint64_t;
+
+//! \brief Return the bitboard holding the single square sq.
+constexpr bitboard bit(const uint8_t sq) { return bitboard(1) << sq; }
+
+//! \brief Return the least significant square of a non empty bitboard.
+inline uint8_t lsb(const bitboard b)
+{
+    assert(b != 0u);
+    return uint8_t(__builtin_ctzll(b));
+}
+
+//! \brief Return the most significant square of a non empty bitboard.
+inline uint8_t msb(const bitboard b)
+{
+    assert(b != 0u);
+    return uint8_t(63 - __builtin_clzll(b));
+}
+
+//! \brief Return and remove the least significant square of a non empty
+//! bitboard.
+inline uint8_t popLsb(bitboard& b)
+{
+    const uint8_t sq = lsb(b);
+    b &= b - 1u;
+    return sq;
+}
+
+//! \brief Return the number of squares in the bitboard.
+inline int popCount(const bitboard b)
+{
+    return __builtin_popcountll(b);
+}
+
+namespace Bitboard
+{
+    //! \brief Squares of the column A.
+    constexpr bitboard ColA = 0x0101010101010101ull;
+    //! \brief Squares of the column H.
+    constexpr bitboard ColH = ColA << 7;
+    //! \brief Squares of the row 8 (row 0 of the 8x8 matrix).
+    constexpr bitboard Row8 = 0x00000000000000FFull;
+    //! \brief Squares of the row 6 (row 2 of the 8x8 matrix).
+    constexpr bitboard Row6 = Row8 << 16;
+    //! \brief Squares of the row 3 (row 5 of the 8x8 matrix).
+    constexpr bitboard Row3 = Row8 << 40;
+    //! \brief Squares of the row 1 (row 7 of the 8x8 matrix).
+    constexpr bitboard Row1 = Row8 << 56;
+}
+
+//! \brief Squares attacked by a knight placed on the square sq.
+bitboard knightAttacks(const uint8_t sq);
+
+//! \brief Squares attacked by a king placed on the square sq.
+bitboard kingAttacks(const uint8_t sq);
+
+//! \brief Squares attacked (diagonal takes) by a pawn of the given color
+//! placed on the square sq.
+bitboard pawnAttacks(const Color side, const uint8_t sq);
+
+//! \brief Squares attacked by a bishop placed on the square sq. The
+//! occupancy stops the slide on the first encountered piece (included).
+bitboard bishopAttacks(const uint8_t sq, const bitboard occupancy);
+
+//! \brief Squares attacked by a rook placed on the square sq. The
+//! occupancy stops the slide on the first encountered piece (included).
+bitboard rookAttacks(const uint8_t sq, const bitboard occupancy);
+
+//! \brief Squares attacked by a queen placed on the square sq.
+inline bitboard queenAttacks(const uint8_t sq, const bitboard occupancy)
+{
+    return bishopAttacks(sq, occupancy) | rookAttacks(sq, occupancy);
+}
+
+// *****************************************************************************
+//! \brief Chessboard position stored as bitboards: one set per color and
+//! per type of piece plus the occupancy of each side. This is an alternative
+//! representation of the chessboard (the 8x8 matrix) used by the Rules class
+//! when compiled with USE_BITBOARDS.
+// *****************************************************************************
+struct Bitboards
+{
+    //! \brief Remove all pieces.
+    void clear();
+
+    //! \brief Fill bitboards from the 8x8 matrix representation.
+    void load(chessboard const& board);
+
+    //! \brief Place the piece p on the empty square sq.
+    inline void add(const uint8_t sq, const Piece p)
+    {
+        pieces[p.color][p.type] |= bit(sq);
+        colors[p.color] |= bit(sq);
+        occupied |= bit(sq);
+    }
+
+    //! \brief Remove the piece p from the square sq.
+    inline void remove(const uint8_t sq, const Piece p)
+    {
+        pieces[p.color][p.type] &= ~bit(sq);
+        colors[p.color] &= ~bit(sq);
+        occupied &= ~bit(sq);
+    }
+
+    //! \brief Return the pieces of color side attacking the square sq with
+    //! the given board occupancy.
+    bitboard attackers(const uint8_t sq, const Color side, const bitboard occ) const;
+
+    //! \brief Return true if the square sq is attacked by a piece of the
+    //! color side.
+    inline bool attacked(const uint8_t sq, const Color side) const
+    {
+        return attackers(sq, side, occupied) != 0u;
+    }
+
+    //! \brief Set of pieces indexed by [enum Color][enum PieceType].
+    bitboard pieces[2][8];
+    //! \brief Set of pieces of each color indexed by [enum Color].
+    bitboard colors[2];
+    //! \brief Set of all pieces.
+    bitboard occupied;
+};
+
+#endif
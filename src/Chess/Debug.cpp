@@ -146,6 +146,15 @@ std::ostream& operator<<(std::ostream& os, const Status& s)
     case Status::Stalemate:
         os << "Stalemate";
         break;
+    case Status::Repetition:
+        os << "Draw by threefold repetition";
+        break;
+    case Status::FiftyMoves:
+        os << "Draw by the fifty-move rule";
+        break;
+    case Status::InsufficientMaterial:
+        os << "Draw by insufficient material";
+        break;
     case Status::InternalError:
         os << "Internal error";
         break;
@@ -158,11 +167,11 @@ std::ostream& operator<<(std::ostream& os, const Status& s)
 
 std::ostream& operator<<(std::ostream& os, const Move& move)
 {
-    if (move.castle & Castle::Little)
+    if (move.castle() & Castle::Little)
     {
         os << "O-O";
     }
-    else if (move.castle & Castle::Big)
+    else if (move.castle() & Castle::Big)
     {
         os << "O-O-O";
     }
@@ -172,18 +181,13 @@ std::ostream& operator<<(std::ostream& os, const Move& move)
         os << c_square_names[move.from] << '-' << c_square_names[move.to];
     }
 
-    if (move.ep)
+    if (move.ep())
     {
         os << "ep";
     }
-    else if (move.promote != PieceType::Empty)
-    {
-        os << ':' << c_white_piece_char[move.promote];
-    }
-
-    if (move.check)
+    else if (move.promote() != PieceType::Empty)
     {
-        os << "+";
+        os << ':' << c_white_piece_char[move.promote()];
     }
 
     return os;
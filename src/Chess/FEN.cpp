@@ -143,8 +143,20 @@ bool Rules::import(std::string const& fen)
         m_ep = toSquare(&fen[i]);
     else goto l_err_ep;
 
-    // Ignore other part (half move)
-    // ++i;
+    // Optional number of plies since the last capture or pawn move (fifty-move
+    // rule). Ignore the number of moves.
+    m_halfmove = 0u;
+    i += (fen[i] == '-') ? 1u : 2u;
+    if ((i < fen.size()) && (fen[i] == ' '))
+    {
+        uint32_t halfmove = 0u;
+        while ((++i < fen.size()) && (fen[i] >= '0') && (fen[i] <= '9'))
+        {
+            halfmove = 10u * halfmove + uint32_t(fen[i] - '0');
+            if (halfmove > 0xFFFFu) goto l_err_halfmove;
+        }
+        m_halfmove = uint16_t(halfmove);
+    }
 
     // Success
     return true;
@@ -199,6 +211,11 @@ l_err_ep:
     std::cerr << "Bad FEN format" << i << ": invalid en passant format" << std::endl;
     std::cerr << fen << std::endl << std::string(i-1, ' ') << '^' << std::endl;
     return false;
+
+l_err_halfmove:
+    std::cerr << "Bad FEN format" << i << ": invalid half move clock" << std::endl;
+    std::cerr << fen << std::endl << std::string(i-1, ' ') << '^' << std::endl;
+    return false;
 }
 
 /*std::string export(const chessboard& board)
@@ -22,138 +22,224 @@
 #define MOVE_HPP
 
 #  include "Chess/Board.hpp"
+#  include <algorithm>
 
 //! \brief Print the type of piece.
 enum Castle { NoCastle = 0u, Little = 1u, Big = 2u, Both = 3u };
 
+//! \brief Special moves stored in the 4 bits of Move::flag. Promotions are
+//! encoded as Promote + (PieceType - 1) for Rook, Knight, Bishop and Queen.
+enum MoveFlag { Quiet = 0u, DoubleMove = 1u, LittleCastle = 2u, BigCastle = 3u,
+                EnPassant = 4u, Promote = 8u };
+
 // ***********************************************************************************************
-//! \brief
+//! \brief Move packed on 16 bits: 6 bits for the origin square, 6 bits for
+//! the destination square and 4 bits for the special move (enum MoveFlag).
 // ***********************************************************************************************
 struct Move
 {
     Move()
     {}
 
+    Move(const uint8_t f, const uint8_t t, const uint8_t fl)
+        : from(f), to(t), flag(fl)
+    {}
+
     Move(std::string const& m)
+        : from(toSquare(&m[0])), to(toSquare(&m[2])), flag(MoveFlag::Quiet)
     {
-        from = toSquare(&m[0]);
-        to = toSquare(&m[2]);
-        promote = char2Piece(m[4]).type;
-        castle = Castle::NoCastle;
-        ep = false;
-        check = false;
-        double_move = false;
+        const PieceType promote = static_cast<PieceType>(char2Piece(m[4]).type);
+        if (promote != PieceType::Empty)
+        {
+            flag = MoveFlag::Promote + promote - PieceType::Rook;
+        }
     }
 
     inline bool operator==(Move const &other) const
     {
         return (from == other.from) && (to == other.to)
-                && (promote == other.promote);
+                && (promote() == other.promote());
+    }
+
+    //! \brief Return Castle::Little or Castle::Big for castle moves else
+    //! Castle::NoCastle.
+    inline Castle castle() const
+    {
+        return ((flag == MoveFlag::LittleCastle) || (flag == MoveFlag::BigCastle))
+                ? static_cast<Castle>(flag - 1u) : Castle::NoCastle;
     }
 
-    uint8_t from;
-    uint8_t to;
-    struct
+    //! \brief Return the promoted piece type or PieceType::Empty.
+    inline PieceType promote() const
     {
-        unsigned int castle        : 2; // enum Casttle
-        unsigned int promote       : 3; // PieceType
-        unsigned int ep            : 1; // En passant move
-        unsigned int check         : 1; // King check
-        unsigned int double_move   : 1; // pawn double move
-    };
-    // FIXME: ajouter car on a droit a 8 bits
-    // ep: case 8bits
-    // color: qui a joue
-    // valid: pseudo moves --> legal moves
-    // Piece qui a joue (pour prettyprint)
-    // prise: bool
+        return (flag & MoveFlag::Promote)
+                ? static_cast<PieceType>((flag & 3u) + PieceType::Rook)
+                : PieceType::Empty;
+    }
+
+    //! \brief En passant move ?
+    inline bool ep() const { return flag == MoveFlag::EnPassant; }
+
+    //! \brief Pawn double move ?
+    inline bool double_move() const { return flag == MoveFlag::DoubleMove; }
+
+    //! \brief Null move (origin and destination are the same square): never
+    //! legal, used when no move is known (ie transposition table entries).
+    static inline Move null() { return Move(0u, 0u, MoveFlag::Quiet); }
+
+    //! \brief Is the null move ?
+    inline bool isNull() const { return from == to; }
+
+    uint16_t from : 6;
+    uint16_t to   : 6;
+    uint16_t flag : 4; // enum MoveFlag
 
     //! \brief Used by the play() method when no move are available
     //! (like stalemate).
     static constexpr const char* none = "::none";
 };
 
+static_assert(sizeof(Move) == 2u, "Move shall be packed on 16 bits");
+
+//! \brief Return the move in UCI notation (ie "e2e4", "h7h8q").
+inline std::string toStrMove(Move const& move)
+{
+    std::string str = toStrMove(move.from, move.to);
+    if (move.promote() != PieceType::Empty)
+    {
+        str += piece2char(move.promote());
+    }
+    return str;
+}
+
+//! \brief Is the string a move in UCI notation (ie "e2e4", "e7e8q") ? To be
+//! checked before calling Move(std::string) on strings coming from outside
+//! (GUI, engines, users): the constructor does not check them.
+inline bool isWellFormed(std::string const& move)
+{
+    if ((move.size() != 4u) && (move.size() != 5u))
+        return false;
+
+    for (size_t i = 0u; i < 4u; i += 2u)
+    {
+        if ((move[i] < 'a') || (move[i] > 'h') || (move[i + 1u] < '1') || (move[i + 1u] > '8'))
+            return false;
+    }
+
+    return (move.size() == 4u) || (std::string("qrbn").find(move[4]) != std::string::npos);
+}
+
 struct CastleMove : public Move
 {
     CastleMove(const uint8_t f, const uint8_t t, const Castle c)
+        : Move(f, t, (c == Castle::Little) ? MoveFlag::LittleCastle : MoveFlag::BigCastle)
     {
         assert((c == Castle::Little) || (c == Castle::Big));
-        // && (from == sqE1) && (to == sq));
-
-        from = f;
-        to = t;
-        castle = c;
-        promote = PieceType::Empty;
-        ep = false;
-        check = false; // FIXME
-        double_move = 0;
     }
 };
 
 struct PieceMove : public Move
 {
     PieceMove(const uint8_t f, const uint8_t t)
+        : Move(f, t, MoveFlag::Quiet)
     {
-        from = f;
-        to =  t;
-        assert(from != to);
-
-        castle = Castle::NoCastle;
-        promote = PieceType::Empty;
-        ep = false;
-        check = false; // FIXME
-        double_move = 0;
+        assert(f != t);
     }
 };
 
 struct PawnSimpleMove : public Move
 {
     PawnSimpleMove(const uint8_t f, const uint8_t t, const bool e = false)
+        : Move(f, t, e ? MoveFlag::EnPassant : MoveFlag::Quiet)
     {
-        from = f;
-        to = t;
-        assert(from != to);
-
-        castle = Castle::NoCastle;
-        promote = PieceType::Empty;
-        ep = e;
-        check = false; // FIXME
-        double_move = false;
+        assert(f != t);
     }
 };
 
 struct PawnDoubleMove : public Move
 {
     PawnDoubleMove(const uint8_t f, const uint8_t t)
+        : Move(f, t, MoveFlag::DoubleMove)
     {
-        from = f;
-        to = t;
-        assert(from != to);
-
-        castle = Castle::NoCastle;
-        promote = PieceType::Empty;
-        ep = false;
-        check = false;  // FIXME
-        double_move = true;
+        assert(f != t);
     }
 };
 
 struct PromoteMove : public Move
 {
     PromoteMove(const uint8_t f, const uint8_t t, const PieceType p)
+        : Move(f, t, MoveFlag::Promote + p - PieceType::Rook)
     {
-        from = f;
-        to = t;
-        assert(from != to);
-
-        castle = Castle::NoCastle;
-        promote = p;
-        ep = false;
-        check = false;  // FIXME
-        double_move = false;
+        assert(f != t);
+        assert((p >= PieceType::Rook) && (p <= PieceType::Queen));
     }
 };
 
+//! \brief Max number of moves stored in a MoveList. The maximum number of
+//! legal moves known for a chess position is 218.
+constexpr uint16_t MaxMoves = 256u;
+
+// ***********************************************************************************************
+//! \brief Fixed capacity list of moves (no heap allocation) with the subset of
+//! the std::vector API used by the move generator.
+// ***********************************************************************************************
+class MoveList
+{
+public:
+
+    using iterator = Move*;
+    using const_iterator = Move const*;
+
+    MoveList()
+        : m_size(0u)
+    {}
+
+    //! \brief Only copy the used part of the list.
+    MoveList(MoveList const& other)
+        : m_size(other.m_size)
+    {
+        std::copy(other.begin(), other.end(), m_moves);
+    }
+
+    MoveList& operator=(MoveList const& other)
+    {
+        m_size = other.m_size;
+        std::copy(other.begin(), other.end(), m_moves);
+        return *this;
+    }
+
+    //! \brief Append the move. A full list is a bug of the generator (or a
+    //! garbage position loaded from a FEN): debug builds stop, release builds
+    //! drop the move instead of writing past the list.
+    inline void push_back(Move const& move)
+    {
+        assert((m_size < MaxMoves) && "MoveList is full");
+        if (m_size < MaxMoves)
+            m_moves[m_size++] = move;
+    }
+
+    inline void pop_back()
+    {
+        assert(m_size > 0u);
+        --m_size;
+    }
+
+    inline void clear() { m_size = 0u; }
+    inline size_t size() const { return m_size; }
+    inline bool empty() const { return m_size == 0u; }
+    inline Move& operator[](const size_t i) { return m_moves[i]; }
+    inline Move const& operator[](const size_t i) const { return m_moves[i]; }
+    inline iterator begin() { return m_moves; }
+    inline iterator end() { return m_moves + m_size; }
+    inline const_iterator begin() const { return m_moves; }
+    inline const_iterator end() const { return m_moves + m_size; }
+
+private:
+
+    Move     m_moves[MaxMoves];
+    uint16_t m_size;
+};
+
 //! \brief Pretty print a move note.
 std::ostream& operator<<(std::ostream& os, const Move& m);
 
@@ -0,0 +1,77 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "Chess/MoveGenerator.hpp"
+
+//-----------------------------------------------------------------------------
+MoveGenerator::MoveGenerator(Rules const& rules, const bool quiets)
+    : m_rules(rules), m_quiets(quiets), m_king(rules.findKing(rules.m_side))
+{
+    if (m_king != Square::OOB)
+    {
+        m_rules.computeKingSafety(m_king, m_safety);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool MoveGenerator::nextStage()
+{
+    m_moves.clear();
+    m_index = 0u;
+
+    switch (m_stage)
+    {
+    case Stage::Init:
+        m_stage = Stage::CaptureMoves;
+        m_rules.generatePseudoMoves<GenType::Captures>(m_moves);
+        return true;
+    case Stage::CaptureMoves:
+        if (m_quiets)
+        {
+            m_stage = Stage::QuietMoves;
+            m_rules.generatePseudoMoves<GenType::Quiets>(m_moves);
+            return true;
+        }
+        m_stage = Stage::Done;
+        return false;
+    default:
+        m_stage = Stage::Done;
+        return false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool MoveGenerator::next(Move& move)
+{
+    do
+    {
+        while (m_index < m_moves.size())
+        {
+            move = m_moves[m_index++];
+
+            // No King (neural network, unit tests): all moves are legal
+            if ((m_king == Square::OOB) ||
+                (m_rules.isLegalMove(move, m_king, m_safety)))
+                return true;
+        }
+    } while (nextStage());
+
+    return false;
+}
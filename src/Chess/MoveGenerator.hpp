@@ -0,0 +1,73 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef CHESS_MOVEGENERATOR_HPP
+#  define CHESS_MOVEGENERATOR_HPP
+
+#  include "Chess/Rules.hpp"
+
+// *****************************************************************************
+//! \brief Staged generator of the legal moves of a position: captures and
+//! promotions are returned first, quiet moves are generated only when all
+//! captures have been consumed. Contrary to Rules::generateValidMoves() the
+//! position is not modified and a consumer looking for the first good move
+//! (search, game status) does not pay for generating all legal moves.
+//!
+//! \note States computed from the chessboard (piece lists, bitboards) shall
+//! be up-to-date: this is the case after Rules::load(), Rules::applyMove() or
+//! Rules::makeMove().
+// *****************************************************************************
+class MoveGenerator
+{
+public:
+
+    //! \brief Prepare the generation of legal moves of the current position.
+    //! Checks and pins of the King are computed once here.
+    //! \param[in] quiets if false only captures and promotions are
+    //! generated (ie for quiescence search).
+    explicit MoveGenerator(Rules const& rules, const bool quiets = true);
+
+    //! \brief Get the next legal move.
+    //! \return false if there is no more legal moves.
+    bool next(Move& move);
+
+private:
+
+    //! \brief Generate the pseudo legal moves of the next stage.
+    //! \return false if all stages have been done.
+    bool nextStage();
+
+private:
+
+    //! \brief Stages of the generation.
+    enum Stage { Init, CaptureMoves, QuietMoves, Done };
+
+    Rules const& m_rules;
+    Stage        m_stage = Stage::Init;
+    bool         m_quiets;
+    //! \brief Pseudo legal moves of the current stage.
+    MoveList     m_moves;
+    //! \brief Index of the next pseudo legal move to check.
+    size_t       m_index = 0u;
+    Square       m_king;
+    KingSafety   m_safety;
+};
+
+#endif
@@ -0,0 +1,391 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "Chess/Perft.hpp"
+#include "Chess/MoveGenerator.hpp"
+#include "Utils/Arena.hpp"
+#include "Utils/HeapCounter.hpp"
+#include <chrono>
+#include <iomanip>
+#include <numeric>
+#include <thread>
+
+//-----------------------------------------------------------------------------
+const std::array<PerftPosition, 6> c_perft_suite =
+{{
+    { "Initial position",
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -",
+      5u, {{ 20u, 400u, 8902u, 197281u, 4865609u }} },
+    { "Kiwipete",
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+      4u, {{ 48u, 2039u, 97862u, 4085603u, 193690690u }} },
+    { "Position 3",
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+      5u, {{ 14u, 191u, 2812u, 43238u, 674624u }} },
+    { "Position 4",
+      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq -",
+      4u, {{ 6u, 264u, 9467u, 422333u, 15833292u }} },
+    { "Position 5",
+      "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ -",
+      4u, {{ 44u, 1486u, 62379u, 2103487u, 89941194u }} },
+    { "Position 6",
+      "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - -",
+      4u, {{ 46u, 2079u, 89890u, 3894594u, 164075551u }} },
+}};
+
+//-----------------------------------------------------------------------------
+//! \brief Elapsed seconds since the given instant.
+//-----------------------------------------------------------------------------
+static double elapsed(std::chrono::steady_clock::time_point const& start)
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Number of nodes per second (avoid division by zero).
+//-----------------------------------------------------------------------------
+static uint64_t nps(const uint64_t nodes, const double seconds)
+{
+    return (seconds > 0.0) ? uint64_t(double(nodes) / seconds) : nodes;
+}
+
+//-----------------------------------------------------------------------------
+PerftHash::PerftHash(const size_t mb)
+{
+    size_t entries = 1u;
+    while (2u * entries * sizeof(Entry) <= mb * 1024u * 1024u)
+        entries *= 2u;
+
+    m_entries.reset(new Entry[entries]);
+    m_mask = entries - 1u;
+    for (size_t i = 0u; i < entries; ++i)
+    {
+        m_entries[i].check.store(0u, std::memory_order_relaxed);
+        m_entries[i].data.store(0u, std::memory_order_relaxed);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool PerftHash::probe(const uint64_t key, const uint8_t depth, uint64_t& nodes) const
+{
+    Entry const& entry = m_entries[key & m_mask];
+    const uint64_t data = entry.data.load(std::memory_order_relaxed);
+    const uint64_t check = entry.check.load(std::memory_order_relaxed);
+
+    if (((check ^ data) != key) || ((data & 0xFFu) != depth))
+        return false;
+
+    nodes = data >> 8;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void PerftHash::store(const uint64_t key, const uint8_t depth, const uint64_t nodes)
+{
+    Entry& entry = m_entries[key & m_mask];
+    const uint64_t data = (nodes << 8) | depth;
+
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+    entry.data.store(data, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Recursive perft. Legal moves are generated by MoveGenerator from the
+//! states updated incrementally by makeMove() (piece lists, bitboards, Zobrist
+//! key): the position is never resynchronized, so perft also validates the
+//! incremental updates.
+//-----------------------------------------------------------------------------
+static uint64_t count(Rules& rules, const uint8_t depth, PerftHash* hash)
+{
+    uint64_t nodes = 0u;
+    MoveGenerator generator(rules);
+    Move move;
+
+    // Bulk counting: no need to play leaf moves
+    if (depth == 1u)
+    {
+        while (generator.next(move))
+            ++nodes;
+        return nodes;
+    }
+
+    // Probed before generating moves: a hit costs no move generation
+    if ((hash != nullptr) && hash->probe(rules.hash(), depth, nodes))
+        return nodes;
+
+    while (generator.next(move))
+    {
+        rules.makeMove(move);
+        nodes += count(rules, uint8_t(depth - 1u), hash);
+        rules.unmakeMove();
+    }
+
+    if (hash != nullptr)
+    {
+        hash->store(rules.hash(), depth, nodes);
+    }
+    return nodes;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Subtree explored by a thread: one root move or one root move and one
+//! of its replies.
+//-----------------------------------------------------------------------------
+struct PerftTask
+{
+    Move moves[2];
+    uint8_t plies;
+    //! \brief Index of the root move.
+    size_t root;
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Count leaf nodes for each root move with several threads.
+//! \param[out] results number of leaf nodes indexed as root moves.
+//-----------------------------------------------------------------------------
+static void split(Rules& rules, MoveList const& moves, const uint8_t depth,
+                  unsigned threads, const size_t hash_mb,
+                  std::vector<uint64_t>& results)
+{
+    if (threads == 0u)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Not enough root moves to keep threads busy: split one ply deeper.
+    std::vector<PerftTask> tasks;
+    const bool deeper = (depth >= 3u) && (moves.size() < 4u * threads);
+    for (size_t i = 0u; i < moves.size(); ++i)
+    {
+        if (!deeper)
+        {
+            tasks.push_back({ { moves[i], moves[i] }, 1u, i });
+            continue;
+        }
+
+        rules.makeMove(moves[i]);
+        const MoveList replies = rules.generateValidMoves();
+        for (auto const& reply: replies)
+        {
+            tasks.push_back({ { moves[i], reply }, 2u, i });
+        }
+        rules.unmakeMove();
+    }
+
+    std::unique_ptr<PerftHash> hash;
+    if (hash_mb != 0u)
+    {
+        hash = std::make_unique<PerftHash>(hash_mb);
+    }
+
+    // Each worker picks the next task and plays it on its own copy of rules
+    // placed in the memory arena of its thread.
+    std::vector<uint64_t> nodes(tasks.size(), 0u);
+    std::atomic<size_t> next{0u};
+    auto worker = [&]()
+    {
+        Arena& arena = Arena::local();
+        ArenaScope scope(arena);
+        Rules& local = *arena.create<Rules>(rules);
+        for (size_t t = next++; t < tasks.size(); t = next++)
+        {
+            PerftTask const& task = tasks[t];
+            for (uint8_t p = 0u; p < task.plies; ++p)
+            {
+                local.makeMove(task.moves[p]);
+            }
+
+            const uint8_t remaining = uint8_t(depth - task.plies);
+            nodes[t] = (remaining == 0u) ? 1u : count(local, remaining, hash.get());
+
+            for (uint8_t p = 0u; p < task.plies; ++p)
+            {
+                local.unmakeMove();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1u; i < threads; ++i)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& w: workers)
+    {
+        w.join();
+    }
+
+    results.assign(moves.size(), 0u);
+    for (size_t t = 0u; t < tasks.size(); ++t)
+    {
+        results[tasks[t].root] += nodes[t];
+    }
+}
+
+//-----------------------------------------------------------------------------
+uint64_t perft(Rules& rules, const uint8_t depth)
+{
+    assert(depth > 0u);
+
+    uint64_t nodes = count(rules, depth, nullptr);
+
+    // Restore legal moves and status of the root position
+    rules.generateValidMoves();
+    return nodes;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t perft(Rules& rules, const uint8_t depth, unsigned threads, const size_t hash_mb)
+{
+    assert(depth > 0u);
+
+    const MoveList moves = rules.generateValidMoves();
+    std::vector<uint64_t> results;
+    split(rules, moves, depth, threads, hash_mb, results);
+
+    // Restore legal moves and status of the root position
+    rules.generateValidMoves();
+    return std::accumulate(results.begin(), results.end(), uint64_t(0u));
+}
+
+//-----------------------------------------------------------------------------
+uint64_t divide(Rules& rules, const uint8_t depth, std::ostream& os,
+                unsigned threads, const size_t hash_mb)
+{
+    assert(depth > 0u);
+
+    const auto start = std::chrono::steady_clock::now();
+    const MoveList moves = rules.generateValidMoves();
+    std::vector<uint64_t> results;
+    split(rules, moves, depth, threads, hash_mb, results);
+    const double seconds = elapsed(start);
+    rules.generateValidMoves();
+
+    uint64_t nodes = 0u;
+    for (size_t i = 0u; i < moves.size(); ++i)
+    {
+        nodes += results[i];
+        os << toStrMove(moves[i]) << ": " << results[i] << std::endl;
+    }
+
+    os << std::endl
+       << "Nodes searched: " << nodes << std::endl
+       << "Time (s): " << seconds << std::endl
+       << "Nodes/second: " << nps(nodes, seconds) << std::endl;
+    return nodes;
+}
+
+//-----------------------------------------------------------------------------
+bool benchmark(std::ostream& os, unsigned threads)
+{
+    uint64_t total_nodes = 0u;
+    uint64_t total_allocations = 0u;
+    double total_seconds = 0.0;
+    bool res = true;
+
+    for (auto const& position: c_perft_suite)
+    {
+        Rules rules(position.fen);
+
+        const uint64_t heap = heapAllocations();
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t nodes = perft(rules, position.depth);
+        const double seconds = elapsed(start);
+        const uint64_t allocations = heapAllocations() - heap;
+        const uint64_t expected = position.nodes[position.depth - 1u];
+
+        total_nodes += nodes;
+        total_allocations += allocations;
+        total_seconds += seconds;
+
+        os << std::left << std::setw(18) << position.name
+           << " depth " << int(position.depth)
+           << ": " << std::right << std::setw(10) << nodes << " nodes "
+           << std::setw(10) << nps(nodes, seconds) << " nodes/s "
+           << double(allocations) / double(nodes) << " allocs/node";
+        if (nodes != expected)
+        {
+            os << " FAILED (expected " << expected << ")";
+            res = false;
+        }
+        os << std::endl;
+    }
+
+    os << std::endl
+       << "Total: " << total_nodes << " nodes in " << total_seconds << " s: "
+       << nps(total_nodes, total_seconds) << " nodes/s, "
+       << total_allocations << " heap allocations" << std::endl;
+
+    // Micro-benchmark of the pseudo legal move generator alone (no legality
+    // filtering, no make/unmake).
+    constexpr uint32_t generations = 100000u;
+    uint64_t total_moves = 0u;
+    const auto gen_start = std::chrono::steady_clock::now();
+    for (auto const& position: c_perft_suite)
+    {
+        Rules rules(position.fen);
+        for (uint32_t i = 0u; i < generations; ++i)
+        {
+            total_moves += rules.generatePseudoValidMoves().size();
+        }
+    }
+    const double gen_seconds = elapsed(gen_start);
+
+    os << std::endl << "Move generator: "
+       << nps(generations * c_perft_suite.size(), gen_seconds) << " generations/s "
+       << nps(total_moves, gen_seconds) << " moves/s" << std::endl;
+
+    // Scaling of the multithreaded perft (no hash table for measuring
+    // the move generator only).
+    if (threads == 0u)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    os << std::endl << "Multithreaded perft:" << std::endl;
+    double reference = 0.0;
+    for (unsigned n = 1u; n <= threads; n = (n == threads) ? n + 1u : std::min(2u * n, threads))
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (auto const& position: c_perft_suite)
+        {
+            Rules rules(position.fen);
+            if (perft(rules, position.depth, n, 0u) != position.nodes[position.depth - 1u])
+            {
+                os << position.name << " FAILED with " << n << " threads" << std::endl;
+                res = false;
+            }
+        }
+        const double seconds = elapsed(start);
+        if (n == 1u)
+        {
+            reference = seconds;
+        }
+
+        os << std::setw(4) << n << " threads: " << std::setw(10)
+           << nps(total_nodes, seconds) << " nodes/s, speedup x"
+           << std::setprecision(3) << (seconds > 0.0 ? reference / seconds : 1.0)
+           << std::endl;
+    }
+
+    return res;
+}
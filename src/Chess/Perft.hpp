@@ -0,0 +1,117 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef CHESS_PERFT_HPP
+#  define CHESS_PERFT_HPP
+
+#  include "Chess/Rules.hpp"
+#  include <array>
+#  include <atomic>
+#  include <memory>
+
+//! \brief Max depth stored in PerftPosition::nodes.
+constexpr uint8_t PerftMaxDepth = 5u;
+
+// *****************************************************************************
+//! \brief Position of the perft suite with its expected number of leaf nodes.
+//! See https://www.chessprogramming.org/Perft_Results
+// *****************************************************************************
+struct PerftPosition
+{
+    //! \brief Name of the position.
+    const char* name;
+    //! \brief Forsyth-Edwards notation of the position.
+    const char* fen;
+    //! \brief Depth used by the benchmark.
+    uint8_t depth;
+    //! \brief Expected number of leaf nodes for depth 1, 2 ... PerftMaxDepth.
+    std::array<uint64_t, PerftMaxDepth> nodes;
+};
+
+//! \brief Standard perft positions: initial position, Kiwipete ...
+extern const std::array<PerftPosition, 6> c_perft_suite;
+
+// *****************************************************************************
+//! \brief Hash table of perft results (Zobrist key, depth) -> number of leaf
+//! nodes shared without lock by threads: transpositions are counted once.
+//! Each entry stores the key XOR'ed with its data so an entry torn by two
+//! threads writing it at the same time is detected and ignored.
+// *****************************************************************************
+class PerftHash
+{
+public:
+
+    //! \brief Allocate the table.
+    //! \param[in] mb size of the table in mega bytes (rounded down to a power
+    //! of two number of entries).
+    PerftHash(const size_t mb);
+
+    //! \brief Look for the number of leaf nodes of the position of the given
+    //! depth.
+    //! \return true if found and then nodes is set.
+    bool probe(const uint64_t key, const uint8_t depth, uint64_t& nodes) const;
+
+    //! \brief Store the number of leaf nodes of the position (always replace).
+    void store(const uint64_t key, const uint8_t depth, const uint64_t nodes);
+
+private:
+
+    struct Entry
+    {
+        //! \brief Zobrist key XOR data.
+        std::atomic<uint64_t> check;
+        //! \brief Number of nodes (56 bits) and depth (8 bits).
+        std::atomic<uint64_t> data;
+    };
+
+    std::unique_ptr<Entry[]> m_entries;
+    size_t m_mask;
+};
+
+//! \brief Performance test: count the number of leaf nodes of the tree of
+//! legal moves of the given depth. Used for validating and measuring the
+//! speed of the move generator.
+//! \param[inout] rules the position to explore. Restored when returning.
+//! \param[in] depth the number of plies to explore (> 0).
+uint64_t perft(Rules& rules, const uint8_t depth);
+
+//! \brief Multithreaded perft: subtrees of root moves (or of the replies to
+//! root moves when there are few root moves) are shared between threads, each
+//! one playing moves on its own copy of rules.
+//! \param[in] threads number of threads (0 for the number of cores).
+//! \param[in] hash_mb size of the shared hash table (0 for no hash table).
+uint64_t perft(Rules& rules, const uint8_t depth, unsigned threads, const size_t hash_mb);
+
+//! \brief Same as perft() but display on the stream the number of leaf nodes
+//! for each root move (divide), the total of nodes and nodes per second.
+uint64_t divide(Rules& rules, const uint8_t depth, std::ostream& os,
+                unsigned threads = 1u, const size_t hash_mb = 0u);
+
+//! \brief Run perft on each position of the suite with its benchmark depth
+//! and display the number of nodes per second and of heap allocations per
+//! node (expected 0), then the number of pseudo legal
+//! move generations per second. The suite is then run again
+//! for 1, 2, 4 ... threads to display the speedup of the multithreaded perft.
+//! Used for tracking regressions of the move generator speed.
+//! \param[in] threads max number of threads (0 for the number of cores).
+//! \return false if a number of nodes does not match the expected value.
+bool benchmark(std::ostream& os, unsigned threads = 0u);
+
+#endif
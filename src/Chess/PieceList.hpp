@@ -0,0 +1,84 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef CHESS_PIECELIST_HPP
+#  define CHESS_PIECELIST_HPP
+
+#  include "Chess/Board.hpp"
+
+// *****************************************************************************
+//! \brief Squares occupied by the pieces of each color and squares of the
+//! Kings. Updated in O(1) when a piece is added or removed so that move
+//! generation and check detection only iterate on occupied squares instead of
+//! scanning the 64 squares of the chessboard.
+// *****************************************************************************
+struct PieceLists
+{
+    //! \brief Fill lists from a chessboard.
+    void load(chessboard const& board)
+    {
+        count[Color::White] = count[Color::Black] = 0u;
+        kings[Color::White] = kings[Color::Black] = Square::OOB;
+        for (uint8_t ij = 0u; ij < NbSquares; ++ij)
+        {
+            if (board[ij].type != PieceType::Empty)
+            {
+                add(ij, board[ij]);
+            }
+        }
+    }
+
+    //! \brief Add the piece placed on the square sq.
+    inline void add(const uint8_t sq, const Piece piece)
+    {
+        const uint8_t color = piece.color;
+        index[sq] = count[color]++;
+        squares[color][index[sq]] = sq;
+        if (piece.type == PieceType::King)
+        {
+            kings[color] = sq;
+        }
+    }
+
+    //! \brief Remove the piece placed on the square sq. The last piece of the
+    //! list takes its slot.
+    inline void remove(const uint8_t sq, const Piece piece)
+    {
+        const uint8_t color = piece.color;
+        const uint8_t last = squares[color][--count[color]];
+        squares[color][index[sq]] = last;
+        index[last] = index[sq];
+        if ((piece.type == PieceType::King) && (kings[color] == sq))
+        {
+            kings[color] = Square::OOB;
+        }
+    }
+
+    //! \brief Squares of the pieces indexed by [enum Color][0 .. count[color]].
+    uint8_t squares[2][NbSquares];
+    //! \brief Number of pieces indexed by [enum Color].
+    uint8_t count[2];
+    //! \brief Position of the piece in squares[color] indexed by its square.
+    uint8_t index[NbSquares];
+    //! \brief Square of the King indexed by [enum Color] (OOB if none).
+    uint8_t kings[2];
+};
+
+#endif
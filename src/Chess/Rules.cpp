@@ -19,12 +19,12 @@
 //=====================================================================
 
 #include "Chess/Rules.hpp"
-#include <valarray>
+#include "Chess/MoveGenerator.hpp"
 #include <sstream>
 
 //-----------------------------------------------------------------------------
 //! \brief Lookup table used for piece movements. See explaination concerning
-//! c_relative_movements.
+//! Movements.
 //-----------------------------------------------------------------------------
 static const std::array<uint8_t, 64> c_mailbox64 =
 {{
@@ -79,17 +79,67 @@ enum Rosas { N = -10, W = -1, E = 1, S = 10 };
 //! 64, 75, 76, 66, 56, 55, 54 and 64 in c_mailbox64. Relative displacement
 //! is their difference with the 65. For example -11 = 54 - 65. For other
 //! pieces which can slide we store the displacement of a distance of 1.
+//!
+//! Tables are fixed-size and known at compile time: loops on directions of
+//! a given piece type are unrolled by the compiler.
+//-----------------------------------------------------------------------------
+template<PieceType pt> struct Movements;
+
+template<> struct Movements<PieceType::Rook>
+{
+    static constexpr bool slide = true;
+    static constexpr std::array<int, 4> directions() { return {{ N, E, S, W }}; }
+};
+
+template<> struct Movements<PieceType::Knight>
+{
+    static constexpr bool slide = false;
+    static constexpr std::array<int, 8> directions()
+    {
+        return {{ N+N+E, N+E+E, S+E+E, S+S+E, S+S+W, S+W+W, N+W+W, N+N+W }};
+    }
+};
+
+template<> struct Movements<PieceType::Bishop>
+{
+    static constexpr bool slide = true;
+    static constexpr std::array<int, 4> directions() { return {{ N+E, N+W, S+E, S+W }}; }
+};
+
+template<> struct Movements<PieceType::Queen>
+{
+    static constexpr bool slide = true;
+    static constexpr std::array<int, 8> directions()
+    {
+        return {{ N, S, E, W, N+W, N+E, S+E, S+W }};
+    }
+};
+
+template<> struct Movements<PieceType::King>
+{
+    static constexpr bool slide = false;
+    static constexpr std::array<int, 8> directions()
+    {
+        return {{ N, S, E, W, N+W, N+E, S+E, S+W }};
+    }
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Pawn displacements depending on its color.
 //-----------------------------------------------------------------------------
-static const std::valarray<int> c_relative_movements[8] =
+template<Color side> struct PawnMovements
 {
-    [PieceType::Empty]  = { },
-    [PieceType::Rook]   = { N, E, S, W },
-    [PieceType::Knight] = { N+N+E, N+E+E, S+E+E, S+S+E, S+S+W, S+W+W, N+W+W, N+N+W },
-    [PieceType::Bishop] = { N+E, N+W, S+E, S+W },
-    [PieceType::Queen]  = { N, S, E, W, N+W, N+E, S+E, S+W },
-    [PieceType::King]   = { N, S, E, W, N+W, N+E, S+E, S+W },
-    [PieceType::WPawn]  = { N, N+N, N+E, N+W },
-    [PieceType::BPawn]  = { S, S+S, S+E, S+W },
+    //! \brief One step forward.
+    static constexpr int forward = (side == Color::White) ? N : S;
+    //! \brief Row of pawns allowed to make a double step.
+    static constexpr uint8_t start_row = (side == Color::White) ? 6u : 1u;
+    //! \brief Row where pawns are promoted.
+    static constexpr uint8_t promotion_row = (side == Color::White) ? 0u : 7u;
+    //! \brief Takes.
+    static constexpr std::array<int, 2> takes()
+    {
+        return {{ forward + W, forward + E }};
+    }
 };
 
 //-----------------------------------------------------------------------------
@@ -152,8 +202,9 @@ bool Rules::applyMoves(std::string const& moves, bool const init_board)
         m_ep = m_initial.ep;
         m_castle[0] = m_initial.castle[0];
         m_castle[1] = m_initial.castle[1];
+        m_halfmove = m_initial.halfmove;
     }
-    m_moved.clear();
+    m_plies = 0u;
     generateValidMoves();
 
     std::istringstream iss(moves);
@@ -191,152 +242,325 @@ void Rules::saveStates()
     m_initial.ep = m_ep;
     m_initial.castle[0] = m_castle[0];
     m_initial.castle[1] = m_castle[1];
+    m_initial.halfmove = m_halfmove;
+
+    // The game starts from here: nothing to revert.
+    m_plies = 0u;
 }
 
 //-----------------------------------------------------------------------------
-const std::vector<Move>& Rules::generatePseudoValidMoves()
+void Rules::syncStates()
 {
-    Piece p;
-    PieceType pt;
+    m_pieces.load(m_board);
+#ifdef USE_BITBOARDS
+    m_bitboards.load(m_board);
+#endif
+    m_hash = computeHash();
+}
+
+//-----------------------------------------------------------------------------
+uint64_t Rules::computeHash() const
+{
+    return Zobrist::hash(m_board, m_side, m_castle, m_ep);
+}
 
+//-----------------------------------------------------------------------------
+const MoveList& Rules::generatePseudoValidMoves()
+{
+    // Forget the legal moves of the previous position
+    for (auto const& move: m_legal_moves)
+    {
+        m_legal_targets[move.from] = 0u;
+    }
     m_legal_moves.clear();
-    m_legal_moves.reserve(128u);
+    generatePseudoMoves<GenType::AllMoves>(m_legal_moves);
+
+    //dispPseudoMoves();
+    return m_legal_moves;
+}
+
+//-----------------------------------------------------------------------------
+template<GenType gen>
+void Rules::generatePseudoMoves(MoveList& moves) const
+{
+#ifdef USE_BITBOARDS
+
+    generatePseudoLegalPawnMoves<gen>(moves);
+    generatePseudoLegalPieceMoves<gen>(PieceType::Knight, moves);
+    generatePseudoLegalPieceMoves<gen>(PieceType::Bishop, moves);
+    generatePseudoLegalPieceMoves<gen>(PieceType::Rook, moves);
+    generatePseudoLegalPieceMoves<gen>(PieceType::Queen, moves);
+    generatePseudoLegalPieceMoves<gen>(PieceType::King, moves);
+
+#else // Mailbox
+
+    // Only iterate on pieces of the side to move
+    for (uint8_t i = 0u; i < m_pieces.count[m_side]; ++i)
+    {
+        const uint8_t ij = m_pieces.squares[m_side][i];
+        switch (m_board[ij].type)
+        {
+        case PieceType::Pawn:
+            if (m_side == Color::White)
+                generatePseudoLegalPawnMove<gen, Color::White>(ij, moves);
+            else
+                generatePseudoLegalPawnMove<gen, Color::Black>(ij, moves);
+            break;
+        case PieceType::Knight:
+            generatePseudoLegalPieceMove<gen, PieceType::Knight>(ij, moves);
+            break;
+        case PieceType::Bishop:
+            generatePseudoLegalPieceMove<gen, PieceType::Bishop>(ij, moves);
+            break;
+        case PieceType::Rook:
+            generatePseudoLegalPieceMove<gen, PieceType::Rook>(ij, moves);
+            break;
+        case PieceType::Queen:
+            generatePseudoLegalPieceMove<gen, PieceType::Queen>(ij, moves);
+            break;
+        case PieceType::King:
+            generatePseudoLegalPieceMove<gen, PieceType::King>(ij, moves);
+            break;
+        default:
+            break;
+        }
+    }
 
-    for (uint8_t ij = 0u; ij < NbSquares; ++ij)
+#endif
+
+    // Castling
+    if ((gen != GenType::Captures) && (m_castle[m_side] != 0))
     {
-        p = m_board[ij];
+        generatePseudoLegalCastleMove(moves);
+    }
+}
 
-        // Ignore: empty position and pieces of the opposite side
-        if ((p.type == PieceType::Empty) || (p.color != m_side))
-            continue ;
+#ifdef USE_BITBOARDS
 
-        pt = static_cast<PieceType>(p.type);
+//-----------------------------------------------------------------------------
+template<GenType gen>
+void Rules::generatePseudoLegalPawnMoves(MoveList& moves) const
+{
+    const bitboard empty = ~m_bitboards.occupied;
+    const bitboard ep = (m_ep != Square::OOB) ? (bit(m_ep) & empty) : 0u;
+    const bitboard takes = m_bitboards.colors[opposite(m_side)] | ep;
+    const int forward = (m_side == Color::White) ? -8 : 8;
+    const uint8_t last_row = (m_side == Color::White) ? 0u : 7u;
+    const uint8_t start_row = (m_side == Color::White) ? 6u : 1u;
+
+    bitboard pawns = m_bitboards.pieces[m_side][PieceType::Pawn];
+    while (pawns)
+    {
+        const uint8_t from = popLsb(pawns);
 
-        // Pawn moves
-        if (pt == PieceType::Pawn)
+        // Forward moves: one or two empty squares
+        bitboard targets = 0u;
+        if (ROW(from) != last_row)
         {
-            if (m_side == Color::Black)
+            const uint8_t to = uint8_t(from + forward);
+            if (empty & bit(to))
             {
-                // This is an hack: we use the slot of
-                // PieceType::NotUsed !
-                pt = PieceType::BPawn;
+                // Pushes to the last row are promotions: generated with takes
+                if ((ROW(to) == last_row) ? (gen != GenType::Quiets) : (gen != GenType::Captures))
+                {
+                    targets |= bit(to);
+                }
+                if ((gen != GenType::Captures) && (ROW(from) == start_row) &&
+                    (empty & bit(to + forward)))
+                {
+                    moves.push_back(PawnDoubleMove(from, uint8_t(to + forward)));
+                }
             }
-            generatePseudoLegalPawnMove(ij, pt);
         }
-        else // Major piece movements
+
+        // Diagonal takes including en-passant
+        if (gen != GenType::Quiets)
+        {
+            targets |= pawnAttacks(m_side, from) & takes;
+        }
+
+        while (targets)
         {
-            generatePseudoLegalPieceMove(ij, pt);
+            const uint8_t to = popLsb(targets);
+            const uint8_t r = ROW(to);
+            if ((r == 0) || (r == 7))
+            {
+                addPromotions(from, to, moves);
+            }
+            else
+            {
+                moves.push_back(PawnSimpleMove(from, to, to == m_ep));
+            }
         }
     }
+}
 
-    // Castling
-    if (m_castle[m_side] != 0)
+//-----------------------------------------------------------------------------
+template<GenType gen>
+void Rules::generatePseudoLegalPieceMoves(const PieceType pt, MoveList& moves) const
+{
+    const bitboard occupancy = m_bitboards.occupied;
+    const bitboard allowed = (gen == GenType::Captures) ? m_bitboards.colors[opposite(m_side)]
+                           : (gen == GenType::Quiets) ? ~occupancy
+                           : ~m_bitboards.colors[m_side];
+
+    bitboard pieces = m_bitboards.pieces[m_side][pt];
+    while (pieces)
     {
-        generatePseudoLegalCastleMove();
-    }
+        const uint8_t from = popLsb(pieces);
+        bitboard targets;
 
-    //dispPseudoMoves();
-    return m_legal_moves;
+        switch (pt)
+        {
+        case PieceType::Knight:
+            targets = knightAttacks(from);
+            break;
+        case PieceType::Bishop:
+            targets = bishopAttacks(from, occupancy);
+            break;
+        case PieceType::Rook:
+            targets = rookAttacks(from, occupancy);
+            break;
+        case PieceType::Queen:
+            targets = queenAttacks(from, occupancy);
+            break;
+        case PieceType::King:
+            targets = kingAttacks(from);
+            break;
+        default:
+            assert(false && "Unexpected piece type");
+            targets = 0u;
+            break;
+        }
+
+        addMoves(from, targets & allowed, moves);
+    }
 }
 
 //-----------------------------------------------------------------------------
-// FIXME passer cdirectement _relative_movements[pt]
-void Rules::generatePseudoLegalPawnMove(const uint8_t from, const PieceType pt)
+void Rules::addMoves(const uint8_t from, bitboard targets, MoveList& moves) const
 {
-    Piece piece;
-    for (uint8_t mvt = 0u; mvt < c_relative_movements[pt].size(); ++mvt)
+    while (targets)
     {
-        // Invalid move: North+North from squaree != [A-H]2 or [A-H]7
-        uint8_t r = ROW(from);
-        if ((mvt == 1u) && (r != 1) && (r != 6))
-            continue;
+        moves.push_back(PieceMove(from, popLsb(targets)));
+    }
+}
 
-        // One step relative movement
-        uint8_t to = c_mailbox120[c_mailbox64[from] + c_relative_movements[pt][mvt]];
+#else // Mailbox
 
-        // Invalid move: outside the chessboard
-        if (to == Square::OOB)
-            continue;
+//-----------------------------------------------------------------------------
+template<GenType gen, Color side>
+void Rules::generatePseudoLegalPawnMove(const uint8_t from, MoveList& moves) const
+{
+    using Pawn = PawnMovements<side>;
 
-        piece = m_board[to];
+    // Push one step forward and two steps from the initial row. Pushes to the
+    // last row are promotions: generated with takes.
+    uint8_t to = c_mailbox120[c_mailbox64[from] + Pawn::forward];
+    if ((to != Square::OOB) && (m_board[to].type == PieceType::Empty))
+    {
+        if (ROW(to) == Pawn::promotion_row)
+        {
+            if (gen != GenType::Quiets)
+            {
+                addPromotions(from, to, moves);
+            }
+        }
+        else if (gen != GenType::Captures)
+        {
+            moves.push_back(PawnSimpleMove(from, to, false));
+            if (ROW(from) == Pawn::start_row)
+            {
+                const uint8_t to2 = uint8_t(to + (to - from));
+                if (m_board[to2].type == PieceType::Empty)
+                {
+                    moves.push_back(PawnDoubleMove(from, to2));
+                }
+            }
+        }
+    }
 
-        // Invalid move: move to a piece with the same color
-        if (piece.color == m_side)
-            continue;
+    if (gen == GenType::Quiets)
+        return ;
 
-        // Invalid move: North and North+North
-        if ((mvt <= 1u) && (piece.type != PieceType::Empty))
+    // Diagonal moves: take opponent piece or en-passant
+    constexpr auto takes = Pawn::takes();
+    for (const int mvt: takes)
+    {
+        to = c_mailbox120[c_mailbox64[from] + mvt];
+        if (to == Square::OOB)
             continue;
 
-        // Invalid diagonal move (take) if no piece and not en-passant
-        if ((mvt > 1u) && (piece.type == PieceType::Empty) && (to != m_ep))
+        const Piece piece = m_board[to];
+        if ((piece.type == PieceType::Empty) ? (to != m_ep) : (piece.color == side))
             continue;
 
-        // Promotion
-        r = ROW(to);
-        if ((r == 0) || (r == 7))
+        if (ROW(to) == Pawn::promotion_row)
         {
-            for (int promote = PieceType::Rook; promote <= PieceType::Queen; ++promote)
-            {
-                m_legal_moves.push_back(PromoteMove(from, to, static_cast<PieceType>(promote)));
-            }
+            addPromotions(from, to, moves);
         }
-        else // Normal move
+        else
         {
-            if (mvt == 1)
-            {
-                m_legal_moves.push_back(PawnDoubleMove(from, to));
-            }
-            else
-            {
-                m_legal_moves.push_back(PawnSimpleMove(from, to, to == m_ep));
-            }
+            moves.push_back(PawnSimpleMove(from, to, to == m_ep));
         }
     }
 }
 
 //-----------------------------------------------------------------------------
-void Rules::generatePseudoLegalPieceMove(const uint8_t from, const PieceType pt)
+template<GenType gen, PieceType pt>
+void Rules::generatePseudoLegalPieceMove(const uint8_t from, MoveList& moves) const
 {
-    Piece piece;
-    const bool can_slide = m_board[from].slide;
-
-    for (uint8_t mvt = 0u; mvt < c_relative_movements[pt].size(); ++mvt)
+    constexpr auto directions = Movements<pt>::directions();
+    for (const int mvt: directions)
     {
         for (uint8_t to = from;;)
         {
             // One step relative movement
-            to = c_mailbox120[c_mailbox64[to] + c_relative_movements[pt][mvt]];
+            to = c_mailbox120[c_mailbox64[to] + mvt];
 
             // Invalid move: outside the chessboard
             if (to == Square::OOB)
                 break;
 
-            piece = m_board[to];
+            const Piece piece = m_board[to];
 
             // Invalid move: move to a piece with the same color
             if (piece != NoPiece)
             {
                 // Piece takes other piece
-                if (piece.color != m_side)
+                if ((gen != GenType::Quiets) && (piece.color != m_side))
                 {
-                    m_legal_moves.push_back(PieceMove(from, to));
+                    moves.push_back(PieceMove(from, to));
                 }
                 break;
             }
 
-            // Arrive to an empty square or to an opposite piece
-            m_legal_moves.push_back(PieceMove(from, to));
+            // Arrive to an empty square
+            if (gen != GenType::Captures)
+            {
+                moves.push_back(PieceMove(from, to));
+            }
 
             // If cannot do more than one relative movement
-            if (can_slide == false)
+            if (!Movements<pt>::slide)
                 break;
         }
     }
 }
 
+#endif
+
 //-----------------------------------------------------------------------------
-void Rules::generatePseudoLegalCastleMove()
+void Rules::addPromotions(const uint8_t from, const uint8_t to, MoveList& moves) const
+{
+    for (int promote = PieceType::Rook; promote <= PieceType::Queen; ++promote)
+    {
+        moves.push_back(PromoteMove(from, to, static_cast<PieceType>(promote)));
+    }
+}
+
+//-----------------------------------------------------------------------------
+void Rules::generatePseudoLegalCastleMove(MoveList& moves) const
 {
     Color xside = opposite(m_side);
     const uint8_t offset = (m_side == Color::White) ? 0 : (sqE1 - sqE8);
@@ -346,18 +570,18 @@ void Rules::generatePseudoLegalCastleMove()
         return ;
 
     // Castle not possible if King is in check
-    if (isKingInCheck(m_board, m_side))
+    if (attacked(sqE1 - offset, xside))
         return ;
 
     // King castle
     if ((m_castle[m_side] & Castle::Little) &&
         (m_board[sqF1 - offset].type == PieceType::Empty) &&
         (m_board[sqG1 - offset].type == PieceType::Empty) &&
-        (!attack(m_board, sqF1 - offset, xside)))
+        (!attacked(sqF1 - offset, xside)))
     {
-        m_legal_moves.push_back(CastleMove(sqE1 - offset,
-                                           sqG1 - offset,
-                                           Castle::Little));
+        moves.push_back(CastleMove(sqE1 - offset,
+                                   sqG1 - offset,
+                                   Castle::Little));
     }
 
     // Queeen castle
@@ -365,27 +589,46 @@ void Rules::generatePseudoLegalCastleMove()
         (m_board[sqD1 - offset].type == PieceType::Empty) &&
         (m_board[sqB1 - offset].type == PieceType::Empty) &&
         (m_board[sqC1 - offset].type == PieceType::Empty) &&
-        (!attack(m_board, sqD1 - offset, xside)))
+        (!attacked(sqD1 - offset, xside)))
     {
-        m_legal_moves.push_back(CastleMove(sqE1 - offset,
-                                           sqC1 - offset,
-                                           Castle::Big));
+        moves.push_back(CastleMove(sqE1 - offset,
+                                   sqC1 - offset,
+                                   Castle::Big));
     }
 }
 
 //-----------------------------------------------------------------------------
-const std::vector<Move>& Rules::generateValidMoves()
+// Staged generation used by MoveGenerator
+template void Rules::generatePseudoMoves<GenType::Captures>(MoveList&) const;
+template void Rules::generatePseudoMoves<GenType::Quiets>(MoveList&) const;
+template void Rules::generatePseudoMoves<GenType::AllMoves>(MoveList&) const;
+
+//-----------------------------------------------------------------------------
+const MoveList& Rules::generateValidMoves()
+{
+    syncStates();
+    updateLegalMoves();
+    return m_legal_moves;
+}
+
+//-----------------------------------------------------------------------------
+void Rules::updateLegalMoves()
 {
-    Square sqKing = findKing(m_board, m_side);
+    Square sqKing = findKing(m_side);
+    bool in_check = false;
     generatePseudoValidMoves();
 
     // No King found
     if (sqKing != Square::OOB)
     {
+        KingSafety safety;
+        computeKingSafety(sqKing, safety);
+        in_check = (safety.checkers != 0u);
+
         size_t i = m_legal_moves.size();
         while (i--)
         {
-            if (!tryMove(m_legal_moves[i], sqKing))
+            if (!isLegalMove(m_legal_moves[i], sqKing, safety))
             {
                 // Remove the move by swapping it with the last element that is
                 // discarding.
@@ -396,13 +639,17 @@ const std::vector<Move>& Rules::generateValidMoves()
         }
     }
 
-    updateGameStatus();
+    for (auto const& move: m_legal_moves)
+    {
+        m_legal_targets[move.from] |= bit(move.to);
+    }
+
+    updateGameStatus(in_check);
     //dispLegalMoves();
-    return m_legal_moves;
 }
 
 //-----------------------------------------------------------------------------
-void Rules::dispMoves(std::vector<Move> const& list, std::string const& msg) const
+void Rules::dispMoves(MoveList const& list, std::string const& msg) const
 {
     std::cout << msg << std::endl;
     for (const auto it: list)
@@ -414,18 +661,273 @@ void Rules::dispMoves(std::vector<Move> const& list, std::string const& msg) con
 
 //-----------------------------------------------------------------------------
 //! \note generateValidMoves() shall be called before calling this method
+bool Rules::isValid(Move const& move) const
+{
+    if (!(m_legal_targets[move.from] & bit(move.to)))
+        return false;
+
+    // A pawn reaching the last row shall be promoted, other moves shall not.
+    const bool promotion = (m_board[move.from].type == PieceType::Pawn) &&
+                           ((ROW(move.to) == 0u) || (ROW(move.to) == 7u));
+    return promotion == (move.promote() != PieceType::Empty);
+}
+
+//-----------------------------------------------------------------------------
 bool Rules::isValidMove(std::string const& move) const
 {
-    Move mvt(move);
+    return isValid(Move(move));
+}
+
+//-----------------------------------------------------------------------------
+Move Rules::completeMove(Move const& move) const
+{
+    const uint8_t from = move.from;
+    const uint8_t to = move.to;
+    const Piece piece = m_board[from];
+
+    if (piece.type == PieceType::Pawn)
+    {
+        if ((from == to + 16) || (to == from + 16))
+            return PawnDoubleMove(from, to);
+        if ((to == m_ep) && (COL(from) != COL(to)))
+            return PawnSimpleMove(from, to, true);
+    }
+    else if (piece.type == PieceType::King)
+    {
+        if (to == from + 2)
+            return CastleMove(from, to, Castle::Little);
+        if (from == to + 2)
+            return CastleMove(from, to, Castle::Big);
+    }
+    return move;
+}
+
+//-----------------------------------------------------------------------------
+std::string Rules::moves() const
+{
+    std::string str;
+    str.reserve(m_plies * 6u);
 
-    for (const auto it: m_legal_moves)
+    for (uint16_t i = 0u; i < m_plies; ++i)
     {
-        if (it == mvt)
+        if (i != 0u)
+            str += ' ';
+        str += toStrMove(m_undo[i].move);
+    }
+    return str;
+}
+
+//-----------------------------------------------------------------------------
+bool Rules::attacked(const uint8_t sq, const Color side) const
+{
+#ifdef USE_BITBOARDS
+    return m_bitboards.attacked(sq, side);
+#else
+    return attack(m_board, sq, side);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool Rules::isLegalMove(const Move move, const Square sqKing, KingSafety const& safety) const
+{
+    // The King cannot move along the ray of a slider checking it, and
+    // en-passant removes two pieces of the ray of a possible pin: play them.
+    if ((move.from == sqKing) || (move.ep()))
+        return tryMove(move, sqKing);
+
+    // Double check: only the King can move
+    if (safety.checkers > 1u)
+        return false;
+
+    // Simple check: take the checker or intercept its ray
+    if (!(safety.evasions & bit(move.to)))
+        return false;
+
+    // Pinned piece: can only move along the ray of the pin
+    if (safety.pinned & bit(move.from))
+        return (safety.pin_rays[move.from] & bit(move.to)) != 0u;
+
+    return true;
+}
+
+#ifdef USE_BITBOARDS
+
+//-----------------------------------------------------------------------------
+void Rules::computeKingSafety(const Square sqKing, KingSafety& safety) const
+{
+    const Color xside = opposite(m_side);
+    const bitboard occupancy = m_bitboards.occupied;
+    const bitboard opponents = m_bitboards.colors[xside];
+    bitboard const* p = m_bitboards.pieces[xside];
+    const bitboard checkers = m_bitboards.attackers(sqKing, xside, occupancy);
+
+    safety.checkers = popCount(checkers);
+    safety.evasions = checkers;
+    safety.pinned = 0u;
+
+    // Opponent sliders aligned with the King when ignoring our pieces: either
+    // they check the King or they pin the single piece between them.
+    bitboard snipers =
+            (rookAttacks(sqKing, opponents) & (p[PieceType::Rook] | p[PieceType::Queen]))
+          | (bishopAttacks(sqKing, opponents) & (p[PieceType::Bishop] | p[PieceType::Queen]));
+    while (snipers)
+    {
+        const uint8_t sq = popLsb(snipers);
+        const bool line = (ROW(sq) == ROW(sqKing)) || (COL(sq) == COL(sqKing));
+        const bitboard between = line
+                ? rookAttacks(sqKing, bit(sq)) & rookAttacks(sq, bit(sqKing))
+                : bishopAttacks(sqKing, bit(sq)) & bishopAttacks(sq, bit(sqKing));
+        const bitboard blockers = between & occupancy;
+
+        if (blockers == 0u)
         {
-            return true;
+            safety.evasions |= between;
+        }
+        else if (popCount(blockers) == 1)
+        {
+            const uint8_t pinned = lsb(blockers);
+            safety.pinned |= blockers;
+            safety.pin_rays[pinned] = between | bit(sq);
         }
     }
-    return false;
+
+    if (safety.checkers == 0u)
+    {
+        safety.evasions = ~bitboard(0u);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool Rules::tryMove(const Move move, Square sqKing) const
+{
+    //! \brief Temporary bitboards for computations.
+    Bitboards bitboards = m_bitboards;
+    const uint8_t from = move.from;
+    const uint8_t to = move.to;
+    Piece piece = m_board[from];
+
+    // Simulate the next move.
+    bitboards.remove(from, piece);
+    if (m_board[to].type != PieceType::Empty)
+    {
+        bitboards.remove(to, m_board[to]);
+    }
+    if (move.promote() != PieceType::Empty)
+    {
+        piece.type = move.promote();
+    }
+    bitboards.add(to, piece);
+
+    if (move.castle() != Castle::NoCastle)
+    {
+        const uint8_t offset = (m_side == Color::White) ? 0 : (sqE1 - sqE8);
+        const uint8_t rook_from = (move.castle() & Castle::Little) ? sqH1 - offset : sqA1 - offset;
+        const uint8_t rook_to = (move.castle() & Castle::Little) ? sqF1 - offset : sqD1 - offset;
+        bitboards.remove(rook_from, m_board[rook_from]);
+        bitboards.add(rook_to, m_board[rook_from]);
+    }
+    else if (move.ep())
+    {
+        const uint8_t taken = (m_side == Color::White) ? m_ep + 8 : m_ep - 8;
+        bitboards.remove(taken, m_board[taken]);
+    }
+
+    // King moved ? Update its position
+    if (from == sqKing)
+        sqKing = static_cast<Square>(to);
+
+    return !bitboards.attacked(sqKing, opposite(m_side));
+}
+
+#else // Mailbox
+
+//-----------------------------------------------------------------------------
+void Rules::computeKingSafety(const Square sqKing, KingSafety& safety) const
+{
+    const Color xside = opposite(m_side);
+    const uint8_t king = c_mailbox64[sqKing];
+
+    safety.checkers = 0u;
+    safety.evasions = 0u;
+    safety.pinned = 0u;
+
+    // Knights and pawns checking the King: only taking them parries the check.
+    constexpr auto knight = Movements<PieceType::Knight>::directions();
+    for (const int mvt: knight)
+    {
+        const uint8_t sq = c_mailbox120[king + mvt];
+        if ((sq != Square::OOB) && (m_board[sq].type == PieceType::Knight) &&
+            (m_board[sq].color == xside))
+        {
+            ++safety.checkers;
+            safety.evasions |= bit(sq);
+        }
+    }
+
+    const int forward = (m_side == Color::White) ? N : S;
+    for (const int mvt: { forward + W, forward + E })
+    {
+        const uint8_t sq = c_mailbox120[king + mvt];
+        if ((sq != Square::OOB) && (m_board[sq].type == PieceType::Pawn) &&
+            (m_board[sq].color == xside))
+        {
+            ++safety.checkers;
+            safety.evasions |= bit(sq);
+        }
+    }
+
+    // Walk along the rays of the King: the first opponent slider moving on
+    // this ray checks the King or pins the single piece of our side found
+    // before it.
+    constexpr auto rays = Movements<PieceType::Queen>::directions();
+    for (const int mvt: rays)
+    {
+        const PieceType slider = ((mvt == N) || (mvt == S) || (mvt == E) || (mvt == W))
+                                 ? PieceType::Rook : PieceType::Bishop;
+        bitboard ray = 0u;
+        uint8_t blocker = Square::OOB;
+
+        for (uint8_t sq = sqKing;;)
+        {
+            sq = c_mailbox120[c_mailbox64[sq] + mvt];
+            if (sq == Square::OOB)
+                break;
+
+            ray |= bit(sq);
+            const Piece piece = m_board[sq];
+            if (piece.type == PieceType::Empty)
+                continue;
+
+            if (piece.color == m_side)
+            {
+                // Two pieces of our side: no pin possible
+                if (blocker != Square::OOB)
+                    break;
+                blocker = sq;
+                continue;
+            }
+
+            if ((piece.type == slider) || (piece.type == PieceType::Queen))
+            {
+                if (blocker == Square::OOB)
+                {
+                    ++safety.checkers;
+                    safety.evasions |= ray;
+                }
+                else
+                {
+                    safety.pinned |= bit(blocker);
+                    safety.pin_rays[blocker] = ray;
+                }
+            }
+            break;
+        }
+    }
+
+    if (safety.checkers == 0u)
+    {
+        safety.evasions = ~bitboard(0u);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -444,6 +946,8 @@ bool Rules::tryMove(const Move move, Square sqKing) const
     return !isKingInCheck(board, sqKing, m_side);
 }
 
+#endif
+
 //-----------------------------------------------------------------------------
 bool Rules::isKingInCheck(chessboard const& board, const Square sqKing, const Color side) const
 {
@@ -451,50 +955,80 @@ bool Rules::isKingInCheck(chessboard const& board, const Square sqKing, const Co
 }
 
 //-----------------------------------------------------------------------------
-bool Rules::isKingInCheck(chessboard const& board, const Color side) const
+bool Rules::isKingInCheck(const Color side) const
 {
     // Special case for Neural network using empty chessboard with no Kings
-    if (m_no_kings)
+    const Square sqKing = findKing(side);
+    if (sqKing == Square::OOB)
         return false;
 
-    for (uint8_t i = 0u; i < NbSquares; ++i)
+    return attacked(sqKing, opposite(side));
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Can the piece of the given type placed on the square from reach the
+//! square sq of the position ?
+//-----------------------------------------------------------------------------
+template<PieceType pt>
+static bool reaches(chessboard const& position, const uint8_t from, const uint8_t sq)
+{
+    constexpr auto directions = Movements<pt>::directions();
+    for (const int mvt: directions)
     {
-        if ((board[i].type == PieceType::King) &&
-            (board[i].color == side))
+        for (uint8_t n = from;;)
         {
-            return attack(board, i, opposite(side));
+            n = c_mailbox120[c_mailbox64[n] + mvt];
+
+            if (n == Square::OOB)
+                break;
+
+            if (n == sq)
+                return true;
+
+            if ((!Movements<pt>::slide) || (position[n].type != PieceType::Empty))
+                break;
         }
     }
-    assert(1 && "isKingInCheck() did not find the King");
     return false;
 }
 
 //-----------------------------------------------------------------------------
-Square Rules::findKing(chessboard const& board, const Color side) const
+static bool reaches(chessboard const& position, const PieceType pt,
+                    const uint8_t from, const uint8_t sq)
 {
-    // Special case for Neural network using empty chessboard with no Kings
-    if (m_no_kings)
-        return Square::OOB;
-
-    for (uint8_t i = 0u; i < NbSquares; ++i)
+    switch (pt)
     {
-        if ((board[i].type == PieceType::King) &&
-            (board[i].color == side))
-        {
-            return static_cast<Square>(i);
-        }
+    case PieceType::Knight:
+        return reaches<PieceType::Knight>(position, from, sq);
+    case PieceType::Bishop:
+        return reaches<PieceType::Bishop>(position, from, sq);
+    case PieceType::Rook:
+        return reaches<PieceType::Rook>(position, from, sq);
+    case PieceType::Queen:
+        return reaches<PieceType::Queen>(position, from, sq);
+    case PieceType::King:
+        return reaches<PieceType::King>(position, from, sq);
+    default:
+        return false;
     }
+}
 
-    return Square::OOB;
+//-----------------------------------------------------------------------------
+bool Rules::hasAnyLegalMove() const
+{
+    MoveGenerator generator(*this);
+    Move move;
+
+    return generator.next(move);
 }
 
 //-----------------------------------------------------------------------------
 bool Rules::attack(const chessboard& position, const uint8_t sq, const Color side) const
 {
-    int n;
-
-    for (uint8_t i = 0u; i < NbSquares; ++i)
+    for (uint8_t k = 0u; k < m_pieces.count[side]; ++k)
     {
+        // Skip pieces taken in the position
+        const uint8_t i = m_pieces.squares[side][k];
         const Piece pinfo = position[i];
         if ((pinfo.type == PieceType::Empty) || (pinfo.color != side))
             continue;
@@ -517,125 +1051,253 @@ bool Rules::attack(const chessboard& position, const uint8_t sq, const Color sid
                     return true;
             }
         }
-        else
+        else if (reaches(position, piece, i, sq))
         {
-            for (uint8_t j = 0u; j < c_relative_movements[piece].size(); ++j)
-            {
-                for (n = i;;)
-                {
-                    n = c_mailbox120[c_mailbox64[n] + c_relative_movements[piece][j]];
-
-                    if (n == Square::OOB)
-                        break;
-
-                    if (n == sq)
-                        return true;
-
-                    if (position[n].type != PieceType::Empty)
-                        break;
-
-                    if (!pinfo.slide)
-                        break;
-                }
-            }
+            return true;
         }
     }
     return false;
 }
 
 //-----------------------------------------------------------------------------
-void Rules::applyMove(Move const& move)
+//! \brief Castle is no longer possible when a Rook leaves its initial square
+//! (moved or taken).
+//-----------------------------------------------------------------------------
+static void updateCastle(uint8_t (&castle)[2], const uint8_t sq)
 {
-    //FIXME
-    // if (m_status != Status::Playing) return ;
+    switch (sq)
+    {
+    case sqA1:
+        castle[Color::White] &= ~Castle::Big;
+        break;
+    case sqH1:
+        castle[Color::White] &= ~Castle::Little;
+        break;
+    case sqA8:
+        castle[Color::Black] &= ~Castle::Big;
+        break;
+    case sqH8:
+        castle[Color::Black] &= ~Castle::Little;
+        break;
+    default:
+        break;
+    }
+}
 
-    uint8_t from = move.from;
-    uint8_t to = move.to;
+//-----------------------------------------------------------------------------
+void Rules::putPiece(const uint8_t sq, const Piece piece)
+{
+    assert(m_board[sq].type == PieceType::Empty);
+    m_board[sq] = piece;
+    m_hash ^= Zobrist::piece(sq, piece);
+    m_pieces.add(sq, piece);
+#ifdef USE_BITBOARDS
+    m_bitboards.add(sq, piece);
+#endif
+}
 
-    //FIXME
-    //assert(legal_moves_generated);
-    //assert(isAllowed(move))
+//-----------------------------------------------------------------------------
+void Rules::removePiece(const uint8_t sq)
+{
+    assert(m_board[sq].type != PieceType::Empty);
+    m_hash ^= Zobrist::piece(sq, m_board[sq]);
+    m_pieces.remove(sq, m_board[sq]);
+#ifdef USE_BITBOARDS
+    m_bitboards.remove(sq, m_board[sq]);
+#endif
+    m_board[sq] = NoPiece;
+}
+
+//-----------------------------------------------------------------------------
+void Rules::makeMove(Move const& move)
+{
+    assert((m_plies < MaxPlies) && "Too many moves to be reverted");
 
-    // Add the move to the game notes
-    if (!m_moved.empty())
-        m_moved += ' ';
-    m_moved += c_square_names[from];
-    m_moved += c_square_names[to];
-    if (move.promote != PieceType::Empty)
+    const uint8_t from = move.from;
+    const uint8_t to = move.to;
+    const uint8_t offset = (m_side == Color::White) ? 0 : (sqE1 - sqE8);
+
+    // Save states for reverting the move
+    Undo& undo = m_undo[m_plies++];
+    undo.move = move;
+    undo.piece = m_board[from];
+    undo.taken = m_board[to];
+    undo.ep = m_ep;
+    undo.castle[0] = m_castle[0];
+    undo.castle[1] = m_castle[1];
+    undo.side = m_side;
+    undo.halfmove = m_halfmove;
+    undo.hash = m_hash;
+
+    // Fifty-move rule: reset by captures and pawn moves
+    if ((undo.piece.type == PieceType::Pawn) || (undo.taken.type != PieceType::Empty))
+        m_halfmove = 0u;
+    else
+        ++m_halfmove;
+
+    // Castle rights and en-passant will change: remove their keys
+    m_hash ^= Zobrist::castle(m_castle) ^ Zobrist::ep(m_ep);
+
+    // Take the opponent piece. For en passant move the taken pawn is
+    // not on the arrival square.
+    if (move.ep())
+    {
+        assert(m_ep != Square::OOB);
+        const uint8_t sq = (m_side == Color::White) ? m_ep + 8 : m_ep - 8;
+        undo.taken = m_board[sq];
+        removePiece(sq);
+    }
+    else if (undo.taken.type != PieceType::Empty)
     {
-        m_moved += piece2char(static_cast<PieceType>(move.promote));
+        removePiece(to);
     }
 
-    // Refresh the chessboard
-    updateBoard(move, m_board);
+    // Basic movement with possible promotion
+    Piece piece = undo.piece;
+    removePiece(from);
+    piece.moved = true;
+    if (move.promote() != PieceType::Empty)
+    {
+        piece.type = move.promote();
+        piece.slide = (move.promote() != PieceType::Knight);
+    }
+    putPiece(to, piece);
 
-    // Update castle status:
-    // if King moved then no longer castle available
-    if (m_board[to].type == PieceType::King)
+    // Castle: move the rook
+    if (move.castle() != Castle::NoCastle)
     {
-        m_castle[m_board[to].color] = Castle::NoCastle;
+        const bool little = (move.castle() & Castle::Little);
+        const uint8_t rook_from = (little ? sqH1 : sqA1) - offset;
+        const uint8_t rook_to = (little ? sqF1 : sqD1) - offset;
+        Piece rook = m_board[rook_from];
+        removePiece(rook_from);
+        rook.moved = true;
+        putPiece(rook_to, rook);
     }
 
-    // Update castle status:
-    // if Rook moved: castle can no longer be done
-    // on the rook side
-    else if (m_board[to].type == PieceType::Rook)
+    // Update castle status: if King moved then no longer castle available.
+    // If a Rook moved or has been taken: castle can no longer be done on
+    // the rook side.
+    if (piece.type == PieceType::King)
     {
-        if ((from == sqA1) || (from == sqA8))
-        {
-            m_castle[m_side] &= ~Castle::Big;
-        }
-        else if ((from == sqH1) || (from == sqH8))
-        {
-            m_castle[m_side] &= ~Castle::Little;
-        }
+        m_castle[m_side] = Castle::NoCastle;
     }
+    updateCastle(m_castle, from);
+    updateCastle(m_castle, to);
 
     // Update en passant status
-    else if (move.double_move)
+    if (move.double_move())
     {
-        if (m_side == Color::White)
-        {
-            m_ep = to + 8;
-        }
-        else
-        {
-            m_ep = to - 8;
-        }
+        m_ep = (m_side == Color::White) ? to + 8 : to - 8;
     }
     else
     {
         m_ep = Square::OOB;
     }
 
-    // Switch color to play and generate legal moves
+    // Switch color to play
     m_side = opposite(m_side);
-    generateValidMoves();
+    m_hash ^= Zobrist::castle(m_castle) ^ Zobrist::ep(m_ep) ^ c_zobrist.black;
+
+#ifdef CHECK_ZOBRIST
+    assert((m_hash == computeHash()) && "Incremental Zobrist key is wrong");
+#endif
 }
 
 //-----------------------------------------------------------------------------
-bool Rules::applyMove(std::string const& move)
+void Rules::unmakeMove()
 {
-    // Internal message (error, quitting ...)
-    if ((move[0] == ':') && (move[1] == ':'))
-        return false;
+    assert((m_plies > 0u) && "No move to revert");
 
-    Move mvt(move);
+    Undo const& undo = m_undo[--m_plies];
+    const Move move = undo.move;
 
-    // Stalemate
-    if (move == Move::none)
-        return false;
+    // Restore states
+    m_side = undo.side;
+    m_ep = undo.ep;
+    m_castle[0] = undo.castle[0];
+    m_castle[1] = undo.castle[1];
+    m_halfmove = undo.halfmove;
 
-    for (auto it: m_legal_moves)
+    // Castle: move back the rook
+    if (move.castle() != Castle::NoCastle)
     {
-        if (it == mvt)
+        const uint8_t offset = (m_side == Color::White) ? 0 : (sqE1 - sqE8);
+        const bool little = (move.castle() & Castle::Little);
+        const uint8_t rook_from = (little ? sqH1 : sqA1) - offset;
+        const uint8_t rook_to = (little ? sqF1 : sqD1) - offset;
+        Piece rook = m_board[rook_to];
+        removePiece(rook_to);
+        rook.moved = false;
+        putPiece(rook_from, rook);
+    }
+
+    // Move back the piece as it was before its move (promotion ...)
+    removePiece(move.to);
+    putPiece(move.from, undo.piece);
+
+    // Restore the taken piece
+    if (undo.taken.type != PieceType::Empty)
+    {
+        if (move.ep())
         {
-            // Note: use it not m because it contains
-            // more informations because computed by
-            // Rules class.
-            applyMove(it);
-            return true;
+            putPiece((m_side == Color::White) ? m_ep + 8 : m_ep - 8, undo.taken);
         }
+        else
+        {
+            putPiece(move.to, undo.taken);
+        }
+    }
+
+    m_hash = undo.hash;
+#ifdef CHECK_ZOBRIST
+    assert((m_hash == computeHash()) && "Incremental Zobrist key is wrong");
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool Rules::applyMove(Move const& move)
+{
+    //FIXME
+    // if (m_status != Status::Playing) return ;
+
+    if (!isValid(move))
+        return false;
+
+    // The history of moves is bounded: no room for reverting the move
+    if (m_plies >= MaxPlies)
+        return false;
+
+    // Refresh the chessboard and generate legal moves. Note: flags of moves
+    // given by external engines or GUI are missing.
+    makeMove(completeMove(move));
+    updateLegalMoves();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool Rules::applyMove(std::string const& move)
+{
+    // Internal message (error, quitting, stalemate ...)
+    if (move.compare(0u, 2u, "::") == 0)
+        return false;
+
+    // Move(std::string) does not check its argument
+    if (!isWellFormed(move))
+    {
+        std::cerr << "Cannot apply malformed move '"
+                  << move << "'" << std::endl;
+        return false;
+    }
+
+    if (applyMove(Move(move)))
+        return true;
+
+    if (m_plies >= MaxPlies)
+    {
+        std::cerr << "Cannot apply move '" << move << "': more than "
+                  << MaxPlies << " plies" << std::endl;
+        return false;
     }
 
     std::cerr << "Cannot apply illegal move '"
@@ -646,20 +1308,15 @@ bool Rules::applyMove(std::string const& move)
 //-----------------------------------------------------------------------------
 std::string Rules::revertLastMove()
 {
-    if (m_moved.empty())
+    if (0u == m_plies)
         return "";
 
-    auto pos = m_moved.rfind(" ");
-    pos = (std::string::npos == pos) ? 0 : pos + 1;
-
-    std::string last_move(m_moved.substr(pos));
+    const std::string last_move = toStrMove(lastMove());
     std::cout << opposite(m_side) << " reverted the move '"
               << last_move << "'" << std::endl;
 
-    std::string moves(m_moved.erase(pos));
-    bool res = applyMoves(moves, true);
-    assert(res && "Failed reverting last move");
-    (void) res;
+    unmakeMove();
+    updateLegalMoves();
     return last_move;
 }
 
@@ -674,26 +1331,26 @@ void Rules::updateBoard(Move const& move, chessboard& board) const
     board[to].moved = true;
 
     // Promotion
-    if (move.promote != PieceType::Empty)
+    if (move.promote() != PieceType::Empty)
     {
-        board[to].type = move.promote;
+        board[to].type = move.promote();
         board[to].color = board[from].color;
-        board[to].slide = (move.promote != PieceType::Knight);
+        board[to].slide = (move.promote() != PieceType::Knight);
     }
 
     board[from] = NoPiece;
 
     // Castle: move the rook
-    if (move.castle != Castle::NoCastle)
+    if (move.castle() != Castle::NoCastle)
     {
         const uint8_t offset = (m_side == Color::White) ? 0 : (sqE1 - sqE8);
-        if (move.castle & Castle::Little)
+        if (move.castle() & Castle::Little)
         {
             board[sqF1 - offset] = board[sqH1 - offset];
             board[sqF1 - offset].moved = true;
             board[sqH1 - offset] = NoPiece;
         }
-        else if (move.castle & Castle::Big)
+        else if (move.castle() & Castle::Big)
         {
             board[sqD1 - offset] = board[sqA1 - offset];
             board[sqD1 - offset].moved = true;
@@ -702,7 +1359,7 @@ void Rules::updateBoard(Move const& move, chessboard& board) const
     }
 
     // En passant move
-    else if (move.ep)
+    else if (move.ep())
     {
         assert(m_ep != Square::OOB);
         if (m_side == Color::White)
@@ -718,36 +1375,131 @@ void Rules::updateBoard(Move const& move, chessboard& board) const
 
 //-----------------------------------------------------------------------------
 //! \note generateValidMoves() shall be called before calling this method
-void Rules::updateGameStatus()
+void Rules::updateGameStatus(const bool in_check)
 {
-    if (m_legal_moves.size() != 0)
-    {
-        // If legal moves are possible this means the
-        // game is still in progress.
-        m_status = Status::Playing;
-    }
-    else if (m_no_kings)
+    m_status = computeStatus(m_legal_moves.size() != 0, in_check);
+}
+
+//-----------------------------------------------------------------------------
+Status Rules::computeStatus() const
+{
+    const Square sqKing = findKing(m_side);
+    const bool in_check = (sqKing != Square::OOB) && attacked(sqKing, opposite(m_side));
+
+    return computeStatus(hasAnyLegalMove(), in_check);
+}
+
+//-----------------------------------------------------------------------------
+Status Rules::computeStatus(const bool has_legal_move, const bool in_check) const
+{
+    if (!has_legal_move)
     {
-        // This is not a valid chess rule but for
-        // neural network and unit tests we sometimes
-        // need a chessboard without Kings. This hack
-        // allows to return a different status from
-        // stalemate.
-        m_status = Status::NoMoveAvailable;
+        if (m_no_kings)
+        {
+            // This is not a valid chess rule but for
+            // neural network and unit tests we sometimes
+            // need a chessboard without Kings. This hack
+            // allows to return a different status from
+            // stalemate.
+            return Status::NoMoveAvailable;
+        }
+
+        if (in_check)
+        {
+            // If no legal moves are possible but a King is
+            // in check: that means checkmate and therefore
+            // the end of the game.
+            return (Color::White == m_side) ? Status::BlackWon : Status::WhiteWon;
+        }
+
+        // No legal moves and the King not in check:
+        // that means stalemate and therefore the end
+        // of the game.
+        return Status::Stalemate;
     }
-    else if (isKingInCheck(m_board, m_side))
+
+    // Draws ending games where nobody can win or where players shuffle
+    // pieces forever.
+    if (isInsufficientMaterial())
+        return Status::InsufficientMaterial;
+
+    if (m_halfmove >= 100u)
+        return Status::FiftyMoves;
+
+    if (isThreefoldRepetition())
+        return Status::Repetition;
+
+    // If legal moves are possible this means the
+    // game is still in progress.
+    return Status::Playing;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t Rules::repetitions(const uint8_t max) const
+{
+    // Only positions since the last capture or pawn move, with the same side
+    // to move, can be identical. m_undo[i].hash is the key of the position
+    // before the move i.
+    const uint16_t plies = std::min(m_halfmove, m_plies);
+    uint8_t count = 0u;
+
+    for (uint16_t i = 4u; i <= plies; i += 2u)
     {
-        // If no legal moves are possible but a King is
-        // in check: that means checkmate and therefore
-        // the end of the game.
-        m_status = (Color::White == m_side) ?
-                   Status::BlackWon : Status::WhiteWon;
+        if ((m_undo[m_plies - i].hash == m_hash) && (++count == max))
+            break;
     }
-    else
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+bool Rules::isThreefoldRepetition() const
+{
+    return repetitions(2u) == 2u;
+}
+
+//-----------------------------------------------------------------------------
+bool Rules::isRepetition() const
+{
+    return repetitions(1u) == 1u;
+}
+
+//-----------------------------------------------------------------------------
+bool Rules::isInsufficientMaterial() const
+{
+    // Boards without Kings do not follow chess rules
+    if (m_no_kings)
+        return false;
+
+    // Kings and two pieces at most
+    if (m_pieces.count[Color::White] + m_pieces.count[Color::Black] > 4u)
+        return false;
+
+    uint8_t knights = 0u;
+    uint8_t bishops[2] = { 0u, 0u }; // indexed by the color of their square
+    for (uint8_t c = Color::Black; c <= Color::White; ++c)
     {
-        // No legal moves and the King not in check:
-        // that means stalemate and therefore the end
-        // of the game.
-        m_status = Status::Stalemate;
+        for (uint8_t i = 0u; i < m_pieces.count[c]; ++i)
+        {
+            const uint8_t sq = m_pieces.squares[c][i];
+            switch (m_board[sq].type)
+            {
+            case PieceType::King:
+                break;
+            case PieceType::Knight:
+                ++knights;
+                break;
+            case PieceType::Bishop:
+                ++bishops[(ROW(sq) + COL(sq)) & 1u];
+                break;
+            default:
+                // Pawns, Rooks and Queens can mate
+                return false;
+            }
+        }
     }
+
+    // King and a minor piece against King, or Bishops on the same color
+    const uint8_t minors = uint8_t(knights + bishops[0] + bishops[1]);
+    return (minors <= 1u) ||
+           ((knights == 0u) && ((bishops[0] == 0u) || (bishops[1] == 0u)));
 }
@@ -22,13 +22,22 @@
 #  define CHESS_RULES_HPP
 
 #  include "Chess/Move.hpp"
+#  include "Chess/Bitboard.hpp"
+#  include "Chess/Zobrist.hpp"
+#  include "Chess/PieceList.hpp"
 #  include <vector>
 
 //! \brief Game status. When the game status is different from Playing
 //! that means the game has ended and for example: -- GUI should stop accepting
 //! moving pieces from user mouse clicks; -- disable communication with other
-//! chess engines.
-enum Status { Playing, WhiteWon, BlackWon, Stalemate, NoMoveAvailable, /*FIXME a separer*/ InternalError };
+//! chess engines. Repetition (threefold), FiftyMoves and InsufficientMaterial
+//! are draws.
+enum Status { Playing, WhiteWon, BlackWon, Stalemate, Repetition, FiftyMoves,
+              InsufficientMaterial, NoMoveAvailable, /*FIXME a separer*/ InternalError };
+
+//! \brief Kind of pseudo legal moves to generate. Promotions are generated
+//! with captures.
+enum GenType { Captures, Quiets, AllMoves };
 
 //! \brief Give this information to the Rules class if you desired no Kings on the chessboard.
 //! This violates the chess rules but is useful for neural network trainings or unit tests.
@@ -50,14 +59,57 @@ struct Initial
     uint8_t     ep; // en-passant
     uint8_t     castle[2];
     Color       side;
+    uint16_t    halfmove; // plies since the last capture or pawn move
+};
+
+//! \brief Max number of moves (plies) which can be reverted.
+constexpr uint16_t MaxPlies = 1024u;
+
+// *****************************************************************************
+//! \brief States saved by Rules::makeMove() for reverting the move in O(1) with
+//! Rules::unmakeMove().
+// *****************************************************************************
+struct Undo
+{
+    Move        move;
+    Piece       piece; // moved piece (before its promotion)
+    Piece       taken; // taken piece (NoPiece if none)
+    uint8_t     ep; // en-passant
+    uint8_t     castle[2];
+    Color       side;
+    uint16_t    halfmove; // plies since the last capture or pawn move
+    uint64_t    hash; // Zobrist key
+};
+
+// *****************************************************************************
+//! \brief Checks and pins of the King of the side to move. Computed once per
+//! position by Rules::computeKingSafety() for filtering pseudo legal moves
+//! without playing them.
+// *****************************************************************************
+struct KingSafety
+{
+    //! \brief Number of opponent pieces checking the King.
+    uint8_t     checkers;
+    //! \brief Squares where a piece (other than the King) can move to parry
+    //! the check: the checker and the squares between it and the King. All
+    //! squares when the King is not in check.
+    bitboard    evasions;
+    //! \brief Pieces pinned against their King.
+    bitboard    pinned;
+    //! \brief For each pinned piece: squares of the ray between the King and
+    //! the pinning piece (included) where the pinned piece can still move.
+    bitboard    pin_rays[NbSquares];
 };
 
 // *****************************************************************************
 //! \brief Structure storing the piece position on the board and all movements.
 //! This structure can be used by other classes.
 // *****************************************************************************
-class Rules // TODO add Kings positions, add number of pieces
+class Rules
 {
+    //! \brief Staged generation of legal moves.
+    friend class MoveGenerator;
+
 public:
 
     //! \brief Start a new game with figures at their initial position.
@@ -100,12 +152,12 @@ public:
     //! if the king can be in check).
     //! The result is stored in m_pseudo_moves which is also returned.
     //! \return Return m_pseudo_moves.
-    const std::vector<Move>& generatePseudoValidMoves();
+    const MoveList& generatePseudoValidMoves();
 
     //! \brief Generate a list of legal moves from m_pseudo_moves.
     //! The result is stored in m_legal_moves which is also returned.
     //! \return Return m_legal_moves.
-    const std::vector<Move>& generateValidMoves();
+    const MoveList& generateValidMoves();
 
     //! \brief Display on std::cout all legal moves generated by
     //! generateValidMoves(). To be used for debuging.
@@ -114,40 +166,122 @@ public:
         dispMoves(m_legal_moves, "Legal moves :");
     }
 
-    //! \brief Check in m_pseudo_moves if the given move is found.
+    //! \brief Check in O(1) if the given move is a legal move of the current
+    //! position. Only squares and promotion of the move are checked (flags
+    //! for castle, en-passant ... are not needed).
+    //! \note generateValidMoves() shall be called before.
     //! \param[in] move the piece movement to be tested.
     //! \return Return true if the move is valid.
+    bool isValid(Move const& move) const;
+
+    //! \brief Same than isValid() but for a move in UCI notation (ie "e2e4").
     bool isValidMove(std::string const& move) const;
 
-    //! \brief Update all states with a new valid move.
-    //! \param[in] move the piece movement to be tested.
-    //! \return Return true if the move can be applied.
+    //! \brief Update all states with a new valid move: play it, generate legal
+    //! moves of the new position and update the game status.
+    //! \param[in] move the piece movement to be tested. Flags for castle,
+    //! en-passant ... are not needed.
+    //! \return Return true if the move can be applied: false for an illegal
+    //! move or when the game already has MaxPlies moves.
+    bool applyMove(Move const& move);
+
+    //! \brief Same than applyMove(Move) but for a move in UCI notation.
+    //! Return false for strings not in UCI notation.
     bool applyMove(std::string const& move);
 
+    //! \brief Return the moves played since the initial position in UCI
+    //! notation separated by spaces (ie "e2e4 e7e5"). The string is built
+    //! from the stack of played moves only when called (external engines,
+    //! GUI ...).
+    std::string moves() const;
+
+    //! \brief Return the last played move.
+    //! \note plies() shall be greater than 0.
+    inline Move const& lastMove() const
+    {
+        assert(m_plies > 0u);
+        return m_undo[m_plies - 1u].move;
+    }
+
     //! \brief move back the last move (if any).
     //! This method will revert applyMove().
     //! \return the reverted move.
     std::string revertLastMove();
 
-    //! \brief Localize the King. Return its square
-    Square findKing(chessboard const& board, const Color side) const;
+    //! \brief Play a legal move on the chessboard and save what is needed for
+    //! reverting it. Contrary to applyMove(), legal moves of the new position
+    //! are not generated and the game status and game notes are not updated:
+    //! this is the lightweight method for walking the tree of moves.
+    //! \param[in] move a legal move returned by generateValidMoves() (flags
+    //! for castle, en-passant ... are needed).
+    void makeMove(Move const& move);
+
+    //! \brief Revert in O(1) the last move played by makeMove().
+    void unmakeMove();
+
+    //! \brief Return the number of moves which can be reverted.
+    inline uint16_t plies() const { return m_plies; }
+
+    //! \brief Return the Zobrist key of the current position (pieces, side
+    //! to move, castle rights and en-passant). Updated incrementally by
+    //! makeMove() and unmakeMove().
+    inline uint64_t hash() const { return m_hash; }
+
+    //! \brief Compute from scratch the Zobrist key of the current position.
+    //! Slow: used for checking hash().
+    uint64_t computeHash() const;
+
+    //! \brief Localize the King in O(1). Return its square or Square::OOB
+    //! when playing without Kings.
+    inline Square findKing(const Color side) const
+    {
+        return m_no_kings ? Square::OOB : static_cast<Square>(m_pieces.kings[side]);
+    }
 
     //! \brief Check if the King is in check.
     //! \return Return true if the king is in check.
-    bool isKingInCheck(chessboard const& board, const Color side) const;
+    bool isKingInCheck(const Color side) const;
+
+    //! \brief Check if the side to move has at least one legal move. Stop at
+    //! the first legal move found without generating all legal moves.
+    bool hasAnyLegalMove() const;
 
     //! \brief Return the game status (checkmate, playing ...).
     //! The status is computed by updateGameStatus() once for
     //! each moves to avoid useless computations.
     Status status() const { return m_status; }
 
+    //! \brief Compute the game status of the current position without
+    //! generating all legal moves: the check is computed once from the King
+    //! square and the generation stops at the first legal move. To be used
+    //! after makeMove() which does not update the game status.
+    Status computeStatus() const;
+
+    //! \brief Return the number of plies since the last capture or pawn move
+    //! (fifty-move rule).
+    inline uint16_t halfmoves() const { return m_halfmove; }
+
+    //! \brief Check if the current position occurred at least twice before
+    //! since the last capture or pawn move (threefold repetition).
+    bool isThreefoldRepetition() const;
+
+    //! \brief Check if the current position occurred at least once before
+    //! since the last capture or pawn move. Used by searches for scoring as a
+    //! draw positions repeated inside the tree of moves.
+    bool isRepetition() const;
+
+    //! \brief Check if no sequence of legal moves can lead to a checkmate:
+    //! King against King, King and a minor piece against King, Kings and
+    //! Bishops on squares of the same color.
+    bool isInsufficientMaterial() const;
+
     //! \brief
     //inline void sidePlayed() { m_side = opposite(m_side); }
 
 private:
 
     //! \brief Base class for displaying list of moves.
-    void dispMoves(std::vector<Move> const& list, std::string const& msg) const;
+    void dispMoves(MoveList const& list, std::string const& msg) const;
 
     //! \brief Check if the King localized on the given square is in check.
     //! \param[in] sqKing valid square where the king is located.
@@ -160,29 +294,99 @@ private:
     //! \param move shall be a valid move.
     void updateBoard(Move const& move, chessboard& board) const;
 
+    //! \brief Place a piece on an empty square of m_board (and refresh
+    //! other representations of the chessboard).
+    void putPiece(const uint8_t sq, const Piece piece);
+
+    //! \brief Remove the piece placed on the square of m_board (and refresh
+    //! other representations of the chessboard).
+    void removePiece(const uint8_t sq);
+
+    //! \brief Refresh states computed from m_board. Needed because m_board
+    //! can be modified directly (unit tests, neural network trainings).
+    void syncStates();
+
+    //! \brief Generate legal moves and update the game status without
+    //! refreshing states computed from m_board.
+    void updateLegalMoves();
+
+    //! \brief Append to the list the pseudo legal moves of the given kind.
+    //! \tparam gen captures (and promotions), quiet moves or all moves.
+    template<GenType gen>
+    void generatePseudoMoves(MoveList& moves) const;
+
+#  ifdef USE_BITBOARDS
+    //! \brief Generate the list of pseudo legal of pawn moves from bitboards.
+    template<GenType gen>
+    void generatePseudoLegalPawnMoves(MoveList& moves) const;
+
+    //! \brief Generate the list of pseudo legal of pieces moves from bitboards.
+    template<GenType gen>
+    void generatePseudoLegalPieceMoves(const PieceType pt, MoveList& moves) const;
+
+    //! \brief Add moves from the square from to all squares of the bitboard.
+    void addMoves(const uint8_t from, bitboard targets, MoveList& moves) const;
+#  else
     //! \brief Generate a list of pseudo legal of pawn moves.
-    void generatePseudoLegalPawnMove(const uint8_t from, const PieceType pt);
+    //! \tparam side the color of the pawn.
+    template<GenType gen, Color side>
+    void generatePseudoLegalPawnMove(const uint8_t from, MoveList& moves) const;
 
     //! \brief Generate a list of pseudo legal of pieces moves.
-    void generatePseudoLegalPieceMove(const uint8_t from, const PieceType pt);
+    //! \tparam pt the type of the piece (Knight, Bishop, Rook, Queen, King).
+    template<GenType gen, PieceType pt>
+    void generatePseudoLegalPieceMove(const uint8_t from, MoveList& moves) const;
+#  endif
+
+    //! \brief Add the promotions of the pawn to Rook, Knight, Bishop, Queen.
+    void addPromotions(const uint8_t from, const uint8_t to, MoveList& moves) const;
 
     //! \brief Generate a list of pseudo legal of castle moves.
-    void generatePseudoLegalCastleMove();
+    void generatePseudoLegalCastleMove(MoveList& moves) const;
+
+    //! \brief Return the move with its flags (castle, en-passant, pawn double
+    //! move) deduced from the chessboard.
+    Move completeMove(Move const& move) const;
 
-    //! \brief update all states with a new valid move.
-    void applyMove(Move const& move);
+    //! \brief Compute pieces checking and pieces pinned against the King of
+    //! the side to move.
+    //! \param[in] sqKing the square in where the king is.
+    void computeKingSafety(const Square sqKing, KingSafety& safety) const;
+
+    //! \brief From a given pseudo legal move, check if it's a legal move or
+    //! not. Only King moves and en-passant need to play the move (tryMove()),
+    //! other moves are checked against checks and pins.
+    //! \param[in] sqKing the square in where the king is.
+    bool isLegalMove(const Move move, const Square sqKing, KingSafety const& safety) const;
 
     //! \brief From a given pseudo legal move, check if it's a
-    //! legal move or not.
+    //! legal move or not by playing it on a copy of the chessboard.
     //! \param[in] sqKing the square in where the king is.
     bool tryMove(const Move move, Square sqKing) const;
 
+    //! \brief Check if the square sq of the current position is attacked by a
+    //! piece of the color side.
+    bool attacked(const uint8_t sq, const Color side) const;
+
     //! \brief From a given position, check if the square sq is attacked by a piece of the
     //! opponent side of side.
+    //! \note Attackers are taken from the piece lists of m_board: position shall be
+    //! m_board or a copy of m_board where only pieces of the opposite color of side
+    //! have moved.
     bool attack(const chessboard& position, const /*FIXME Square*/ uint8_t sq, const Color side) const;
 
+    //! \brief Count how many times the current position occurred before since
+    //! the last capture or pawn move.
+    //! \param[in] max stop counting when reaching this number.
+    uint8_t repetitions(const uint8_t max) const;
+
     //! \brief Update the game status (checkmate, playing ...)
-    void updateGameStatus();
+    //! \param[in] in_check is the King of the side to move in check ?
+    void updateGameStatus(const bool in_check);
+
+    //! \brief Game status from the existence of a legal move, the check of
+    //! the King and draw rules.
+    Status computeStatus(const bool has_legal_move, const bool in_check) const;
 
     //! \brief Save initial chessboard states after loading a FEN.
     void saveStates();
@@ -193,11 +397,12 @@ public: // FIXME should be private but ok because the class is used as const
     Status                m_status;
     //! \brief The Indicate which player can move.
     Color                 m_side;
-    //! \brief Save the list of moves which made m_board.
-    std::string           m_moved;//FIXME: a renommer
     //! \brief List of legal moves from m_board.
-    std::vector<Move>     m_legal_moves;
-    //! \brief Current pieces positions after playing all moves stored in m_moved.
+    MoveList              m_legal_moves;
+    //! \brief Destination squares of legal moves indexed by their origin
+    //! square. Used by isValid().
+    std::array<bitboard, NbSquares> m_legal_targets{};
+    //! \brief Current pieces positions after playing all moves stored in m_undo.
     chessboard            m_board;
     //! \brief Set it true for unit tests or neural network and when its allowed to
     //! have no kings in the chessboard (which is not allowed by standard rules).
@@ -211,6 +416,21 @@ public: // FIXME should be private but ok because the class is used as const
     uint8_t               m_castle[2]; // FIXME: correct type is OR'ed enum Castle
     //! \brief Save chessboard states after loading FEN position.
     Initial               m_initial;
+    //! \brief Stack of states for reverting played moves.
+    std::array<Undo, MaxPlies> m_undo;
+    //! \brief Number of moves stored in m_undo.
+    uint16_t              m_plies = 0u;
+    //! \brief Number of plies since the last capture or pawn move.
+    uint16_t              m_halfmove = 0u;
+    //! \brief Zobrist key of the current position.
+    uint64_t              m_hash = 0u;
+    //! \brief Squares of the pieces of each color and of the Kings.
+    PieceLists            m_pieces;
+#  ifdef USE_BITBOARDS
+    //! \brief Bitboard representation of m_board used for generating moves.
+    //! Updated with m_board by makeMove() and unmakeMove().
+    Bitboards             m_bitboards;
+#  endif
 };
 
 #endif
@@ -0,0 +1,705 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "Chess/Search.hpp"
+#include "Chess/MoveGenerator.hpp"
+#include "Chess/Perft.hpp"
+#include "Utils/Arena.hpp"
+#include "Utils/HeapCounter.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+//! \brief Value of pieces in centipawns indexed by enum PieceType.
+static constexpr int c_piece_values[8] =
+{
+    0, 500, 320, 330, 900, 0, 100, 0
+};
+
+//! \brief Piece-square tables for the Whites (simplified evaluation function of
+//! Tomasz Michniewski) indexed by [enum PieceType][enum Square]. Squares of the
+//! Blacks are mirrored.
+static constexpr int c_piece_squares[PieceType::Pawn + 1][NbSquares] =
+{
+    // Empty
+    { 0 },
+    // Rook
+    {   0,  0,  0,  0,  0,  0,  0,  0,
+        5, 10, 10, 10, 10, 10, 10,  5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+        0,  0,  0,  5,  5,  0,  0,  0 },
+    // Knight
+    { -50,-40,-30,-30,-30,-30,-40,-50,
+      -40,-20,  0,  0,  0,  0,-20,-40,
+      -30,  0, 10, 15, 15, 10,  0,-30,
+      -30,  5, 15, 20, 20, 15,  5,-30,
+      -30,  0, 15, 20, 20, 15,  0,-30,
+      -30,  5, 10, 15, 15, 10,  5,-30,
+      -40,-20,  0,  5,  5,  0,-20,-40,
+      -50,-40,-30,-30,-30,-30,-40,-50 },
+    // Bishop
+    { -20,-10,-10,-10,-10,-10,-10,-20,
+      -10,  0,  0,  0,  0,  0,  0,-10,
+      -10,  0,  5, 10, 10,  5,  0,-10,
+      -10,  5,  5, 10, 10,  5,  5,-10,
+      -10,  0, 10, 10, 10, 10,  0,-10,
+      -10, 10, 10, 10, 10, 10, 10,-10,
+      -10,  5,  0,  0,  0,  0,  5,-10,
+      -20,-10,-10,-10,-10,-10,-10,-20 },
+    // Queen
+    { -20,-10,-10, -5, -5,-10,-10,-20,
+      -10,  0,  0,  0,  0,  0,  0,-10,
+      -10,  0,  5,  5,  5,  5,  0,-10,
+       -5,  0,  5,  5,  5,  5,  0, -5,
+        0,  0,  5,  5,  5,  5,  0, -5,
+      -10,  5,  5,  5,  5,  5,  0,-10,
+      -10,  0,  5,  0,  0,  0,  0,-10,
+      -20,-10,-10, -5, -5,-10,-10,-20 },
+    // King (middle game)
+    { -30,-40,-40,-50,-50,-40,-40,-30,
+      -30,-40,-40,-50,-50,-40,-40,-30,
+      -30,-40,-40,-50,-50,-40,-40,-30,
+      -30,-40,-40,-50,-50,-40,-40,-30,
+      -20,-30,-30,-40,-40,-30,-30,-20,
+      -10,-20,-20,-20,-20,-20,-20,-10,
+       20, 20,  0,  0,  0,  0, 20, 20,
+       20, 30, 10,  0,  0, 10, 30, 20 },
+    // Pawn
+    {   0,  0,  0,  0,  0,  0,  0,  0,
+       50, 50, 50, 50, 50, 50, 50, 50,
+       10, 10, 20, 30, 30, 20, 10, 10,
+        5,  5, 10, 25, 25, 10,  5,  5,
+        0,  0,  0, 20, 20,  0,  0,  0,
+        5, -5,-10,  0,  0,-10, -5,  5,
+        5, 10, 10,-20,-20, 10, 10,  5,
+        0,  0,  0,  0,  0,  0,  0,  0 },
+};
+
+//! \brief Piece-square table of the King in endgames: go to the center.
+static constexpr int c_king_endgame[NbSquares] =
+{
+    -50,-40,-30,-20,-20,-30,-40,-50,
+    -30,-20,-10,  0,  0,-10,-20,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-30,  0,  0,  0,  0,-30,-30,
+    -50,-30,-30,-30,-30,-30,-30,-50
+};
+
+//! \brief Below this material (Kings and pawns excluded) the position is
+//! evaluated as an endgame.
+static constexpr int c_endgame_material = 2600;
+
+//! \brief Number of nodes between two checks of the search duration.
+static constexpr uint64_t c_time_check_nodes = 1024u;
+
+//! \brief Bonus of ordering moves.
+static constexpr int32_t c_tt_move_bonus = 1000000;
+static constexpr int32_t c_capture_bonus = 100000;
+static constexpr int32_t c_killer_bonus = 90000;
+//! \brief History scores are halved when reaching this value so that they
+//! stay below c_killer_bonus.
+static constexpr int32_t c_history_max = 80000;
+
+//-----------------------------------------------------------------------------
+int evaluate(Rules const& rules)
+{
+    int score[2] = { 0, 0 };
+    int material = 0;
+
+    for (uint8_t color = Color::Black; color <= Color::White; ++color)
+    {
+        const uint8_t* squares = rules.m_pieces.squares[color];
+        const uint8_t count = rules.m_pieces.count[color];
+        const uint8_t mirror = (color == Color::White) ? 0u : 56u;
+
+        for (uint8_t i = 0u; i < count; ++i)
+        {
+            const uint8_t sq = squares[i];
+            const PieceType type = static_cast<PieceType>(rules.m_board[sq].type);
+
+            if (type != PieceType::Pawn)
+            {
+                material += c_piece_values[type];
+            }
+            if (type != PieceType::King)
+            {
+                score[color] += c_piece_values[type] + c_piece_squares[type][sq ^ mirror];
+            }
+        }
+    }
+
+    // King placement depends on the remaining material
+    for (uint8_t color = Color::Black; color <= Color::White; ++color)
+    {
+        const uint8_t sq = rules.m_pieces.kings[color];
+        if (sq != Square::OOB)
+        {
+            const uint8_t mirrored = sq ^ ((color == Color::White) ? 0u : 56u);
+            score[color] += (material <= c_endgame_material)
+                            ? c_king_endgame[mirrored]
+                            : c_piece_squares[PieceType::King][mirrored];
+        }
+    }
+
+    const Color side = rules.m_side;
+    return score[side] - score[opposite(side)];
+}
+
+//-----------------------------------------------------------------------------
+std::ostream& operator<<(std::ostream& os, SearchResult const& result)
+{
+    os << "depth " << int(result.depth)
+       << " score " << result.score
+       << " nodes " << result.nodes
+       << " time " << std::fixed << std::setprecision(3) << result.seconds << " s "
+       << result.nps() << " nodes/s"
+       << " hashfull " << result.hashfull << " tt " << result.tt;
+    if (!result.move.isNull())
+    {
+        os << " bestmove " << toStrMove(result.move);
+    }
+    return os;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Mate scores are stored in the transposition table relative to the
+//! position instead of the root.
+static inline int16_t toTT(const int score, const uint8_t ply)
+{
+    if (score >= ScoreMate - MaxSearchPlies)
+        return int16_t(score + ply);
+    if (score <= -ScoreMate + MaxSearchPlies)
+        return int16_t(score - ply);
+    return int16_t(score);
+}
+
+//-----------------------------------------------------------------------------
+static inline int fromTT(const int16_t score, const uint8_t ply)
+{
+    if (score >= ScoreMate - MaxSearchPlies)
+        return score - ply;
+    if (score <= -ScoreMate + MaxSearchPlies)
+        return score + ply;
+    return score;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Swap the best scored move of [i, size[ with the move i.
+static inline Move pickMove(MoveList& moves, int32_t* scores, const size_t i)
+{
+    size_t best = i;
+    for (size_t j = i + 1u; j < moves.size(); ++j)
+    {
+        if (scores[j] > scores[best])
+            best = j;
+    }
+    std::swap(moves[i], moves[best]);
+    std::swap(scores[i], scores[best]);
+    return moves[i];
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Type of the piece captured by the move (or PieceType::Empty).
+static inline PieceType captured(Rules const& rules, Move const& move)
+{
+    if (move.ep())
+        return PieceType::Pawn;
+
+    return static_cast<PieceType>(rules.m_board[move.to].type);
+}
+
+//-----------------------------------------------------------------------------
+std::chrono::steady_clock::time_point
+SearchLimits::end(std::chrono::steady_clock::time_point const& start) const
+{
+    if (movetime == 0u)
+        return deadline;
+    return std::min(deadline, start + std::chrono::milliseconds(movetime));
+}
+
+//-----------------------------------------------------------------------------
+SearchLimits SearchLimits::relative() const
+{
+    using namespace std::chrono;
+
+    SearchLimits limits(*this);
+    if (deadline == steady_clock::time_point::max())
+        return limits;
+
+    // An expired deadline still gives a minimal budget for returning a move
+    const int64_t ms = duration_cast<milliseconds>(deadline - steady_clock::now()).count();
+    const uint32_t remaining = uint32_t(std::min<int64_t>(std::max<int64_t>(1, ms), UINT32_MAX));
+    limits.movetime = (movetime == 0u) ? remaining : std::min(movetime, remaining);
+    limits.deadline = steady_clock::time_point::max();
+    return limits;
+}
+
+//-----------------------------------------------------------------------------
+SearchLimits tightest(SearchLimits const& a, SearchLimits const& b)
+{
+    // 0 means no limit
+    auto least = [](auto x, auto y) { return (x == 0u) ? y : ((y == 0u) ? x : std::min(x, y)); };
+
+    SearchLimits limits;
+    limits.depth = std::min(a.depth, b.depth);
+    limits.nodes = least(a.nodes, b.nodes);
+    limits.movetime = least(a.movetime, b.movetime);
+    limits.time = (b.time != 0u) ? b.time : a.time;
+    limits.inc = (b.time != 0u) ? b.inc : a.inc;
+    limits.deadline = std::min(a.deadline, b.deadline);
+    limits.stop = (b.stop != nullptr) ? b.stop : a.stop;
+    limits.abort = (b.abort != nullptr) ? b.abort : a.abort;
+    return limits;
+}
+
+//-----------------------------------------------------------------------------
+Search::Search(TranspositionTable& tt)
+    : m_tt(tt)
+{}
+
+//-----------------------------------------------------------------------------
+bool Search::stopped()
+{
+    if (m_stopped)
+        return true;
+
+    if (m_stop.load(std::memory_order_relaxed) || m_limits.stopRequested())
+    {
+        m_stopped = true;
+    }
+    else if ((m_limits.nodes != 0u) && (m_nodes >= m_limits.nodes))
+    {
+        m_stopped = true;
+    }
+    else if ((m_nodes % c_time_check_nodes) == 0u)
+    {
+        m_live_nodes.store(m_nodes, std::memory_order_relaxed);
+        if (m_end != std::chrono::steady_clock::time_point::max())
+        {
+            m_stopped = (std::chrono::steady_clock::now() >= m_end);
+        }
+    }
+    return m_stopped;
+}
+
+//-----------------------------------------------------------------------------
+void Search::generate(Rules const& rules, const bool quiets, Move const& tt_move,
+                      const uint8_t ply, MoveList& moves, int32_t* scores) const
+{
+    MoveGenerator generator(rules, quiets);
+    Move move;
+
+    while (generator.next(move))
+    {
+        int32_t score;
+        const PieceType victim = captured(rules, move);
+
+        if (move == tt_move)
+        {
+            score = c_tt_move_bonus;
+        }
+        else if ((victim != PieceType::Empty) || (move.promote() != PieceType::Empty))
+        {
+            // MVV-LVA: most valuable victim first, then least valuable attacker
+            const PieceType attacker = static_cast<PieceType>(rules.m_board[move.from].type);
+            score = c_capture_bonus + 10 * c_piece_values[victim]
+                    + c_piece_values[move.promote()]
+                    - c_piece_values[attacker] / 10;
+        }
+        else if (move == m_killers[ply][0])
+        {
+            score = c_killer_bonus + 1;
+        }
+        else if (move == m_killers[ply][1])
+        {
+            score = c_killer_bonus;
+        }
+        else
+        {
+            score = m_history[rules.m_side][move.from][move.to];
+        }
+
+        scores[moves.size()] = score;
+        moves.push_back(move);
+    }
+}
+
+//-----------------------------------------------------------------------------
+int Search::quiescence(Rules& rules, int alpha, int beta, const uint8_t ply)
+{
+    if (stopped())
+        return 0;
+    ++m_nodes;
+
+    if ((ply >= MaxSearchPlies - 1u) || (rules.plies() >= MaxPlies - 1u))
+        return evaluate(rules);
+
+    // When in check all evasions are searched else the side to move can stand
+    // pat instead of capturing.
+    const bool in_check = rules.isKingInCheck(rules.m_side);
+    int best_score = -ScoreInfinite;
+    if (!in_check)
+    {
+        best_score = evaluate(rules);
+        if (best_score >= beta)
+            return best_score;
+        if (best_score > alpha)
+            alpha = best_score;
+    }
+
+    MoveList moves;
+    int32_t scores[MaxMoves];
+    generate(rules, in_check, Move::null(), ply, moves, scores);
+    if (in_check && moves.empty())
+        return -ScoreMate + ply;
+
+    for (size_t i = 0u; i < moves.size(); ++i)
+    {
+        const Move move = pickMove(moves, scores, i);
+
+        rules.makeMove(move);
+        const int score = -quiescence(rules, -beta, -alpha, uint8_t(ply + 1u));
+        rules.unmakeMove();
+
+        if (m_stopped)
+            return 0;
+
+        if (score > best_score)
+        {
+            best_score = score;
+            if (score > alpha)
+            {
+                alpha = score;
+                if (score >= beta)
+                    break;
+            }
+        }
+    }
+
+    return best_score;
+}
+
+//-----------------------------------------------------------------------------
+int Search::alphaBeta(Rules& rules, int alpha, int beta, int depth, const uint8_t ply)
+{
+    if (ply > 0u)
+    {
+        if ((rules.halfmoves() >= 100u) || rules.isRepetition() ||
+            rules.isInsufficientMaterial())
+            return 0;
+    }
+
+    // Check extension: do not enter the quiescence search when in check
+    const bool in_check = rules.isKingInCheck(rules.m_side);
+    if (in_check)
+        ++depth;
+
+    if (depth <= 0)
+        return quiescence(rules, alpha, beta, ply);
+
+    if (stopped())
+        return 0;
+    ++m_nodes;
+
+    if ((ply >= MaxSearchPlies - 1u) || (rules.plies() >= MaxPlies - 1u))
+        return evaluate(rules);
+
+    // Cutoff from a previous search of the same position
+    TTEntry entry;
+    Move tt_move = Move::null();
+    if (m_tt.probe(rules.hash(), entry))
+    {
+        ++m_tt_stats.hits;
+        tt_move = entry.move;
+        if ((ply > 0u) && (entry.depth >= depth))
+        {
+            const int score = fromTT(entry.score, ply);
+            if ((entry.bound == Bound::ExactBound) ||
+                ((entry.bound == Bound::LowerBound) && (score >= beta)) ||
+                ((entry.bound == Bound::UpperBound) && (score <= alpha)))
+                return score;
+        }
+    }
+    else
+    {
+        ++m_tt_stats.misses;
+    }
+
+    MoveList moves;
+    int32_t scores[MaxMoves];
+    generate(rules, true, tt_move, ply, moves, scores);
+    if (moves.empty())
+        return in_check ? -ScoreMate + ply : 0;
+
+    const int alpha_orig = alpha;
+    int best_score = -ScoreInfinite;
+    Move best_move = Move::null();
+
+    for (size_t i = 0u; i < moves.size(); ++i)
+    {
+        const Move move = pickMove(moves, scores, i);
+        const bool quiet = (captured(rules, move) == PieceType::Empty) &&
+                           (move.promote() == PieceType::Empty);
+
+        rules.makeMove(move);
+        const int score = -alphaBeta(rules, -beta, -alpha, depth - 1, uint8_t(ply + 1u));
+        rules.unmakeMove();
+
+        // The score of an interrupted search is meaningless
+        if (m_stopped)
+            return 0;
+
+        if (score > best_score)
+        {
+            best_score = score;
+            best_move = move;
+            if (ply == 0u)
+                m_root_move = move;
+
+            if (score > alpha)
+            {
+                alpha = score;
+                if (score >= beta)
+                {
+                    if (quiet)
+                    {
+                        if (!(move == m_killers[ply][0]))
+                        {
+                            m_killers[ply][1] = m_killers[ply][0];
+                            m_killers[ply][0] = move;
+                        }
+
+                        int32_t& history = m_history[rules.m_side][move.from][move.to];
+                        history += depth * depth;
+                        if (history >= c_history_max)
+                        {
+                            for (auto& from: m_history[rules.m_side])
+                                for (auto& h: from)
+                                    h /= 2;
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    const Bound bound = (best_score >= beta) ? Bound::LowerBound
+                        : (best_score > alpha_orig) ? Bound::ExactBound
+                        : Bound::UpperBound;
+    if (m_tt.store(rules.hash(), uint8_t(std::min(depth, 255)), toTT(best_score, ply),
+                   bound, best_move))
+    {
+        ++m_tt_stats.collisions;
+    }
+
+    return best_score;
+}
+
+//-----------------------------------------------------------------------------
+SearchResult Search::run(Rules& rules, SearchLimits const& limits, const uint8_t start_depth)
+{
+    SearchResult result;
+
+    m_start = std::chrono::steady_clock::now();
+    m_limits = limits;
+    m_end = limits.end(m_start);
+    m_nodes = 0u;
+    m_live_nodes = 0u;
+    m_tt_stats = TTStats();
+    m_stopped = false;
+    for (auto& killers: m_killers)
+    {
+        killers[0] = killers[1] = Move::null();
+    }
+    std::memset(m_history, 0, sizeof(m_history));
+
+    // Fallback when the budget is exhausted before the end of the first
+    // iteration.
+    MoveGenerator generator(rules);
+    Move move;
+    if (!generator.next(move))
+        return result;
+    result.move = move;
+
+    const uint8_t max_depth = std::min<uint8_t>(limits.depth, MaxSearchPlies - 1u);
+    for (uint8_t depth = std::max<uint8_t>(1u, start_depth); depth <= max_depth; ++depth)
+    {
+        m_root_move = Move::null();
+        const int score = alphaBeta(rules, -ScoreInfinite, ScoreInfinite, depth, 0u);
+
+        // Moves of the root are searched in the order of the previous
+        // iteration: a better move found by an interrupted iteration is kept.
+        if (m_stopped)
+        {
+            if (!m_root_move.isNull())
+                result.move = m_root_move;
+            break;
+        }
+
+        result.move = m_root_move;
+        result.score = score;
+        result.depth = depth;
+
+        // No need to search deeper than a forced mate
+        if (std::abs(score) >= ScoreMate - MaxSearchPlies)
+            break;
+    }
+
+    m_live_nodes = m_nodes;
+    result.nodes = m_nodes;
+    result.tt = m_tt_stats;
+    result.hashfull = m_tt.hashfull();
+    result.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - m_start).count();
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+ParallelSearch::ParallelSearch(TranspositionTable& tt, unsigned threads)
+    : m_tt(tt)
+{
+    if (threads == 0u)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0u; i < threads; ++i)
+    {
+        m_searches.push_back(std::make_unique<Search>(m_tt));
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ParallelSearch::stop()
+{
+    for (auto& search: m_searches)
+    {
+        search->stop();
+    }
+}
+
+//-----------------------------------------------------------------------------
+uint64_t ParallelSearch::liveNodes() const
+{
+    uint64_t nodes = 0u;
+    for (auto const& search: m_searches)
+    {
+        nodes += search->liveNodes();
+    }
+    return nodes;
+}
+
+//-----------------------------------------------------------------------------
+SearchResult ParallelSearch::run(Rules const& rules, SearchLimits const& limits)
+{
+    m_tt.newSearch();
+    for (auto& search: m_searches)
+    {
+        search->resume();
+    }
+
+    // Helpers are only halted by the main thread
+    std::vector<std::thread> helpers;
+    for (size_t i = 1u; i < m_searches.size(); ++i)
+    {
+        helpers.emplace_back([this, &rules, i]()
+        {
+            Arena& arena = Arena::local();
+            ArenaScope scope(arena);
+            Rules& local = *arena.create<Rules>(rules);
+            m_searches[i]->run(local, SearchLimits(), uint8_t(1u + (i & 1u)));
+        });
+    }
+
+    Arena& arena = Arena::local();
+    ArenaScope scope(arena);
+    Rules& local = *arena.create<Rules>(rules);
+    SearchResult result = m_searches[0]->run(local, limits);
+
+    for (size_t i = 1u; i < m_searches.size(); ++i)
+    {
+        m_searches[i]->stop();
+    }
+    for (auto& helper: helpers)
+    {
+        helper.join();
+    }
+    for (size_t i = 1u; i < m_searches.size(); ++i)
+    {
+        result.nodes += m_searches[i]->nodes();
+        result.tt += m_searches[i]->ttStats();
+    }
+    result.hashfull = m_tt.hashfull();
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+void searchBenchmark(std::ostream& os, unsigned threads, const uint8_t depth)
+{
+    if (threads == 0u)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    SearchLimits limits;
+    limits.depth = depth;
+    TranspositionTable tt(64u);
+    double reference = 0.0;
+
+    os << "Lazy SMP time to depth " << int(depth) << ":" << std::endl;
+    for (unsigned n = 1u; ; n = std::min(2u * n, threads))
+    {
+        ParallelSearch search(tt, n);
+        double seconds = 0.0;
+        uint64_t nodes = 0u;
+        const uint64_t heap = heapAllocations();
+
+        for (auto const& position: c_perft_suite)
+        {
+            Rules rules(position.fen);
+            tt.clear();
+            const auto start = std::chrono::steady_clock::now();
+            const SearchResult result = search.run(rules, limits);
+            seconds += std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            nodes += result.nodes;
+        }
+
+        if (n == 1u)
+            reference = seconds;
+
+        os << "  " << std::setw(3) << n << " thread(s): "
+           << std::fixed << std::setprecision(3) << seconds << " s "
+           << uint64_t(double(nodes) / seconds) << " nodes/s speedup "
+           << std::setprecision(2) << (reference / seconds) << " "
+           << std::setprecision(6) << double(heapAllocations() - heap) / double(nodes)
+           << " allocs/node" << std::endl;
+
+        if (n == threads)
+            break;
+    }
+}
@@ -0,0 +1,262 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef CHESS_SEARCH_HPP
+#  define CHESS_SEARCH_HPP
+
+#  include "Chess/Rules.hpp"
+#  include "Chess/TranspositionTable.hpp"
+#  include "Utils/StopToken.hpp"
+#  include <atomic>
+#  include <chrono>
+#  include <memory>
+#  include <vector>
+
+//! \brief Max number of plies from the root of the search (quiescence search
+//! included).
+constexpr uint8_t MaxSearchPlies = 64u;
+
+//! \brief Score of a checkmate at the root. A mate in N plies scores
+//! ScoreMate - N.
+constexpr int ScoreMate = 30000;
+
+//! \brief Bound of all scores.
+constexpr int ScoreInfinite = 32000;
+
+// *****************************************************************************
+//! \brief Budget of a search. The search stops when the first limit is
+//! reached.
+// *****************************************************************************
+struct SearchLimits
+{
+    //! \brief Max depth of the iterative deepening.
+    uint8_t  depth = MaxSearchPlies - 1u;
+    //! \brief Max number of nodes (0 for no limit).
+    uint64_t nodes = 0u;
+    //! \brief Max duration in milliseconds (0 for no limit).
+    uint32_t movetime = 0u;
+    //! \brief Initial time in milliseconds of the clock of each side (0 for
+    //! no clock). Only given to external UCI engines (wtime, btime).
+    uint32_t time = 0u;
+    //! \brief Increment in milliseconds added to the clock after each move
+    //! (winc, binc).
+    uint32_t inc = 0u;
+    //! \brief Absolute time when the search shall end whatever movetime (no
+    //! deadline by default).
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    //! \brief Halting request polled by the search (none by default).
+    StopToken const* stop = nullptr;
+    //! \brief Second halting request polled by the search (ie the one of
+    //! IPlayer::abort() while stop is the one of the caller of play()).
+    StopToken const* abort = nullptr;
+
+    //! \brief Has the halting of the search been requested ?
+    inline bool stopRequested() const
+    {
+        return ((stop != nullptr) && stop->requested()) ||
+               ((abort != nullptr) && abort->requested());
+    }
+
+    //! \brief Return when the search started at the given time shall end: the
+    //! earliest of start + movetime and the deadline (time_point::max() for no
+    //! time limit).
+    std::chrono::steady_clock::time_point end(std::chrono::steady_clock::time_point const& start) const;
+
+    //! \brief Return the same limits where the deadline is converted into a
+    //! movetime counted from now (for engines only understanding durations).
+    SearchLimits relative() const;
+};
+
+//! \brief Combine the budget of a player with the budget of a move: the
+//! tightest of each limit is kept. The clock and the stop token of b are
+//! used when set, else the ones of a.
+SearchLimits tightest(SearchLimits const& a, SearchLimits const& b);
+
+// *****************************************************************************
+//! \brief Best move found by a search and statistics.
+// *****************************************************************************
+struct SearchResult
+{
+    //! \brief Best move or Move::null() when there is no legal move.
+    Move     move = Move::null();
+    //! \brief Score of the best move in centipawns for the side to move.
+    int      score = 0;
+    //! \brief Depth of the last completed iteration.
+    uint8_t  depth = 0u;
+    //! \brief Number of searched nodes.
+    uint64_t nodes = 0u;
+    //! \brief Duration of the search.
+    double   seconds = 0.0;
+    //! \brief Accesses to the transposition table.
+    TTStats  tt;
+    //! \brief Per mille of the transposition table used by the search.
+    unsigned hashfull = 0u;
+
+    //! \brief Number of nodes per second.
+    inline uint64_t nps() const
+    {
+        return (seconds > 0.0) ? uint64_t(double(nodes) / seconds) : nodes;
+    }
+};
+
+//! \brief Print the result of a search (depth, score, nodes per second ...).
+std::ostream& operator<<(std::ostream& os, SearchResult const& result);
+
+//! \brief Static evaluation of the position in centipawns for the side to
+//! move: material and piece-square tables.
+int evaluate(Rules const& rules);
+
+// *****************************************************************************
+//! \brief Iterative deepening alpha-beta search walking the tree of moves with
+//! Rules::makeMove() and Rules::unmakeMove(). Moves are ordered with the best
+//! move of the transposition table, captures by MVV-LVA (most valuable victim,
+//! least valuable attacker), killer moves and the history of quiet moves.
+//! Leaves are extended by a quiescence search of captures.
+// *****************************************************************************
+class Search
+{
+public:
+
+    //! \brief Constructor.
+    //! \param[in] tt the transposition table used by the search.
+    explicit Search(TranspositionTable& tt);
+
+    //! \brief Search the best move of the position.
+    //! \param[inout] rules the position. Restored when returning.
+    //! \param[in] limits the budget of the search.
+    //! \param[in] start_depth depth of the first iteration of the iterative
+    //! deepening (helper threads of the Lazy SMP start at different depths).
+    SearchResult run(Rules& rules, SearchLimits const& limits,
+                     const uint8_t start_depth = 1u);
+
+    //! \brief Halt the running search (can be called from another thread).
+    //! run() returns the best move of the last completed iteration. The
+    //! request persists until resume() so that a search started after the
+    //! request also halts.
+    inline void stop() { m_stop = true; }
+
+    //! \brief Cancel stop() before starting a new search.
+    inline void resume() { m_stop = false; }
+
+    //! \brief Number of nodes searched by the running or last search.
+    inline uint64_t nodes() const { return m_nodes; }
+
+    //! \brief Number of nodes of the running search readable from another
+    //! thread. Refreshed every few thousands of nodes.
+    inline uint64_t liveNodes() const { return m_live_nodes.load(std::memory_order_relaxed); }
+
+    //! \brief Accesses to the transposition table by the running or last
+    //! search.
+    inline TTStats const& ttStats() const { return m_tt_stats; }
+
+private:
+
+    //! \brief Negamax alpha-beta search.
+    //! \param[in] ply distance from the root of the search.
+    int alphaBeta(Rules& rules, int alpha, int beta, int depth, const uint8_t ply);
+
+    //! \brief Search captures (or evasions when in check) until the position
+    //! is quiet.
+    int quiescence(Rules& rules, int alpha, int beta, const uint8_t ply);
+
+    //! \brief Generate legal moves and their score for ordering them.
+    //! \param[in] quiets if false only captures and promotions.
+    void generate(Rules const& rules, const bool quiets, Move const& tt_move,
+                  const uint8_t ply, MoveList& moves, int32_t* scores) const;
+
+    //! \brief Check the budget of the search and the stop request.
+    //! \return true if the search shall stop.
+    bool stopped();
+
+private:
+
+    //! \brief Transposition table shared by all iterations.
+    TranspositionTable& m_tt;
+    //! \brief Request of halting the search.
+    std::atomic<bool> m_stop{false};
+    //! \brief Set when the search is stopped: current iteration is discarded.
+    bool m_stopped = false;
+    //! \brief Budget of the current search.
+    SearchLimits m_limits;
+    //! \brief Start of the current search.
+    std::chrono::steady_clock::time_point m_start;
+    //! \brief When the current search shall end (see SearchLimits::end()).
+    std::chrono::steady_clock::time_point m_end;
+    //! \brief Number of nodes of the current search.
+    uint64_t m_nodes = 0u;
+    //! \brief Copy of m_nodes published for other threads.
+    std::atomic<uint64_t> m_live_nodes{0u};
+    //! \brief Accesses to the transposition table by the current search.
+    TTStats m_tt_stats;
+    //! \brief Best move of the root found by the current iteration.
+    Move m_root_move = Move::null();
+    //! \brief Two quiet moves per ply having produced a beta cutoff.
+    Move m_killers[MaxSearchPlies][2];
+    //! \brief Score of quiet moves having produced beta cutoffs indexed by
+    //! [enum Color][from][to].
+    int32_t m_history[2][NbSquares][NbSquares];
+};
+
+// *****************************************************************************
+//! \brief Lazy SMP: the same position is searched by several threads sharing
+//! the transposition table. Each thread plays moves on its own copy of the
+//! position and has its own killer and history tables. Helper threads start
+//! their iterative deepening at different depths so that they fill the
+//! transposition table with results the main thread reuses. The best move is
+//! the one of the main thread; helpers are halted when it returns.
+// *****************************************************************************
+class ParallelSearch
+{
+public:
+
+    //! \brief Constructor.
+    //! \param[in] tt the transposition table shared by threads.
+    //! \param[in] threads number of threads (0 for the number of cores).
+    ParallelSearch(TranspositionTable& tt, unsigned threads = 1u);
+
+    //! \brief Age the entries of the transposition table then search the best
+    //! move of the position. The calling thread is the main thread. The node budget of limits is only counted by the main
+    //! thread. SearchResult::nodes is the sum of nodes of all threads.
+    SearchResult run(Rules const& rules, SearchLimits const& limits);
+
+    //! \brief Halt all threads of the running search (can be called from
+    //! another thread).
+    void stop();
+
+    //! \brief Number of nodes of the running search of all threads readable
+    //! from another thread (see Search::liveNodes()).
+    uint64_t liveNodes() const;
+
+    //! \brief Number of search threads.
+    inline unsigned threads() const { return unsigned(m_searches.size()); }
+
+private:
+
+    TranspositionTable& m_tt;
+    std::vector<std::unique_ptr<Search>> m_searches;
+};
+
+//! \brief Time-to-depth benchmark of the Lazy SMP: search each position of the
+//! perft suite to the given depth with 1, 2, 4 ... threads and display the
+//! time, the speedup against one thread and the heap allocations per node.
+//! \param[in] threads max number of threads (0 for the number of cores).
+void searchBenchmark(std::ostream& os, unsigned threads = 0u, const uint8_t depth = 7u);
+
+#endif
@@ -0,0 +1,208 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "Chess/TranspositionTable.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#if defined(__linux__)
+#  include <sys/mman.h>
+#endif
+
+//-----------------------------------------------------------------------------
+//! \brief Pack the fields of the entry on 48 bits.
+static inline uint64_t pack(Move const& move, const int16_t score, const uint8_t depth,
+                            const Bound bound, const uint8_t generation)
+{
+    const uint64_t m = uint64_t(move.from) | (uint64_t(move.to) << 6) |
+                       (uint64_t(move.flag) << 12);
+    return m | (uint64_t(uint16_t(score)) << 16) | (uint64_t(depth) << 32) |
+        (uint64_t(bound) << 40) | (uint64_t(generation) << 42);
+}
+
+//-----------------------------------------------------------------------------
+static inline void unpack(const uint64_t key, const uint64_t data, TTEntry& entry)
+{
+    entry.key = key;
+    entry.move = Move(uint8_t(data & 0x3Fu), uint8_t((data >> 6) & 0x3Fu),
+                      uint8_t((data >> 12) & 0xFu));
+    entry.score = int16_t(uint16_t(data >> 16));
+    entry.depth = uint8_t(data >> 32);
+    entry.bound = uint8_t((data >> 40) & 0x3u);
+    entry.generation = uint8_t((data >> 42) & 0x3Fu);
+}
+
+//-----------------------------------------------------------------------------
+TranspositionTable::TranspositionTable(const size_t mb)
+{
+    resize(mb);
+}
+
+//-----------------------------------------------------------------------------
+TranspositionTable::~TranspositionTable()
+{
+    free(m_buckets);
+}
+
+//-----------------------------------------------------------------------------
+void TranspositionTable::resize(const size_t mb)
+{
+    size_t buckets = 1u;
+    while (2u * buckets * sizeof(Bucket) <= mb * 1024u * 1024u)
+        buckets *= 2u;
+
+    // Align on a huge page so that the kernel can back the table with them:
+    // fewer TLB misses on random accesses.
+    const size_t bytes = buckets * sizeof(Bucket);
+    const size_t alignment = (bytes >= HugePageSize) ? HugePageSize : CacheLineSize;
+    void* memory = nullptr;
+
+    free(m_buckets);
+    m_buckets = nullptr;
+    if (posix_memalign(&memory, alignment, bytes) != 0)
+        throw std::string("Failed allocating the transposition table");
+
+#if defined(MADV_HUGEPAGE)
+    if (bytes >= HugePageSize)
+    {
+        madvise(memory, bytes, MADV_HUGEPAGE);
+    }
+#endif
+
+    m_buckets = static_cast<Bucket*>(memory);
+    for (size_t i = 0u; i < buckets; ++i)
+    {
+        new (&m_buckets[i]) Bucket;
+    }
+    m_mask = buckets - 1u;
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+void TranspositionTable::clear()
+{
+    for (size_t i = 0u; i <= m_mask; ++i)
+    {
+        for (auto& slot: m_buckets[i].slots)
+        {
+            slot.check.store(0u, std::memory_order_relaxed);
+            slot.data.store(0u, std::memory_order_relaxed);
+        }
+    }
+    m_generation = 0u;
+}
+
+//-----------------------------------------------------------------------------
+bool TranspositionTable::probe(const uint64_t key, TTEntry& entry) const
+{
+    for (auto const& slot: m_buckets[key & m_mask].slots)
+    {
+        const uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+        if ((check ^ data) == key)
+        {
+            unpack(key, data, entry);
+            return entry.bound != Bound::NoBound;
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+bool TranspositionTable::store(const uint64_t key, const uint8_t depth, const int16_t score,
+                               const Bound bound, Move const& move)
+{
+    Bucket& bucket = m_buckets[key & m_mask];
+    Slot* replace = nullptr;
+    Move best = move;
+    bool collision = false;
+    int worst = 0x7FFFFFFF;
+
+    for (auto& slot: bucket.slots)
+    {
+        const uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const uint64_t check = slot.check.load(std::memory_order_relaxed);
+        TTEntry entry;
+        unpack(check ^ data, data, entry);
+
+        // Same position
+        if (entry.key == key)
+        {
+            // Keep the result of a deeper search of the current search
+            if ((entry.generation == m_generation) && (depth < entry.depth) &&
+                (bound != Bound::ExactBound) && (entry.bound != Bound::NoBound))
+                return false;
+
+            // Keep the best move when the new search did not find one
+            if (move.isNull())
+                best = entry.move;
+            replace = &slot;
+            collision = false;
+            break;
+        }
+
+        // Else replace the shallowest entry, entries of older searches first
+        const unsigned age = (m_generation - entry.generation) & 0x3Fu;
+        const int value = (entry.bound == Bound::NoBound)
+                          ? -0x7FFFFFFF : int(entry.depth) - 8 * int(age);
+        if (value < worst)
+        {
+            worst = value;
+            replace = &slot;
+            collision = (entry.bound != Bound::NoBound);
+        }
+    }
+
+    const uint64_t data = pack(best, score, depth, bound, m_generation);
+    replace->check.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+    return collision;
+}
+
+//-----------------------------------------------------------------------------
+unsigned TranspositionTable::hashfull() const
+{
+    const size_t buckets = std::min<size_t>(m_mask + 1u, 1000u / BucketSize);
+    unsigned used = 0u;
+
+    for (size_t i = 0u; i < buckets; ++i)
+    {
+        for (auto const& slot: m_buckets[i].slots)
+        {
+            TTEntry entry;
+            const uint64_t data = slot.data.load(std::memory_order_relaxed);
+            unpack(0u, data, entry);
+            if ((entry.bound != Bound::NoBound) && (entry.generation == m_generation))
+                ++used;
+        }
+    }
+    return unsigned(1000u * used / (buckets * BucketSize));
+}
+
+//-----------------------------------------------------------------------------
+std::ostream& operator<<(std::ostream& os, TTStats const& stats)
+{
+    const uint64_t probes = stats.hits + stats.misses;
+    os << "hits " << stats.hits << " misses " << stats.misses
+       << " collisions " << stats.collisions << " hit rate "
+       << ((probes == 0u) ? 0u : (100u * stats.hits / probes)) << "%";
+    return os;
+}
@@ -0,0 +1,163 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef CHESS_TRANSPOSITIONTABLE_HPP
+#  define CHESS_TRANSPOSITIONTABLE_HPP
+
+#  include "Chess/Move.hpp"
+#  include <atomic>
+
+//! \brief Kind of score stored in the transposition table: the exact score or
+//! a bound of the score (fail-low gives an upper bound, fail-high a lower
+//! bound).
+enum Bound { NoBound = 0u, UpperBound = 1u, LowerBound = 2u, ExactBound = 3u };
+
+// *****************************************************************************
+//! \brief Result of the search of a position stored in the transposition
+//! table.
+// *****************************************************************************
+struct TTEntry
+{
+    //! \brief Zobrist key of the position.
+    uint64_t key;
+    //! \brief Best move found (or Move::null()).
+    Move     move;
+    //! \brief Score of the position (see bound).
+    int16_t  score;
+    //! \brief Remaining depth of the search of the position.
+    uint8_t  depth;
+    //! \brief enum Bound.
+    uint8_t  bound;
+    //! \brief Generation of the search having stored the entry.
+    uint8_t  generation;
+};
+
+// *****************************************************************************
+//! \brief Counters of accesses to the transposition table. Counted by each
+//! search thread (no shared counter to update on each probe) and summed when
+//! the search ends.
+// *****************************************************************************
+struct TTStats
+{
+    //! \brief Number of probes finding the position.
+    uint64_t hits = 0u;
+    //! \brief Number of probes not finding the position.
+    uint64_t misses = 0u;
+    //! \brief Number of stores evicting another position.
+    uint64_t collisions = 0u;
+
+    TTStats& operator+=(TTStats const& other)
+    {
+        hits += other.hits;
+        misses += other.misses;
+        collisions += other.collisions;
+        return *this;
+    }
+};
+
+// *****************************************************************************
+//! \brief Hash table storing results of already searched positions, indexed by
+//! their Zobrist key: transpositions are searched once and the best move of
+//! the previous iteration of the iterative deepening is searched first.
+//!
+//! The table is a power of two number of buckets of the size of a cache line,
+//! each holding BucketSize entries: a probe reads a single cache line. When a
+//! bucket is full, the entry of the shallowest depth is replaced, entries of
+//! older searches (see newSearch()) being replaced first.
+//!
+//! The table is shared without lock by search threads: each slot stores the
+//! key XOR'ed with its data so a slot torn by two threads writing it at the
+//! same time is detected and ignored.
+// *****************************************************************************
+class TranspositionTable
+{
+public:
+
+    //! \brief Number of entries per bucket.
+    static constexpr size_t BucketSize = 4u;
+    //! \brief Size of a cache line.
+    static constexpr size_t CacheLineSize = 64u;
+    //! \brief Size of a huge page (Linux, x86).
+    static constexpr size_t HugePageSize = 2u * 1024u * 1024u;
+
+    //! \brief Allocate the table.
+    //! \param[in] mb size of the table in mega bytes (rounded down to a power
+    //! of two number of buckets). Tables of at least HugePageSize are backed by
+    //! huge pages when the system allows it.
+    explicit TranspositionTable(const size_t mb = 16u);
+
+    //! \brief Release the table.
+    ~TranspositionTable();
+
+    TranspositionTable(TranspositionTable const&) = delete;
+    TranspositionTable& operator=(TranspositionTable const&) = delete;
+
+    //! \brief Reallocate and clear the table. Not thread safe.
+    void resize(const size_t mb);
+
+    //! \brief Forget all entries (ie new game). Not thread safe.
+    void clear();
+
+    //! \brief Age entries stored by previous searches: they are replaced
+    //! first. Shall be called before starting a search (not thread safe).
+    inline void newSearch() { m_generation = uint8_t((m_generation + 1u) & 0x3Fu); }
+
+    //! \brief Look for the position.
+    //! \return true if found and then entry is set.
+    bool probe(const uint64_t key, TTEntry& entry) const;
+
+    //! \brief Store the result of the search of the position. Results of
+    //! deeper searches of the same position by the current search are kept.
+    //! \return true if another position has been evicted (collision).
+    bool store(const uint64_t key, const uint8_t depth, const int16_t score,
+               const Bound bound, Move const& move);
+
+    //! \brief Number of entries.
+    inline size_t size() const { return (m_mask + 1u) * BucketSize; }
+
+    //! \brief Per mille of a sample of entries used by the current search.
+    unsigned hashfull() const;
+
+private:
+
+    struct Slot
+    {
+        //! \brief Zobrist key XOR data.
+        std::atomic<uint64_t> check;
+        //! \brief Move (16 bits), score (16 bits), depth (8 bits), bound (2
+        //! bits) and generation (6 bits).
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(CacheLineSize) Bucket
+    {
+        Slot slots[BucketSize];
+    };
+
+    static_assert(sizeof(Bucket) == CacheLineSize, "Bucket shall fill a cache line");
+
+    Bucket* m_buckets = nullptr;
+    size_t m_mask = 0u;
+    uint8_t m_generation = 0u;
+};
+
+std::ostream& operator<<(std::ostream& os, TTStats const& stats);
+
+#endif
@@ -0,0 +1,82 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "Chess/Zobrist.hpp"
+
+//-----------------------------------------------------------------------------
+//! \brief Pseudo random generator (SplitMix64) usable at compilation time.
+//! The seed is fixed so keys are the same for each run (reproducible hash).
+//-----------------------------------------------------------------------------
+constexpr uint64_t splitmix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15u);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+}
+
+//-----------------------------------------------------------------------------
+constexpr ZobristKeys generateKeys()
+{
+    ZobristKeys keys{};
+    uint64_t state = 0x436865737345654Eu;
+
+    for (auto& color: keys.pieces)
+        for (auto& type: color)
+            for (auto& sq: type)
+                sq = splitmix64(state);
+    for (auto& color: keys.castle)
+    {
+        // No castle right: neutral key
+        color[Castle::NoCastle] = 0u;
+        color[Castle::Little] = splitmix64(state);
+        color[Castle::Big] = splitmix64(state);
+        color[Castle::Both] = splitmix64(state);
+    }
+    for (auto& col: keys.ep)
+        col = splitmix64(state);
+    keys.black = splitmix64(state);
+
+    return keys;
+}
+
+//-----------------------------------------------------------------------------
+constexpr ZobristKeys c_zobrist = generateKeys();
+
+namespace Zobrist
+{
+
+//-----------------------------------------------------------------------------
+uint64_t hash(chessboard const& board, const Color side,
+              const uint8_t (&castle)[2], const uint8_t ep)
+{
+    uint64_t key = Zobrist::side(side) ^ Zobrist::castle(castle) ^ Zobrist::ep(ep);
+
+    for (uint8_t ij = 0u; ij < NbSquares; ++ij)
+    {
+        if (board[ij].type != PieceType::Empty)
+        {
+            key ^= piece(ij, board[ij]);
+        }
+    }
+    return key;
+}
+
+} // namespace Zobrist
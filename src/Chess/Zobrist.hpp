@@ -0,0 +1,83 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef CHESS_ZOBRIST_HPP
+#  define CHESS_ZOBRIST_HPP
+
+#  include "Chess/Move.hpp"
+#  include <cstdint>
+
+// *****************************************************************************
+//! \brief Random keys for Zobrist hashing: the key of a position is the XOR of
+//! the keys of its pieces (color, type, square), of the side to move, of the
+//! castle rights and of the column of the en-passant square. Playing a move
+//! XORs out the old features and XORs in the new ones so the key is updated
+//! in O(1). See https://www.chessprogramming.org/Zobrist_Hashing
+// *****************************************************************************
+struct ZobristKeys
+{
+    //! \brief Indexed by [enum Color][enum PieceType][square].
+    uint64_t pieces[2][8][NbSquares];
+    //! \brief Indexed by [enum Color][OR'ed enum Castle].
+    uint64_t castle[2][4];
+    //! \brief Indexed by the column of the en-passant square.
+    uint64_t ep[8];
+    //! \brief XOR'ed when Blacks have to move.
+    uint64_t black;
+};
+
+//! \brief Keys computed at compilation time.
+extern const ZobristKeys c_zobrist;
+
+namespace Zobrist
+{
+
+//! \brief Key of the piece placed on the square sq.
+inline uint64_t piece(const uint8_t sq, const Piece piece)
+{
+    return c_zobrist.pieces[piece.color][piece.type][sq];
+}
+
+//! \brief Key of the castle rights of both sides.
+inline uint64_t castle(const uint8_t (&castle)[2])
+{
+    return c_zobrist.castle[Color::White][castle[Color::White]]
+         ^ c_zobrist.castle[Color::Black][castle[Color::Black]];
+}
+
+//! \brief Key of the en-passant square (0 if none).
+inline uint64_t ep(const uint8_t ep)
+{
+    return (ep == Square::OOB) ? 0u : c_zobrist.ep[COL(ep)];
+}
+
+//! \brief Key of the side to move.
+inline uint64_t side(const Color side)
+{
+    return (side == Color::Black) ? c_zobrist.black : 0u;
+}
+
+//! \brief Compute from scratch the key of the given position.
+uint64_t hash(chessboard const& board, const Color side,
+              const uint8_t (&castle)[2], const uint8_t ep);
+
+} // namespace Zobrist
+
+#endif
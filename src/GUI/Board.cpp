@@ -20,7 +20,6 @@
 
 #include "GUI/Board.hpp"
 #include "GUI/Promotion.hpp"
-#include <unistd.h>
 #include <csignal>
 
 //static std::atomic_bool m_running_thread{true};
@@ -48,6 +47,11 @@ Board::Board(Application &application, Rules &rules, Resources &resources,
 //------------------------------------------------------------------------------
 Board::~Board()
 {
+    {
+        MuxGuard g(m_lock);
+        m_running_thread = false;
+    }
+    m_cond.notify_all();
     m_players[m_rules.m_side]->abort();
     if (m_thread.joinable())
     {
@@ -61,9 +65,6 @@ void Board::play()
     uint8_t failures = 0u;
     Status previous_status = m_rules.m_status;
 
-    // Ugly but need some time to let all threads finish their init.
-    usleep(100000);
-
     while (isRunning())
     {
         // End of game ?
@@ -75,11 +76,18 @@ void Board::play()
                 std::cout << "End of the game: " << m_rules.m_status << " !!!" << std::endl;
                 previous_status = m_rules.m_status;
             }
+
+            // Sleep until the user quits or takes back a move
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_cond.wait(lock, [this]()
+            {
+                return !m_running_thread || (Status::Playing == m_rules.m_status);
+            });
             continue ;
         }
 
         // Get the player move
-        std::string move = m_players[m_rules.m_side]->play();
+        std::string move = m_players[m_rules.m_side]->play(SearchLimits());
 
         if (move == Move::none)
         {
@@ -121,14 +129,14 @@ void Board::play()
         // already been moved.
         if (HumanPlayer != m_players[m_rules.m_side]->type()) // FIXME && using GUI
         {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_opponent_move = move;
+            m_cond.wait(lock, [this]()
             {
-                MuxGuard g(m_lock);
-                m_opponent_move = move;
-            }
-            while (!m_animating)
-                ;
-            while (m_animating)
-                ;
+                return !m_running_thread || (m_opponent_move.empty() && !m_animating);
+            });
+            if (!m_running_thread)
+                return ;
         }
 
         // After the GUI animation
@@ -358,7 +366,7 @@ void Board::animate(const std::string& move)
 
     // Smooth animation
     const sf::Vector2f p = to - from;
-    const uint32_t smooth = 50;
+    const uint32_t smooth = 20;
     for (uint32_t k = 0; k < smooth; ++k)
     {
         m_resources.figures[taken_piece].move(p.x / smooth,
@@ -407,10 +415,28 @@ void Board::update(float const /*dt*/)
             return ;
         move = m_opponent_move;
         m_opponent_move.clear();
+        m_animating = true;
     }
-    m_animating = true;
     animate(move);
-    m_animating = false;
+
+    // Wake up the game thread
+    {
+        MuxGuard g(m_lock);
+        m_animating = false;
+    }
+    m_cond.notify_all();
+}
+
+//------------------------------------------------------------------------------
+void Board::halt()
+{
+    std::cout << std::endl << "Halting ChessNeuNeu ..." << std::endl;
+    {
+        MuxGuard g(m_lock);
+        m_running_thread = false;
+    }
+    m_cond.notify_all();
+    m_players[m_rules.m_side]->abort();
 }
 
 //------------------------------------------------------------------------------
@@ -425,11 +451,9 @@ void Board::handleInput()
         switch (event.type)
         {
         case sf::Event::Closed:
-            std::cout << std::endl << "Halting ChessNeuNeu ..." << std::endl;
-            m_running_thread = false;
             while (window().pollEvent(event))
                 ;
-            m_players[m_rules.m_side]->abort();
+            halt();
             //window().close();
             break;
 
@@ -457,16 +481,19 @@ void Board::handleInput()
         case sf::Event::KeyPressed:
             if (event.key.code == sf::Keyboard::BackSpace)
             {
-                m_rules.revertLastMove();
+                {
+                    MuxGuard g(m_lock);
+                    m_rules.revertLastMove();
+                }
+                // The game may be playing again
+                m_cond.notify_all();
                 loadPosition(m_rules.m_board);
             }
             else if (event.key.code == sf::Keyboard::Escape)
             {
-                std::cout << std::endl << "Halting ChessNeuNeu ..." << std::endl;
-                m_running_thread = false;
                 while (window().pollEvent(event))
                     ;
-                m_players[m_rules.m_side]->abort();
+                halt();
                 //window().close();
             }
             break;
@@ -27,6 +27,7 @@
 #  include "Chess/Rules.hpp"
 #  include <thread>
 #  include <atomic>
+#  include <condition_variable>
 
 class Promotion;
 
@@ -117,6 +118,10 @@ private:
     //! \brief SIGINT signal handler
     static void sigintHandler(int signo);
 
+    //! \brief The user wants to quit: halt the game thread and the player
+    //! currently thinking.
+    void halt();
+
 private:
 
     //! \brief Reference on loaded resources (textures ...)
@@ -137,12 +142,19 @@ private:
 
     std::shared_ptr<IPlayer> m_players[2];
     std::unique_ptr<Promotion> m_gui_promotion[2];
+    //! \brief Move of the engine to be animated by the GUI thread.
     std::string        m_opponent_move;
     std::atomic_bool   m_running_thread{true};
-    std::atomic_bool   m_animating{false};
+    //! \brief The GUI thread is animating m_opponent_move.
+    bool               m_animating = false;
     std::thread        m_thread;
     using MuxGuard = std::lock_guard<std::mutex>;
+    //! \brief Protect m_opponent_move, m_animating and the game status
+    //! awaited by the game thread.
     mutable std::mutex m_lock;
+    //! \brief Wake up the game thread (end of animation, quitting, move taken
+    //! back) instead of spinning.
+    std::condition_variable m_cond;
 };
 
 #endif
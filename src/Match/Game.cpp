@@ -0,0 +1,164 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "Match/Game.hpp"
+#include "Players/PlayerFactory.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+//------------------------------------------------------------------------------
+double GameResult::whiteScore() const
+{
+    switch (status)
+    {
+    case Status::WhiteWon:
+        return 1.0;
+    case Status::BlackWon:
+        return 0.0;
+    default:
+        return 0.5;
+    }
+}
+
+//------------------------------------------------------------------------------
+const char* GameResult::pgn() const
+{
+    if (failed())
+        return "*";
+    if (status == Status::WhiteWon)
+        return "1-0";
+    if (status == Status::BlackWon)
+        return "0-1";
+    return "1/2-1/2";
+}
+
+//------------------------------------------------------------------------------
+Game::Game(const PlayerType white, const PlayerType black, std::string const& fen,
+           AlphaBetaOptions const& options, EnginePools const* pools)
+{
+    if ((white == PlayerType::HumanPlayer) || (black == PlayerType::HumanPlayer))
+        throw std::string("Human players need the GUI");
+
+    if (!fen.empty() && !m_rules.load(fen))
+        throw std::string("Invalid FEN: ") + fen;
+
+    m_players[Color::White] = createPlayer(white, m_rules, Color::White, fen, options, pools);
+    m_players[Color::Black] = createPlayer(black, m_rules, Color::Black, fen, options, pools);
+}
+
+//------------------------------------------------------------------------------
+GameResult Game::play(const uint16_t max_plies)
+{
+    using Clock = std::chrono::steady_clock;
+
+    GameResult result;
+    const auto start = Clock::now();
+    uint8_t failures = 0u;
+
+    while ((m_rules.m_status == Status::Playing) && (m_rules.plies() < max_plies))
+    {
+        const Color side = m_rules.m_side;
+        const auto think = Clock::now();
+        const std::string move = m_players[side]->play(SearchLimits());
+        result.thinking[side] += std::chrono::duration<double>(Clock::now() - think).count();
+
+        if (move == IPlayer::error)
+        {
+            if (++failures >= MaxFailures)
+                m_rules.m_status = Status::InternalError;
+            continue;
+        }
+
+        // No move while the game is not ended, or illegal move
+        if (!isWellFormed(move) || !m_rules.applyMove(Move(move)))
+        {
+            std::cerr << "Game: " << m_players[side]->type() << " played the invalid move '"
+                      << move << "'" << std::endl;
+            m_rules.m_status = Status::InternalError;
+            break;
+        }
+
+        failures = 0u;
+        result.moves += (result.moves.empty() ? "" : " ") + move;
+    }
+
+    result.status = m_rules.m_status;
+    result.plies = m_rules.plies();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+bool selfPlay(std::ostream& os, const size_t games, const PlayerType white,
+              const PlayerType black, std::string const& fen,
+              AlphaBetaOptions const& options)
+{
+    size_t wins = 0u, draws = 0u, losses = 0u, failures = 0u;
+    double seconds = 0.0;
+
+    // Only display the result of games
+    AlphaBetaOptions quiet(options);
+    quiet.verbose = false;
+
+    // One engine per side
+    std::map<PlayerType, size_t> engines;
+    ++engines[white];
+    ++engines[black];
+    const EnginePools pools = createEnginePools(engines);
+
+    os << "Self-play: " << games << " games " << white << " (White) vs "
+       << black << " (Black)" << std::endl;
+
+    for (size_t i = 1u; i <= games; ++i)
+    {
+        Game game(white, black, fen, quiet, &pools);
+        const GameResult result = game.play();
+
+        seconds += result.seconds;
+        if (result.failed())
+            ++failures;
+        else if (result.status == Status::WhiteWon)
+            ++wins;
+        else if (result.status == Status::BlackWon)
+            ++losses;
+        else
+            ++draws;
+
+        os << "Game " << i << ": " << result.pgn() << " (";
+        if (result.status == Status::Playing)
+            os << "Adjudicated draw";
+        else
+            os << result.status;
+        os << ") " << result.plies << " plies "
+           << std::fixed << std::setprecision(3) << result.seconds << " s (White "
+           << result.thinking[Color::White] << " s, Black "
+           << result.thinking[Color::Black] << " s)" << std::endl
+           << "  moves: " << result.moves << std::endl;
+    }
+
+    os << "Score of " << white << " vs " << black << ": +" << wins << " =" << draws
+       << " -" << losses << " failed " << failures << std::endl
+       << "Total: " << std::fixed << std::setprecision(3) << seconds << " s "
+       << std::setprecision(1) << ((seconds > 0.0) ? 3600.0 * double(games) / seconds : 0.0)
+       << " games/hour" << std::endl;
+
+    return failures == 0u;
+}
@@ -0,0 +1,102 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef MATCH_GAME_HPP
+#  define MATCH_GAME_HPP
+
+#  include "Players/AlphaBeta.hpp"
+#  include "Players/EnginePool.hpp"
+#  include <memory>
+
+// *****************************************************************************
+//! \brief Outcome of a headless game.
+// *****************************************************************************
+struct GameResult
+{
+    //! \brief Final status of the game. Status::Playing when the game has been
+    //! adjudicated a draw because it was too long.
+    Status   status = Status::Playing;
+    //! \brief Number of played plies.
+    uint16_t plies = 0u;
+    //! \brief Duration of the game.
+    double   seconds = 0.0;
+    //! \brief Thinking duration of each player indexed by enum Color.
+    double   thinking[2] = { 0.0, 0.0 };
+    //! \brief Played moves in UCI notation.
+    std::string moves;
+
+    //! \brief Internal error, illegal move ...
+    inline bool failed() const { return status == Status::InternalError; }
+
+    //! \brief Score of the Whites: 1 for a win, 0.5 for a draw, 0 for a loss.
+    double whiteScore() const;
+
+    //! \brief Result in PGN notation: "1-0", "0-1", "1/2-1/2" or "*" if
+    //! failed.
+    const char* pgn() const;
+};
+
+// *****************************************************************************
+//! \brief Headless game between two engines: moves returned by
+//! IPlayer::play() are applied with Rules::applyMove() until the end of the
+//! game. No GUI, no animation: players are called one after the other from the
+//! calling thread.
+// *****************************************************************************
+class Game
+{
+public:
+
+    //! \brief Max number of consecutive IPlayer::error before giving up.
+    static constexpr uint8_t MaxFailures = 8u;
+
+    //! \brief Create the chessboard and the two players.
+    //! \param[in] fen initial position (empty for the initial chessboard).
+    //! \param[in] pools optional pools of UCI engines leased by players.
+    //! \throw std::string if the FEN is invalid or if a player needs the GUI.
+    Game(const PlayerType white, const PlayerType black, std::string const& fen,
+         AlphaBetaOptions const& options, EnginePools const* pools = nullptr);
+
+    Game(Game const&) = delete;
+    Game& operator=(Game const&) = delete;
+
+    //! \brief Play the game until its end.
+    //! \param[in] max_plies the game is adjudicated a draw after this number
+    //! of plies.
+    GameResult play(const uint16_t max_plies = MaxPlies - 1u);
+
+    //! \brief Chessboard of the game.
+    inline Rules const& rules() const { return m_rules; }
+
+private:
+
+    //! \brief Players refer to it: shall be declared before them.
+    Rules m_rules;
+    std::shared_ptr<IPlayer> m_players[2];
+};
+
+//! \brief Play games between two engines and display the result and timings of
+//! each game then the score and the number of games per hour. UCI engines are
+//! started once and reused by all games.
+//! \return false if a game has failed.
+bool selfPlay(std::ostream& os, const size_t games, const PlayerType white,
+              const PlayerType black, std::string const& fen,
+              AlphaBetaOptions const& options);
+
+#endif
@@ -0,0 +1,292 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "Match/Tournament.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+//------------------------------------------------------------------------------
+std::vector<ScheduledGame> schedule(TournamentOptions const& options)
+{
+    std::vector<std::pair<size_t, size_t>> pairs;
+    const size_t count = options.players.size();
+
+    for (size_t i = 0u; i < count; ++i)
+    {
+        for (size_t j = i + 1u; j < count; ++j)
+        {
+            if ((options.pairing == Pairing::RoundRobin) || (i == 0u))
+            {
+                pairs.emplace_back(i, j);
+            }
+        }
+    }
+
+    // Each pair plays each opening with both colors
+    std::vector<ScheduledGame> games;
+    for (size_t round = 0u; round < options.rounds; ++round)
+    {
+        for (auto const& fen: options.openings)
+        {
+            for (auto const& pair: pairs)
+            {
+                games.push_back({ pair.first, pair.second, fen });
+                games.push_back({ pair.second, pair.first, fen });
+            }
+        }
+    }
+    return games;
+}
+
+//------------------------------------------------------------------------------
+double eloDifference(const double score)
+{
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+//------------------------------------------------------------------------------
+std::vector<std::string> loadOpenings(std::string const& path)
+{
+    std::ifstream file(path);
+    if (!file)
+        throw std::string("Failed opening the file of openings: ") + path;
+
+    std::vector<std::string> openings;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        // Trim
+        line.erase(0u, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1u);
+        if (!line.empty() && (line[0] != '#'))
+        {
+            openings.push_back(line);
+        }
+    }
+
+    if (openings.empty())
+        throw std::string("No opening in the file: ") + path;
+    return openings;
+}
+
+//------------------------------------------------------------------------------
+Tournament::Tournament(TournamentOptions const& options)
+    : m_options(options)
+{
+    if (m_options.players.size() < 2u)
+        throw std::string("A tournament needs at least two players");
+    if (m_options.openings.empty())
+        throw std::string("A tournament needs at least one opening");
+
+    // Only display the result of games
+    m_options.alphabeta.verbose = false;
+
+    // Same engine playing several times: number its instances
+    for (size_t i = 0u; i < m_options.players.size(); ++i)
+    {
+        const PlayerType type = m_options.players[i];
+        Standing standing;
+        standing.name = playerType(type);
+        const size_t same = size_t(std::count(m_options.players.begin(),
+                                              m_options.players.begin() + long(i), type));
+        if (same > 0u)
+        {
+            standing.name += "#" + std::to_string(same + 1u);
+        }
+        m_standings.push_back(standing);
+    }
+
+    m_schedule = schedule(m_options);
+}
+
+//------------------------------------------------------------------------------
+void Tournament::record(std::ostream& os, ScheduledGame const& game, GameResult const& result,
+                        const unsigned worker)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Standing& white = m_standings[game.white];
+    Standing& black = m_standings[game.black];
+    if (result.failed())
+    {
+        ++white.failures;
+        ++black.failures;
+    }
+    else if (result.status == Status::WhiteWon)
+    {
+        ++white.wins;
+        ++black.losses;
+    }
+    else if (result.status == Status::BlackWon)
+    {
+        ++white.losses;
+        ++black.wins;
+    }
+    else
+    {
+        ++white.draws;
+        ++black.draws;
+    }
+    if (!result.failed())
+    {
+        white.points += result.whiteScore();
+        black.points += 1.0 - result.whiteScore();
+    }
+    ++m_played;
+
+    const double minutes = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - m_start).count() / 60.0;
+    os << "Game " << m_played << "/" << m_schedule.size() << " [worker "
+       << worker << "]: " << white.name << " - " << black.name << " "
+       << result.pgn() << " (";
+    if (result.status == Status::Playing)
+        os << "Adjudicated draw";
+    else
+        os << result.status;
+    os << ") " << result.plies << " plies " << std::fixed << std::setprecision(3)
+       << result.seconds << " s | " << std::setprecision(1)
+       << double(m_played) / minutes << " games/min" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void Tournament::work(std::ostream& os, const unsigned worker)
+{
+    size_t i;
+    while ((i = m_next.fetch_add(1u)) < m_schedule.size())
+    {
+        ScheduledGame const& scheduled = m_schedule[i];
+        GameResult result;
+
+        try
+        {
+            Game game(m_options.players[scheduled.white], m_options.players[scheduled.black],
+                      scheduled.fen, m_options.alphabeta, &m_pools);
+            result = game.play();
+        }
+        catch (std::string const& msg)
+        {
+            std::cerr << "Tournament: " << msg << std::endl;
+            result.status = Status::InternalError;
+        }
+
+        record(os, scheduled, result, worker);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Tournament::run(std::ostream& os)
+{
+    unsigned workers = m_options.workers;
+    if (workers == 0u)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    workers = unsigned(std::min<size_t>(workers, m_schedule.size()));
+
+    os << "Tournament: " << ((m_options.pairing == Pairing::RoundRobin) ? "round-robin" : "gauntlet")
+       << " " << m_schedule.size() << " games " << m_options.openings.size()
+       << " opening(s) " << workers << " worker(s)" << std::endl;
+
+    // Start UCI engines once: as many as games played concurrently need
+    std::map<PlayerType, size_t> engines;
+    for (ScheduledGame const& game: m_schedule)
+    {
+        const PlayerType white = m_options.players[game.white];
+        const PlayerType black = m_options.players[game.black];
+        const size_t count = (white == black) ? 2u : 1u;
+        engines[white] = std::max(engines[white], count * workers);
+        engines[black] = std::max(engines[black], count * workers);
+    }
+    try
+    {
+        m_pools = createEnginePools(engines);
+    }
+    catch (std::string const& msg)
+    {
+        // Games will start their own engines (and report their failures)
+        std::cerr << "Tournament: " << msg << std::endl;
+        m_pools.clear();
+    }
+
+    m_next = 0u;
+    m_played = 0u;
+    m_start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 1u; w < workers; ++w)
+    {
+        threads.emplace_back(&Tournament::work, this, std::ref(os), w);
+    }
+    work(os, 0u);
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+
+    const double minutes = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - m_start).count() / 60.0;
+
+    // Standings
+    bool success = true;
+    os << std::endl << "Rank Name             Points  Games   +   =   -  Failed     Elo" << std::endl;
+    const std::vector<Standing> ranking = standings();
+    for (size_t r = 0u; r < ranking.size(); ++r)
+    {
+        Standing const& s = ranking[r];
+        success &= (s.failures == 0u);
+
+        os << std::setw(4) << (r + 1u) << " " << std::left << std::setw(16) << s.name
+           << std::right << std::fixed << std::setprecision(1) << std::setw(7) << s.points
+           << std::setw(7) << s.games() << std::setw(4) << s.wins << std::setw(4) << s.draws
+           << std::setw(4) << s.losses << std::setw(8) << s.failures;
+        if (s.games() == 0u)
+        {
+            os << "       -";
+        }
+        else
+        {
+            // Clamp the score of players winning or losing all their games
+            const double games = double(s.games());
+            const double score = std::min(std::max(s.points / games, 0.5 / games),
+                                          1.0 - 0.5 / games);
+            os << std::showpos << std::setw(8) << std::setprecision(0)
+               << eloDifference(score) << std::noshowpos;
+        }
+        os << std::endl;
+    }
+    os << "Total: " << m_played << " games in " << std::fixed << std::setprecision(2)
+       << minutes << " min " << std::setprecision(1)
+       << ((minutes > 0.0) ? double(m_played) / minutes : 0.0) << " games/min" << std::endl;
+
+    return success;
+}
+
+//------------------------------------------------------------------------------
+std::vector<Standing> Tournament::standings() const
+{
+    std::vector<Standing> ranking(m_standings);
+    std::stable_sort(ranking.begin(), ranking.end(), [](Standing const& a, Standing const& b)
+    {
+        return a.points > b.points;
+    });
+    return ranking;
+}
@@ -0,0 +1,141 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef MATCH_TOURNAMENT_HPP
+#  define MATCH_TOURNAMENT_HPP
+
+#  include "Match/Game.hpp"
+#  include <atomic>
+#  include <chrono>
+#  include <mutex>
+#  include <vector>
+
+//! \brief How players are paired: everyone against everyone, or the first
+//! player against all others.
+enum class Pairing { RoundRobin, Gauntlet };
+
+// *****************************************************************************
+//! \brief Settings of a tournament.
+// *****************************************************************************
+struct TournamentOptions
+{
+    //! \brief Participants. For gauntlets, the first one plays against the
+    //! others.
+    std::vector<PlayerType> players;
+    //! \brief How players are paired.
+    Pairing pairing = Pairing::RoundRobin;
+    //! \brief Number of times each pair of players plays each opening. Each
+    //! round is a pair of games with swapped colors.
+    size_t rounds = 1u;
+    //! \brief Starting positions in Forsyth-Edwards notation (an empty string
+    //! for the initial chessboard).
+    std::vector<std::string> openings = { "" };
+    //! \brief Number of games played concurrently (0 for the number of cores).
+    unsigned workers = 0u;
+    //! \brief Settings of alphabeta players.
+    AlphaBetaOptions alphabeta;
+};
+
+// *****************************************************************************
+//! \brief A game of the tournament schedule.
+// *****************************************************************************
+struct ScheduledGame
+{
+    //! \brief Index of the players in TournamentOptions::players.
+    size_t white;
+    size_t black;
+    //! \brief Starting position.
+    std::string fen;
+};
+
+// *****************************************************************************
+//! \brief Score of a participant.
+// *****************************************************************************
+struct Standing
+{
+    std::string name;
+    double points = 0.0;
+    size_t wins = 0u;
+    size_t draws = 0u;
+    size_t losses = 0u;
+    size_t failures = 0u;
+
+    inline size_t games() const { return wins + draws + losses; }
+};
+
+//! \brief Games of the tournament: for each pair of players, each opening and
+//! each round, two games with swapped colors.
+std::vector<ScheduledGame> schedule(TournamentOptions const& options);
+
+//! \brief Elo difference giving the expected score (in ]0, 1[).
+double eloDifference(const double score);
+
+//! \brief Read a list of FEN (one by line, empty lines and lines starting with
+//! '#' are ignored).
+//! \throw std::string if the file cannot be read.
+std::vector<std::string> loadOpenings(std::string const& path);
+
+// *****************************************************************************
+//! \brief Run the games of a tournament concurrently on a pool of workers.
+//! Each worker plays one game at a time and owns its chessboard and players
+//! (and therefore the child processes of external engines). The result of each
+//! game is displayed when it ends with the current throughput, then the
+//! standings with the Elo difference of each player against its opponents.
+// *****************************************************************************
+class Tournament
+{
+public:
+
+    //! \throw std::string if there are less than two players or no opening.
+    explicit Tournament(TournamentOptions const& options);
+
+    //! \brief Play all games.
+    //! \return false if a game has failed.
+    bool run(std::ostream& os);
+
+    //! \brief Scores after run() sorted by decreasing points.
+    std::vector<Standing> standings() const;
+
+private:
+
+    //! \brief Play games until the schedule is exhausted.
+    void work(std::ostream& os, const unsigned worker);
+
+    //! \brief Record the result of a game and display it.
+    void record(std::ostream& os, ScheduledGame const& game, GameResult const& result,
+                const unsigned worker);
+
+private:
+
+    TournamentOptions m_options;
+    std::vector<ScheduledGame> m_schedule;
+    std::vector<Standing> m_standings;
+    //! \brief Index of the next game to play.
+    std::atomic<size_t> m_next{0u};
+    //! \brief Number of finished games.
+    size_t m_played = 0u;
+    //! \brief Protect m_standings, m_played and the output stream.
+    std::mutex m_mutex;
+    std::chrono::steady_clock::time_point m_start;
+    //! \brief UCI engines started once and shared by games.
+    EnginePools m_pools;
+};
+
+#endif
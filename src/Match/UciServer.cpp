@@ -0,0 +1,415 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "Match/UciServer.hpp"
+#include "Players/PlayerFactory.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+
+//! \brief Forsyth-Edwards notation of "position startpos".
+static const char* c_startpos = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+//! \brief Moves left until the next time control when the GUI does not give
+//! "movestogo".
+static constexpr uint64_t c_moves_to_go = 30u;
+
+//! \brief Time kept on the clock for the communication with the GUI (ms).
+static constexpr uint64_t c_time_margin = 50u;
+
+//! \brief Delay given to players for answering the halting request before
+//! aborting them (ms).
+static constexpr std::chrono::milliseconds c_abort_delay{200};
+
+constexpr std::chrono::milliseconds UciServer::InfoPeriod;
+
+//------------------------------------------------------------------------------
+//! \brief Durations sent by GUIs are negative once the side is over time.
+static uint32_t milliseconds(const int64_t ms)
+{
+    return uint32_t(std::min<int64_t>(std::max<int64_t>(0, ms), UINT32_MAX));
+}
+
+//------------------------------------------------------------------------------
+UciGo parseGo(std::string const& arguments, const Color side)
+{
+    UciGo budget;
+    bool clock[2] = { false, false };
+    uint64_t time[2] = { 0u, 0u };
+    uint64_t inc[2] = { 0u, 0u };
+    uint64_t movestogo = 0u;
+    int64_t value;
+
+    std::istringstream iss(arguments);
+    std::string token;
+    while (iss >> token)
+    {
+        // "ponder" is not special: the Ponder option is not advertised, so
+        // "ponderhit" is ignored and the move is given within the budget.
+        if (token == "infinite")
+            budget.infinite = true;
+        else if ((token == "wtime") && (iss >> value))
+        {
+            time[Color::White] = milliseconds(value);
+            clock[Color::White] = true;
+        }
+        else if ((token == "btime") && (iss >> value))
+        {
+            time[Color::Black] = milliseconds(value);
+            clock[Color::Black] = true;
+        }
+        else if ((token == "winc") && (iss >> value))
+            inc[Color::White] = milliseconds(value);
+        else if ((token == "binc") && (iss >> value))
+            inc[Color::Black] = milliseconds(value);
+        else if ((token == "movestogo") && (iss >> value))
+            movestogo = uint64_t(std::max<int64_t>(0, value));
+        else if ((token == "movetime") && (iss >> value))
+            budget.limits.movetime = std::max<uint32_t>(1u, milliseconds(value));
+        else if ((token == "nodes") && (iss >> value))
+            budget.limits.nodes = uint64_t(std::max<int64_t>(0, value));
+        else if ((token == "depth") && (iss >> value))
+            budget.limits.depth = uint8_t(std::min<int64_t>(std::max<int64_t>(1, value),
+                                                            MaxSearchPlies - 1u));
+    }
+
+    // Share the clock of the side to move between the remaining moves. Over
+    // time: move as fast as possible.
+    if ((budget.limits.movetime == 0u) && clock[side])
+    {
+        uint64_t ms = time[side] / (movestogo ? movestogo : c_moves_to_go) + inc[side] / 2u;
+        const uint64_t available = (time[side] > 2u * c_time_margin)
+                                   ? time[side] - c_time_margin : time[side] / 2u;
+        budget.limits.movetime = uint32_t(std::max<uint64_t>(1u, std::min(ms, available)));
+    }
+
+    if (budget.infinite)
+        budget.limits.movetime = 0u;
+    return budget;
+}
+
+//------------------------------------------------------------------------------
+UciServer::UciServer(const PlayerType type, AlphaBetaOptions const& options,
+                     std::istream& in, std::ostream& out)
+    : m_type(type), m_options(options), m_in(in), m_out(out)
+{
+    if (type == PlayerType::HumanPlayer)
+        throw std::string("The human player needs the GUI");
+
+    // Only "info" lines are displayed
+    m_options.verbose = false;
+}
+
+//------------------------------------------------------------------------------
+UciServer::~UciServer()
+{
+    stop();
+}
+
+//------------------------------------------------------------------------------
+void UciServer::send(std::string const& line)
+{
+    std::lock_guard<std::mutex> lock(m_out_mutex);
+    m_out << line << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void UciServer::run()
+{
+    std::string line;
+    while (std::getline(m_in, line))
+    {
+        if (!execute(line))
+            return;
+    }
+
+    // End of the input: as "quit"
+    stop();
+}
+
+//------------------------------------------------------------------------------
+bool UciServer::execute(std::string const& line)
+{
+    std::istringstream iss(line);
+    std::string command;
+    std::string arguments;
+
+    iss >> command;
+    std::getline(iss >> std::ws, arguments);
+    if (!arguments.empty() && (arguments.back() == '\r'))
+        arguments.pop_back();
+
+    if (command == "uci")
+    {
+        send(std::string("id name ChessNeuNeu ") + playerType(m_type));
+        send("id author Quentin Quadrat");
+        send("uciok");
+    }
+    else if (command == "isready")
+    {
+        send("readyok");
+    }
+    else if (command == "ucinewgame")
+    {
+        stop();
+        m_players[Color::White].reset();
+        m_players[Color::Black].reset();
+    }
+    else if (command == "position")
+    {
+        stop();
+        position(arguments);
+    }
+    else if (command == "go")
+    {
+        stop();
+        go(arguments);
+    }
+    else if (command == "stop")
+    {
+        stop();
+    }
+    else if (command == "quit")
+    {
+        stop();
+        return false;
+    }
+
+    // Other commands (setoption, ponderhit, debug ...) are ignored
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void UciServer::position(std::string const& arguments)
+{
+    std::istringstream iss(arguments);
+    std::string token;
+    std::string fen;
+
+    iss >> token;
+    if (token == "fen")
+    {
+        while ((iss >> token) && (token != "moves"))
+            fen += (fen.empty() ? "" : " ") + token;
+    }
+    else if (token == "startpos")
+    {
+        iss >> token;
+    }
+    else
+    {
+        send("info string Invalid position command: " + arguments);
+        return;
+    }
+
+    std::string moves;
+    if (token == "moves")
+        std::getline(iss, moves);
+
+    // Reject the whole position on moves that are not in UCI notation
+    std::istringstream tokens(moves);
+    while (tokens >> token)
+    {
+        if (!isWellFormed(token))
+        {
+            send("info string Invalid move: " + token);
+            return;
+        }
+    }
+
+    // Players of external engines know the initial position
+    if (fen != m_fen)
+    {
+        m_players[Color::White].reset();
+        m_players[Color::Black].reset();
+        m_fen = fen;
+    }
+
+    if (!m_rules.load(fen.empty() ? c_startpos : fen))
+    {
+        send("info string Invalid FEN: " + fen);
+        m_rules.load(c_startpos);
+    }
+    else if (!m_rules.applyMoves(moves, true))
+    {
+        if (m_rules.plies() >= MaxPlies)
+            send("info string Too many moves: the game is limited to " +
+                 std::to_string(MaxPlies) + " plies");
+        else
+            send("info string Illegal move in: " + moves);
+    }
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<IPlayer> UciServer::player()
+{
+    const Color side = m_rules.m_side;
+    if (m_players[side] == nullptr)
+        m_players[side] = createPlayer(m_type, m_rules, side, m_fen, m_options);
+    return m_players[side];
+}
+
+//------------------------------------------------------------------------------
+void UciServer::go(std::string const& arguments)
+{
+    // The time budget is counted from the reception of "go"
+    UciGo budget = parseGo(arguments, m_rules.m_side);
+    budget.limits.deadline = budget.limits.end(std::chrono::steady_clock::now());
+    budget.limits.stop = &m_halt;
+
+    // Created here so a player failing to start is reported now
+    std::shared_ptr<IPlayer> searcher;
+    try
+    {
+        searcher = player();
+    }
+    catch (std::string const& msg)
+    {
+        send("info string " + msg);
+        send("bestmove 0000");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_searching = true;
+        m_stop = false;
+    }
+    m_halt.reset();
+    searcher->resume();
+    m_search = std::thread(&UciServer::search, this, budget, searcher);
+}
+
+//------------------------------------------------------------------------------
+void UciServer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_search.joinable())
+            return;
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    m_search.join();
+}
+
+//------------------------------------------------------------------------------
+void UciServer::search(UciGo const budget, std::shared_ptr<IPlayer> player)
+{
+    using Clock = std::chrono::steady_clock;
+
+    IPlayer& p = *player;
+    const auto start = Clock::now();
+    std::thread monitoring(&UciServer::monitor, this, std::cref(budget), std::ref(p));
+
+    std::string move = p.play(budget.limits);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_searching = false;
+    }
+    m_cond.notify_all();
+    monitoring.join();
+
+    // "go infinite": the best move is only given after "stop"
+    if (budget.infinite)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this]() { return m_stop; });
+    }
+
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - start).count();
+    const uint64_t nodes = p.nodes();
+    send("info time " + std::to_string(ms) + " nodes " + std::to_string(nodes) +
+         " nps " + std::to_string((ms > 0) ? nodes * 1000u / uint64_t(ms) : 0u));
+
+    // No legal move, error or aborted before finding a move: UCI null move
+    if ((move == Move::none) || (move == IPlayer::error) || (move == IPlayer::quitting))
+        move = "0000";
+    send("bestmove " + move);
+}
+
+//------------------------------------------------------------------------------
+void UciServer::monitor(UciGo const& budget, IPlayer& player)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const auto start = Clock::now();
+    const auto deadline = budget.limits.deadline;
+    auto next_info = start + InfoPeriod;
+    auto abort_at = Clock::time_point::max();
+    bool halted = false;
+    bool aborted = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_searching)
+    {
+        // Players honor the budget given to play(). On "stop" or an exhausted
+        // budget, the halting request asks for the best move so far; players
+        // ignoring it (ie TSCP and the node budget) are aborted a bit later
+        // and no move is given. Requests persist, so they are sent once.
+        const uint64_t nodes = player.nodes();
+        const bool exhausted = (Clock::now() >= deadline) ||
+                               ((budget.limits.nodes != 0u) && (nodes >= budget.limits.nodes));
+        if (!halted && (m_stop || exhausted))
+        {
+            m_halt.request();
+            halted = true;
+            abort_at = Clock::now() + c_abort_delay;
+            continue;
+        }
+        if (!aborted && (Clock::now() >= abort_at))
+        {
+            lock.unlock();
+            player.abort();
+            lock.lock();
+            aborted = true;
+            continue;
+        }
+
+        if (Clock::now() >= next_info)
+        {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                Clock::now() - start).count();
+            lock.unlock();
+            send("info time " + std::to_string(ms) + " nodes " + std::to_string(nodes) +
+                 " nps " + std::to_string((ms > 0) ? nodes * 1000u / uint64_t(ms) : 0u));
+            lock.lock();
+            next_info += InfoPeriod;
+            continue;
+        }
+
+        // Wake up for the next "info" line, the deadline, "stop" or the end of
+        // the search. Node budgets are checked every 10 ms.
+        auto wake = next_info;
+        if (!halted)
+        {
+            wake = std::min(wake, deadline);
+            if (budget.limits.nodes != 0u)
+                wake = std::min(wake, Clock::now() + std::chrono::milliseconds(10));
+        }
+        else if (!aborted)
+        {
+            wake = std::min(wake, abort_at);
+        }
+        m_cond.wait_until(lock, wake, [this, halted]() { return !m_searching || (m_stop && !halted); });
+    }
+}
@@ -0,0 +1,138 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef MATCH_UCI_SERVER_HPP
+#  define MATCH_UCI_SERVER_HPP
+
+#  include "Players/AlphaBeta.hpp"
+#  include <chrono>
+#  include <condition_variable>
+#  include <memory>
+#  include <mutex>
+#  include <thread>
+
+// *****************************************************************************
+//! \brief Budget of a "go" command.
+// *****************************************************************************
+struct UciGo
+{
+    //! \brief Depth and node budget. SearchLimits::movetime is the time
+    //! budget computed from "movetime" or from the clock of the side to move.
+    //! This budget is given to IPlayer::play().
+    SearchLimits limits;
+    //! \brief "go infinite": search until "stop".
+    bool infinite = false;
+};
+
+//! \brief Parse the arguments of the "go" command (ie "wtime 1000 btime 1000").
+//! \param[in] side the side to move (whose clock is used).
+UciGo parseGo(std::string const& arguments, const Color side);
+
+// *****************************************************************************
+//! \brief Make ChessNeuNeu usable as an engine by chess GUIs and tournament
+//! managers: talk the Universal Chess Interface on the given streams (stdin
+//! and stdout). The "position" command is applied with Rules::applyMoves()
+//! and "go" calls IPlayer::play() of the player of the side to move with the
+//! budget of the command from a search thread, while "info nodes nps time"
+//! lines are displayed every second. "stop" requests the stop token given to
+//! IPlayer::play() (so does an exhausted budget ignored by the player), then
+//! calls IPlayer::abort() if the player does not answer. Commands are read from
+//! the thread calling run() so "stop" and "isready" are handled while
+//! searching.
+// *****************************************************************************
+class UciServer
+{
+public:
+
+    //! \brief Interval between two "info" lines.
+    static constexpr std::chrono::milliseconds InfoPeriod{1000};
+
+    //! \param[in] type the player answering "go" (not the human player).
+    //! \param[in] options settings of the alphabeta player.
+    //! \throw std::string for the human player.
+    UciServer(const PlayerType type, AlphaBetaOptions const& options,
+              std::istream& in, std::ostream& out);
+
+    UciServer(UciServer const&) = delete;
+    UciServer& operator=(UciServer const&) = delete;
+
+    //! \brief Halt the running search.
+    ~UciServer();
+
+    //! \brief Read and execute commands until "quit" or the end of the input.
+    void run();
+
+    //! \brief Execute a command.
+    //! \return false for the "quit" command.
+    bool execute(std::string const& line);
+
+private:
+
+    //! \brief "position [startpos | fen FEN] [moves MOVES]". The command is
+    //! ignored if one of the moves is not in UCI notation.
+    void position(std::string const& arguments);
+
+    //! \brief "go ...": start the search thread.
+    void go(std::string const& arguments);
+
+    //! \brief Halt the running search and wait for its "bestmove".
+    void stop();
+
+    //! \brief Body of the search thread.
+    void search(UciGo const budget, std::shared_ptr<IPlayer> player);
+
+    //! \brief Display "info" lines until the search ends, request m_halt on
+    //! "stop" or when the budget is exhausted, and call IPlayer::abort() when
+    //! the player ignores it.
+    void monitor(UciGo const& budget, IPlayer& player);
+
+    //! \brief Write a line on the output (thread safe).
+    void send(std::string const& line);
+
+    //! \brief Return the player of the side to move (created if needed).
+    std::shared_ptr<IPlayer> player();
+
+    PlayerType m_type;
+    AlphaBetaOptions m_options;
+    std::istream& m_in;
+    std::ostream& m_out;
+    //! \brief Position of the last "position" command. Players refer to it.
+    Rules m_rules;
+    //! \brief Initial position of the game (empty for the initial chessboard).
+    std::string m_fen;
+    //! \brief Players created when they have the move.
+    std::shared_ptr<IPlayer> m_players[2];
+    //! \brief Thread running IPlayer::play().
+    std::thread m_search;
+    //! \brief Protect the states shared with the search thread.
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    //! \brief IPlayer::play() is running.
+    bool m_searching = false;
+    //! \brief "stop" received.
+    bool m_stop = false;
+    //! \brief Request of the best move so far given to IPlayer::play() on
+    //! "stop" or when the budget is exhausted.
+    StopToken m_halt;
+    //! \brief Serialize lines written by the reader and search threads.
+    std::mutex m_out_mutex;
+};
+
+#endif
@@ -0,0 +1,58 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "AlphaBeta.hpp"
+#include <iostream>
+
+//------------------------------------------------------------------------------
+AlphaBeta::AlphaBeta(const Rules &rules, const Color side, AlphaBetaOptions const& options)
+    : IPlayer(PlayerType::AlphaBetaIA, side), m_rules(rules), m_limits(options.limits),
+      m_verbose(options.verbose),
+      m_tt(options.hash_mb), m_search(m_tt, options.threads)
+{}
+
+//------------------------------------------------------------------------------
+uint64_t AlphaBeta::nodes() const
+{
+    return m_search.liveNodes();
+}
+
+//------------------------------------------------------------------------------
+std::string AlphaBeta::play(SearchLimits const& limits)
+{
+    // The main search thread polls the stop token of abort(): an abort()
+    // arriving before the search has started is not lost. The stop token of
+    // the caller only halts the search like an exhausted budget.
+    SearchLimits budget = tightest(m_limits, limits);
+    budget.abort = &m_stop;
+
+    // Each search thread plays moves on its own copy of the position
+    m_result = m_search.run(m_rules, budget);
+    if (aborted())
+        return IPlayer::quitting;
+    if (m_result.move.isNull())
+        return Move::none;
+
+    if (m_verbose)
+    {
+        std::cout << "AlphaBeta: " << m_result << std::endl;
+    }
+    return toStrMove(m_result.move);
+}
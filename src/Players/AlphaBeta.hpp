@@ -0,0 +1,71 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef ALPHABETA_HPP
+#  define ALPHABETA_HPP
+
+#  include "Player.hpp"
+#  include "Chess/Search.hpp"
+
+// *****************************************************************************
+//! \brief Settings of the native chess player.
+// *****************************************************************************
+struct AlphaBetaOptions
+{
+    //! \brief Budget of the search of each move.
+    SearchLimits limits;
+    //! \brief Number of search threads (0 for the number of cores).
+    unsigned threads = 1u;
+    //! \brief Size of the transposition table in mega bytes.
+    size_t hash_mb = 16u;
+    //! \brief Display the search statistics after each move.
+    bool verbose = true;
+};
+
+// *****************************************************************************
+//! \brief Native chess player: iterative deepening alpha-beta search with a
+//! transposition table (no external process). The search can be shared by
+//! several threads (Lazy SMP). The search statistics (depth, score, nodes per
+//! second) are displayed after each move.
+// *****************************************************************************
+class AlphaBeta: public IPlayer
+{
+public:
+
+    AlphaBeta(const Rules &rules, const Color side, AlphaBetaOptions const& options);
+    virtual std::string play(SearchLimits const& limits) override;
+    virtual uint64_t nodes() const override;
+
+    //! \brief Result of the search of the last played move.
+    inline SearchResult const& lastResult() const { return m_result; }
+
+private:
+
+    //! \brief We need to access to the chess rules for getting the current
+    //! position.
+    const Rules &m_rules;
+    SearchLimits m_limits;
+    bool m_verbose;
+    TranspositionTable m_tt;
+    ParallelSearch m_search;
+    SearchResult m_result;
+};
+
+#endif
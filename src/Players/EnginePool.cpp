@@ -0,0 +1,139 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "EnginePool.hpp"
+#include <iostream>
+#include <thread>
+
+//------------------------------------------------------------------------------
+EnginePool::EnginePool(UciEngineConfig const& config, const size_t size)
+    : m_config(config), m_size(std::max<size_t>(1u, size))
+{
+    // Engines are started concurrently: each one may allocate its hash table
+    std::vector<std::thread> threads;
+    for (size_t i = 0u; i < m_size; ++i)
+    {
+        threads.emplace_back([this]()
+        {
+            try
+            {
+                std::unique_ptr<UciSession> session = spawn();
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_idle.push_back(std::move(session));
+            }
+            catch (std::string const& msg)
+            {
+                std::cerr << "EnginePool: " << msg << std::endl;
+            }
+        });
+    }
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+
+    if (m_idle.empty())
+        throw std::string("EnginePool: cannot start '") + m_config.path + "'";
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<UciSession> EnginePool::spawn() const
+{
+    return std::make_unique<UciSession>(m_config, "", SearchLimits());
+}
+
+//------------------------------------------------------------------------------
+size_t EnginePool::idle() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_idle.size();
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<UciSession> EnginePool::acquire(std::string const& fen, SearchLimits const& limits)
+{
+    std::unique_ptr<UciSession> session;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this]() { return !m_idle.empty() || (m_leased < m_size); });
+        ++m_leased;
+        if (!m_idle.empty())
+        {
+            session = std::move(m_idle.back());
+            m_idle.pop_back();
+        }
+    }
+
+    try
+    {
+        // Reset the engine for the new game. Replace missing or crashed engines.
+        if (session != nullptr)
+        {
+            session->setLimits(limits);
+            if (session->running() && session->newGame(fen))
+                return session;
+            session.reset();
+        }
+
+        session = spawn();
+        session->setLimits(limits);
+        if (!session->newGame(fen))
+            throw std::string("EnginePool: '") + m_config.path + "' is not ready";
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_restarts;
+        return session;
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_leased;
+        m_cond.notify_one();
+        throw;
+    }
+}
+
+//------------------------------------------------------------------------------
+void EnginePool::release(std::unique_ptr<UciSession> session, const bool failed)
+{
+    // Stop the failed engine outside the lock (waiting for its process)
+    if (failed || (session != nullptr && !session->running()))
+        session.reset();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    --m_leased;
+    if (session != nullptr)
+        m_idle.push_back(std::move(session));
+    m_cond.notify_one();
+}
+
+//------------------------------------------------------------------------------
+EnginePools createEnginePools(std::map<PlayerType, size_t> const& sizes)
+{
+    EnginePools pools;
+    for (auto const& it: sizes)
+    {
+        if (isUciEngine(it.first) && (it.second > 0u))
+        {
+            pools[it.first] = std::make_shared<EnginePool>(uciEngineConfig(it.first), it.second);
+        }
+    }
+    return pools;
+}
@@ -0,0 +1,92 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef ENGINE_POOL_HPP
+#  define ENGINE_POOL_HPP
+
+#  include "UciEngine.hpp"
+#  include <condition_variable>
+#  include <map>
+#  include <mutex>
+
+// *****************************************************************************
+//! \brief Set of started and initialized UCI engines of the same program
+//! shared by games: engines are leased to players (UciEngine) and reset with
+//! "ucinewgame" instead of paying the process start, the "uci" handshake and
+//! the allocation of hash tables for each game. Crashed engines are replaced.
+//! Thread safe: games can be played concurrently.
+// *****************************************************************************
+class EnginePool
+{
+public:
+
+    //! \brief Start and initialize the engines concurrently.
+    //! \param[in] config path of the engine program and its options.
+    //! \param[in] size max number of engines leased at the same time.
+    //! \throw std::string if no engine can be started.
+    EnginePool(UciEngineConfig const& config, const size_t size);
+
+    EnginePool(EnginePool const&) = delete;
+    EnginePool& operator=(EnginePool const&) = delete;
+
+    //! \brief Lease an engine ready for a new game. Wait if all engines are
+    //! leased. Restart the engine if it does not answer anymore.
+    //! \throw std::string if the engine cannot be restarted.
+    std::unique_ptr<UciSession> acquire(std::string const& fen, SearchLimits const& limits);
+
+    //! \brief Give back a leased engine.
+    //! \param[in] failed if set the engine is stopped (replaced on the next
+    //! acquire()).
+    void release(std::unique_ptr<UciSession> session, const bool failed = false);
+
+    //! \brief Max number of engines leased at the same time.
+    inline size_t size() const { return m_size; }
+
+    //! \brief Number of engines started and not leased.
+    size_t idle() const;
+
+    //! \brief Number of engines started for replacing crashed ones.
+    inline size_t restarts() const { return m_restarts; }
+
+private:
+
+    //! \brief Start and initialize an engine.
+    std::unique_ptr<UciSession> spawn() const;
+
+    UciEngineConfig m_config;
+    size_t m_size;
+    //! \brief Engines ready to be leased.
+    std::vector<std::unique_ptr<UciSession>> m_idle;
+    //! \brief Number of leased engines.
+    size_t m_leased = 0u;
+    size_t m_restarts = 0u;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+//! \brief Engine pools indexed by player type.
+using EnginePools = std::map<PlayerType, std::shared_ptr<EnginePool>>;
+
+//! \brief Create a pool for each UCI engine of the map (other players are
+//! ignored).
+//! \param[in] sizes the number of engines of each player type.
+EnginePools createEnginePools(std::map<PlayerType, size_t> const& sizes);
+
+#endif
@@ -26,9 +26,14 @@ Human::Human(const Rules &rules, const Color side)
 {}
 
 //------------------------------------------------------------------------------
-void Human::abort()
+void Human::wake()
 {
-    notified(IPlayer::quitting);
+    // Locked so the wake up cannot happen between the check of the stop
+    // token and the wait
+    {
+        std::unique_lock<std::mutex> mlock(m_mutex);
+    }
+    m_cond.notify_one();
 }
 
 //------------------------------------------------------------------------------
@@ -43,11 +48,13 @@ void Human::notified(std::string const& move)
 
 //------------------------------------------------------------------------------
 // Tricky hack to get the move from the GUI.
-std::string Human::play()
+std::string Human::play(SearchLimits const& /*limits*/)
 {
     std::unique_lock<std::mutex> mlock(m_mutex);
 
-    m_cond.wait(mlock);
-    std::string move(m_move);
+    // The move may have been notified before waiting
+    m_cond.wait(mlock, [this]() { return !m_move.empty() || aborted(); });
+    std::string move(aborted() ? IPlayer::quitting : m_move);
+    m_move.clear();
     return move;
 }
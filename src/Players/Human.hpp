@@ -36,13 +36,19 @@ class Human: public IPlayer
 public:
 
     Human(const Rules &rules, const Color side);
-    virtual std::string play() override;
-    virtual void abort() override;
+    //! \brief Wait for the move made with the mouse. Limits are ignored:
+    //! humans are not forced to play.
+    virtual std::string play(SearchLimits const& limits) override;
 
     //! \brief Notification from the GUI. When the mouse released event
     //! occured The human has made a valid move and we need to get it.
     void notified(std::string const& move);
 
+private:
+
+    //! \brief Wake up play() for quitting.
+    virtual void wake() override;
+
 private:
 
     const Rules &m_rules;
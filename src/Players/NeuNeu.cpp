@@ -19,22 +19,21 @@
 //=====================================================================
 
 #include "NeuNeu.hpp"
+#include "Utils/Arena.hpp"
+#include <chrono>
+#include <cstdio>
 #include <random>
 #include <iomanip>
+#include <sstream>
+#include <vector>
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
 
 //! \file See the document doc/ChessNeuNeu.pdf for understanding its code.
 
-//------------------------------------------------------------------------------
-// Random
-std::random_device rd;  // Will be used to obtain a seed for the random number engine
-std::mt19937 generator(rd()); // Standard mersenne_twister_engine seeded with rd()
-// Random sorting a chessboard square for pieces (except for pawns)
-std::uniform_int_distribution<> randomSquare(0, NbSquares - 1u);
-// Random sorting a chessboard square for pwans (excluding row 1 and 8)
-std::uniform_int_distribution<> randomPawn(sqA7, sqH2);
-// Random sorting a value between 0.0f and 1.0f (+/- epilson)
-std::uniform_real_distribution<float> randomProba(0.0f, 1.0f);
-
 //------------------------------------------------------------------------------
 //! \brief Print the type of piece.
 //------------------------------------------------------------------------------
@@ -85,19 +84,54 @@ std::ostream& operator<<(std::ostream& os, const NeuralPiece& p)
 
 //------------------------------------------------------------------------------
 NeuNeu::NeuNeu(const Rules &rules, const Color side)
-    : IPlayer(PlayerType::NeuNeuIA, side), m_rules(rules)
+    : IPlayer(PlayerType::NeuNeuIA, side), m_rules(rules),
+      m_generator(std::random_device{}())
 {
-    // Iterate on type of figures
+    // Networks are trained by the first call of play() so the training can
+    // be aborted.
     for (uint8_t i = 0u; i < 8u; ++i)
     {
         m_neurons[i] = new Synaps;
+        m_trained[i] = (NeuralPiece::NeuralEmpty == static_cast<NeuralPiece>(i));
+    }
+}
+
+//------------------------------------------------------------------------------
+bool NeuNeu::trained() const
+{
+    for (uint8_t i = 0u; i < 8u; ++i)
+    {
+        if (!m_trained[i])
+            return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool NeuNeu::halted(std::chrono::steady_clock::time_point const end,
+                    StopToken const* stop) const
+{
+    return aborted() || ((stop != nullptr) && stop->requested()) ||
+           (std::chrono::steady_clock::now() >= end);
+}
+
+//------------------------------------------------------------------------------
+bool NeuNeu::train(std::chrono::steady_clock::time_point const end,
+                   StopToken const* stop)
+{
+    // Iterate on type of figures
+    for (uint8_t i = 0u; i < 8u; ++i)
+    {
+        if (m_trained[i])
+            continue;
+
         NeuralPiece np = static_cast<NeuralPiece>(i);
-        if (NeuralPiece::NeuralEmpty != np)
-        {
-            trainSynaps(NeuralPiece2Piece(np), *m_neurons[i]);
-            showSynaps(np);
-        }
+        if (!trainSynaps(NeuralPiece2Piece(np), *m_neurons[i], end, stop))
+            return false;
+        m_trained[i] = true;
+        showSynaps(np);
     }
+    return true;
 }
 
 //------------------------------------------------------------------------------
@@ -112,15 +146,18 @@ NeuNeu::~NeuNeu()
 //------------------------------------------------------------------------------
 void NeuNeu::showSynaps(const NeuralPiece piece)
 {
+    // Formatted with snprintf: the format of std::cout is shared with the
+    // players of concurrent games.
     auto const& A = m_neurons[piece]->weights;
+    char cell[16];
 
     std::cout << "Synaps of " << piece << ":" << std::endl << "  ";
-    std::ios_base::fmtflags f(std::cout.flags());
 
     // Header: piece movement destination
     for (uint8_t i = 0; i < NbSquares; ++i)
     {
-        std::cout << std::setw(6) << c_square_names[i];
+        snprintf(cell, sizeof(cell), "%6s", c_square_names[i]);
+        std::cout << cell;
     }
     std::cout << std::endl;
 
@@ -131,63 +168,177 @@ void NeuNeu::showSynaps(const NeuralPiece piece)
 
         // Display weight of synaps
         for (uint8_t j = 0; j < NbSquares; ++j)
-            std::cout << std::setw(6) << (int) A[i][j];
+        {
+            snprintf(cell, sizeof(cell), "%6d", int(A[i][j]));
+            std::cout << cell;
+        }
         std::cout << std::endl;
     }
-    std::cout.flags(f);
 }
 
 //------------------------------------------------------------------------------
 void NeuNeu::showProbabilities(const uint8_t from)
 {
-    std::cout << "Probabilities: " << std::endl;
-
-    std::ios_base::fmtflags f(std::cout.flags());
-    std::cout << std::fixed << std::setprecision(6);
+    char proba[32];
 
+    std::cout << "Probabilities: " << std::endl;
     for (uint8_t to = 0; to < NbSquares; ++to)
     {
-        std::cout << "  " << toStrMove(from, to) << ": "
-                  << q[to] << std::endl;
+        snprintf(proba, sizeof(proba), "%.6f", double(q[to]));
+        std::cout << "  " << toStrMove(from, to) << ": " << proba << std::endl;
     }
-    std::cout.flags(f);
 }
 
 //------------------------------------------------------------------------------
-uint8_t NeuNeu::synapsPlay(const uint8_t from, Synaps &synaps)
+//! \brief Added to the sum of the outputs before normalizing them.
+static constexpr float c_epsilon = 0.000001f;
+
+#if defined(__AVX2__)
+//------------------------------------------------------------------------------
+//! \brief Return the sum of the 8 floats of the register.
+static inline float hsum(__m256 v)
 {
-    auto const& A = synaps.weights;
+    __m128 x = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 0x55));
+    return _mm_cvtss_f32(x);
+}
+
+//------------------------------------------------------------------------------
+//! \brief Return a * b + c.
+static inline __m256 madd(__m256 a, __m256 b, __m256 c)
+{
+#  if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#  else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#  endif
+}
+#elif defined(__SSE2__)
+//------------------------------------------------------------------------------
+//! \brief Return the sum of the 4 floats of the register.
+static inline float hsum(__m128 x)
+{
+    x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 0x55));
+    return _mm_cvtss_f32(x);
+}
+#endif
 
-    // Place the same piece on the input vector:
-    // 1.0f for the piece.
-    // 0.0f for empty squares.
+//------------------------------------------------------------------------------
+const char* synapsInstructionSet()
+{
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+//------------------------------------------------------------------------------
+void synapsGather(Synaps const& synaps, const uint8_t from, float q[NbSquares])
+{
+    // Strided loads: a SIMD gather instruction is not faster than scalar
+    // loads here.
     for (uint8_t i = 0; i < NbSquares; ++i)
-        e[i] = 0.0f;
-    e[from] = 1.0f;
+        q[i] = synaps.weights[i][from];
+}
+
+//------------------------------------------------------------------------------
+void synapsProductScalar(Synaps const& synaps, float const e[NbSquares], float q[NbSquares])
+{
+    auto const& A = synaps.weights;
 
-    // Matrix product q = A * e
     for (uint8_t i = 0; i < NbSquares; ++i)
+    {
         q[i] = 0.0f;
-    for (uint8_t i = 0; i < NbSquares; ++i)
         for (uint8_t j = 0; j < NbSquares; ++j)
             q[i] += (A[i][j] * e[j]);
+    }
+}
 
-    // Normalize q
-    {
-        float sum = 0.0f;
-        for (uint8_t i = 0; i < NbSquares; ++i)
-            sum += q[i];
+//------------------------------------------------------------------------------
+void synapsProduct(Synaps const& synaps, float const e[NbSquares], float q[NbSquares])
+{
+    auto const& A = synaps.weights;
 
-        // Avoid possible division by 0 with pawns
-        // FIXME if ((NeuralBlackPawn == TODO) || (NeuralWhitePawn == TODO))
+#if defined(__AVX2__)
+    // Dot product of each row with e: two accumulators hide the latency
+    for (uint8_t i = 0; i < NbSquares; ++i)
+    {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        for (uint8_t j = 0; j < NbSquares; j += 16u)
         {
-            sum += 0.000001f;
+            acc0 = madd(_mm256_loadu_ps(&A[i][j]), _mm256_loadu_ps(&e[j]), acc0);
+            acc1 = madd(_mm256_loadu_ps(&A[i][j + 8u]), _mm256_loadu_ps(&e[j + 8u]), acc1);
         }
-        assert(sum != 0.0f);
-
-        for (uint8_t i = 0; i < NbSquares; ++i)
-            q[i] /= sum;
+        q[i] = hsum(_mm256_add_ps(acc0, acc1));
+    }
+#elif defined(__SSE2__)
+    for (uint8_t i = 0; i < NbSquares; ++i)
+    {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        for (uint8_t j = 0; j < NbSquares; j += 8u)
+        {
+            acc0 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&A[i][j]), _mm_loadu_ps(&e[j])), acc0);
+            acc1 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&A[i][j + 4u]), _mm_loadu_ps(&e[j + 4u])), acc1);
+        }
+        q[i] = hsum(_mm_add_ps(acc0, acc1));
     }
+#else
+    (void) A;
+    synapsProductScalar(synaps, e, q);
+#endif
+}
+
+//------------------------------------------------------------------------------
+void synapsNormalize(float q[NbSquares])
+{
+    // Avoid possible division by 0 with pawns
+    // FIXME if ((NeuralBlackPawn == TODO) || (NeuralWhitePawn == TODO))
+#if defined(__AVX2__)
+    __m256 acc = _mm256_setzero_ps();
+    for (uint8_t i = 0; i < NbSquares; i += 8u)
+        acc = _mm256_add_ps(acc, _mm256_loadu_ps(&q[i]));
+    const float sum = hsum(acc) + c_epsilon;
+    assert(sum != 0.0f);
+
+    const __m256 scale = _mm256_set1_ps(1.0f / sum);
+    for (uint8_t i = 0; i < NbSquares; i += 8u)
+        _mm256_storeu_ps(&q[i], _mm256_mul_ps(_mm256_loadu_ps(&q[i]), scale));
+#elif defined(__SSE2__)
+    __m128 acc = _mm_setzero_ps();
+    for (uint8_t i = 0; i < NbSquares; i += 4u)
+        acc = _mm_add_ps(acc, _mm_loadu_ps(&q[i]));
+    const float sum = hsum(acc) + c_epsilon;
+    assert(sum != 0.0f);
+
+    const __m128 scale = _mm_set1_ps(1.0f / sum);
+    for (uint8_t i = 0; i < NbSquares; i += 4u)
+        _mm_storeu_ps(&q[i], _mm_mul_ps(_mm_loadu_ps(&q[i]), scale));
+#else
+    float sum = 0.0f;
+    for (uint8_t i = 0; i < NbSquares; ++i)
+        sum += q[i];
+    sum += c_epsilon;
+    assert(sum != 0.0f);
+
+    for (uint8_t i = 0; i < NbSquares; ++i)
+        q[i] /= sum;
+#endif
+}
+
+//------------------------------------------------------------------------------
+uint8_t NeuNeu::synapsPlay(const uint8_t from, Synaps &synaps)
+{
+    // The same piece is placed on the input vector e (1.0f for the piece,
+    // 0.0f for empty squares): the matrix product q = A * e is a column of A.
+    synapsGather(synaps, from, q);
+    synapsNormalize(q);
 
     // TODO Optimization: when doing all cases (not random) of possible movements
     // We can avoid to get destination of the movement because it's not used.
@@ -197,7 +348,7 @@ uint8_t NeuNeu::synapsPlay(const uint8_t from, Synaps &synaps)
 
     // Random the move destination
     // It's: ok that destination can be the origin
-    float y = randomProba(generator);
+    float y = m_random_proba(m_generator);
     float p = 0.0f;
     uint8_t to;
     for (to = 0; to < NbSquares; ++to)
@@ -211,9 +362,15 @@ uint8_t NeuNeu::synapsPlay(const uint8_t from, Synaps &synaps)
 }
 
 //------------------------------------------------------------------------------
-void NeuNeu::trainSynaps(Piece piece, Synaps &synaps)
+bool NeuNeu::trainSynaps(Piece piece, Synaps &synaps,
+                         std::chrono::steady_clock::time_point const end,
+                         StopToken const* stop)
 {
-    Rules local_rules;
+    // Dummy chessboard placed in the memory arena of the thread: released
+    // when training ends.
+    Arena& arena = Arena::local();
+    ArenaScope scope(arena);
+    Rules& local_rules = *arena.create<Rules>();
     chessboard board;
     bool res;
     std::string move;
@@ -234,12 +391,18 @@ void NeuNeu::trainSynaps(Piece piece, Synaps &synaps)
     const uint32_t c_max_iterations = 1000000u;
     for (uint32_t it = 0; it < c_max_iterations; ++it)
     {
+        if (((it % 4096u) == 0u) && halted(end, stop))
+            return false;
+
         uint8_t from = (piece.type == PieceType::Pawn)
-                       ? randomPawn(generator)
-                       : randomSquare(generator);
+                       ? m_random_pawn(m_generator)
+                       : m_random_square(m_generator);
 #else
     for (uint8_t from = 0; from < NbSquares; ++from)
     {
+        if (halted(end, stop))
+            return false;
+
         for (uint8_t to = 0; to < NbSquares; ++to)
         {
 #endif
@@ -289,32 +452,38 @@ void NeuNeu::trainSynaps(Piece piece, Synaps &synaps)
 #endif
         }
     }
+
+    return true;
 }
 
 //------------------------------------------------------------------------------
-// FIXME mettre en place la liste des pieces dans Rules pour eviter de
-// rechercher une piece
-std::string NeuNeu::play()
+std::string NeuNeu::play(SearchLimits const& limits)
 {
     // No move possible
     int len = m_rules.m_legal_moves.size();
     if (len == 0)
         return IPlayer::error;
 
-    // Get the list of squares where figures are present
-    std::vector<uint8_t> figures;
-    figures.reserve(16);
-    for (uint8_t i = 0u; i < NbSquares; ++i)
-    {
-        if (m_rules.m_board[i].color == m_rules.m_side)
-            figures.push_back(i);
-    }
-    assert(0u != figures.size());
+    // The deadline includes the training: when it is reached or when the
+    // caller asks for a move, give up the neural network.
+    const auto end = limits.end(std::chrono::steady_clock::now());
+    if (!train(end, limits.stop))
+        return aborted() ? IPlayer::quitting : toStrMove(m_rules.m_legal_moves[0]);
+
+    // Squares where figures are present are given by the piece lists
+    const uint8_t* figures = m_rules.m_pieces.squares[m_rules.m_side];
+    const uint8_t count = m_rules.m_pieces.count[m_rules.m_side];
+    assert(0u != count);
 
     // Randomize the origin of the movement
 l_find_piece:
-    std::uniform_int_distribution<> randomFigure(0u, figures.size() - 1u);
-    int rr = randomFigure(generator);
+    if (aborted())
+        return IPlayer::quitting;
+    if (halted(end, limits.stop))
+        return toStrMove(m_rules.m_legal_moves[0]);
+
+    std::uniform_int_distribution<> randomFigure(0u, count - 1u);
+    int rr = randomFigure(m_generator);
     std::cout << "RANDOM " << rr << std::endl;
     uint8_t from = figures[rr];
     PieceType p = static_cast<PieceType>(m_rules.m_board[from].type);
@@ -337,3 +506,74 @@ l_find_piece:
 
     return toStrMove(from, to);
 }
+
+//------------------------------------------------------------------------------
+void NeuNeu::benchmark(std::ostream& os, const uint32_t inferences)
+{
+    using Clock = std::chrono::steady_clock;
+
+    if (!train())
+        return ;
+
+    float e[NbSquares] = { 0.0f };
+    float out[NbSquares];
+    std::vector<uint8_t> squares(inferences);
+    volatile float sink = 0.0f;
+
+    // Inferences per second of the given inference of the piece placed on
+    // the random squares.
+    auto measure = [&](auto inference)
+    {
+        const auto start = Clock::now();
+        for (uint8_t from: squares)
+        {
+            inference(from);
+            sink = sink + out[from];
+        }
+        return double(inferences) / std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    std::ios_base::fmtflags f(os.flags());
+    os << "NeuNeu inferences per second (" << synapsInstructionSet() << "):" << std::endl
+       << std::setw(12) << "piece" << std::setw(14) << "scalar" << std::setw(14) << "product"
+       << std::setw(14) << "one-hot" << std::setw(10) << "speedup" << std::endl;
+    for (uint8_t i = 0u; i < 8u; ++i)
+    {
+        NeuralPiece np = static_cast<NeuralPiece>(i);
+        if (NeuralPiece::NeuralEmpty == np)
+            continue;
+
+        Synaps const& synaps = *m_neurons[i];
+        const bool pawn = (NeuralPiece::NeuralWhitePawn == np) || (NeuralPiece::NeuralBlackPawn == np);
+        for (auto& square: squares)
+            square = uint8_t(pawn ? m_random_pawn(m_generator) : m_random_square(m_generator));
+
+        // Full 64x64 product of a one-hot input (the former synapsPlay())
+        const double scalar = measure([&](const uint8_t from)
+        {
+            e[from] = 1.0f;
+            synapsProductScalar(synaps, e, out);
+            synapsNormalize(out);
+            e[from] = 0.0f;
+        });
+        const double product = measure([&](const uint8_t from)
+        {
+            e[from] = 1.0f;
+            synapsProduct(synaps, e, out);
+            synapsNormalize(out);
+            e[from] = 0.0f;
+        });
+        const double gather = measure([&](const uint8_t from)
+        {
+            synapsGather(synaps, from, out);
+            synapsNormalize(out);
+        });
+
+        std::ostringstream name;
+        name << np;
+        os << std::setw(12) << name.str() << std::fixed << std::setprecision(0)
+           << std::setw(14) << scalar << std::setw(14) << product << std::setw(14) << gather
+           << std::setprecision(1) << std::setw(9) << (gather / scalar) << "x" << std::endl;
+    }
+    os.flags(f);
+}
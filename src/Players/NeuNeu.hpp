@@ -22,6 +22,7 @@
 #  define NEUNEU_HPP
 
 #  include "Player.hpp"
+#  include <random>
 
 //! \brief Special enum for neural network. Shall match enum of pieces.
 enum NeuralPiece {
@@ -49,6 +50,29 @@ struct Synaps
     float weights[NbSquares][NbSquares];
 };
 
+//! \brief Output of the neural network for a single piece placed on the
+//! square from: the input vector e is one-hot (e[from] = 1.0f) so the product
+//! q = A * e is the column from of the weights (64 loads instead of 64x64
+//! multiplications).
+void synapsGather(Synaps const& synaps, const uint8_t from, float q[NbSquares]);
+
+//! \brief Output of the neural network for any input vector: q = A * e.
+//! Vectorized with AVX2 (or SSE2) when the compiler targets it (ie make
+//! NATIVE=1), else same as synapsProductScalar().
+void synapsProduct(Synaps const& synaps, float const e[NbSquares], float q[NbSquares]);
+
+//! \brief Portable version of synapsProduct().
+void synapsProductScalar(Synaps const& synaps, float const e[NbSquares], float q[NbSquares]);
+
+//! \brief Normalize the outputs q into probabilities. A small epsilon is added
+//! to the sum for avoiding the division by 0 (ie pawns on the last row).
+//! Vectorized like synapsProduct().
+void synapsNormalize(float q[NbSquares]);
+
+//! \brief Instruction set used by synapsProduct() and synapsNormalize():
+//! "AVX2", "SSE2" or "scalar".
+const char* synapsInstructionSet();
+
 // *****************************************************************************
 //! \brief Implement an IA chess player. Here, we are protopying a hand made
 //! neural network learning by itself how to move pieces (for the moment learnt
@@ -64,20 +88,28 @@ public:
 
     //! \brief return the valid move when playing against a component.
     //!
-    //! Random a piece to move then make the neural network computes the
-    //! probablity for each destination. Random a move depending its probabilty
-    //! to appear.
+    //! The neural networks not trained yet are trained first (the first call
+    //! is the slowest one). Random a piece to move then make the neural network
+    //! computes the probablity for each destination. Random a move depending
+    //! its probabilty to appear.
+    //!
+    //! \param limits only the deadline, the movetime and the stop token are
+    //! used: when reached or requested, even during the training, the first
+    //! legal move is returned instead of retrying random moves.
     //!
     //! \return the move as string (ie "e2e4" or "e7e8Q") or Move::none if not
-    //! possible to move a piece or Move::error for internal failure.
-    virtual std::string play() override;
+    //! possible to move a piece or Move::error for internal failure or
+    //! IPlayer::quitting if aborted.
+    virtual std::string play(SearchLimits const& limits) override;
 
-    //! \brief Abort signal for halting properly the play() method.
-    //! Implement it as you desired (usually a simple bool).
-    virtual void abort() override
-    {
-        // TODO
-    }
+    //! \brief Has the neural network of each piece been trained ?
+    bool trained() const;
+
+    //! \brief Train the neural networks then display the number of
+    //! inferences per second of each piece type for the scalar 64x64 product,
+    //! the vectorized product and the one-hot gather used by play().
+    //! \param[in] inferences number of inferences of each measure.
+    void benchmark(std::ostream& os, const uint32_t inferences = 200000u);
 
 private:
 
@@ -139,8 +171,25 @@ private:
         return (from >= sqA7) && (from <= sqH2);
     }
 
+    //! \brief Has abort() been called, the stop token requested or the
+    //! deadline reached ?
+    bool halted(std::chrono::steady_clock::time_point const end,
+                StopToken const* stop) const;
+
+    //! \brief Train the neural networks not trained yet.
+    //! \param end deadline of the training.
+    //! \param stop halting request of the caller of play() (or nullptr).
+    //! \return false if halted before the end: networks already trained are
+    //! kept and the training resumes at the next call.
+    bool train(std::chrono::steady_clock::time_point const end
+               = std::chrono::steady_clock::time_point::max(),
+               StopToken const* stop = nullptr);
+
     //! \brief Train the IA.
-    void trainSynaps(Piece piece, Synaps &synaps);
+    //! \return false if halted before the end.
+    bool trainSynaps(Piece piece, Synaps &synaps,
+                     std::chrono::steady_clock::time_point const end,
+                     StopToken const* stop);
 
     //! \brief Make synaps do a move
     uint8_t synapsPlay(const uint8_t from, Synaps &synaps);
@@ -160,12 +209,21 @@ private:
     //! \brief Hold neural network for each figures.
     Synaps *m_neurons[8u];
 
-    //! \brief Inputs of the neural network (1.0f means a figure and 0.0f means no
-    //! figure).
-    float e[NbSquares];
+    //! \brief Has the neural network of each figure been trained ?
+    bool m_trained[8u];
 
     //! \brief outputs of the neural network (probabilities of the movement).
     float q[NbSquares];
+
+    //! \brief Random generator of this player: players of concurrent games
+    //! (tournaments) do not share it.
+    std::mt19937 m_generator;
+    //! \brief Random sorting a chessboard square for pieces (except for pawns).
+    std::uniform_int_distribution<> m_random_square{0, NbSquares - 1u};
+    //! \brief Random sorting a chessboard square for pawns (excluding row 1 and 8).
+    std::uniform_int_distribution<> m_random_pawn{sqA7, sqH2};
+    //! \brief Random sorting a value between 0.0f and 1.0f.
+    std::uniform_real_distribution<float> m_random_proba{0.0f, 1.0f};
 };
 
 #endif
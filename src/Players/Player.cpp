@@ -28,7 +28,8 @@ static const char *c_player_types[] =
     [PlayerType::StockfishIA] = "Stockfish",
     [PlayerType::TscpIA] = "TSCP",
     [PlayerType::LokiIA] = "Loki",
-    [PlayerType::NeuNeuIA] = "NeuNeu"
+    [PlayerType::NeuNeuIA] = "NeuNeu",
+    [PlayerType::AlphaBetaIA] = "AlphaBeta"
 };
 
 //------------------------------------------------------------------------------
@@ -47,6 +48,7 @@ PlayerType playerType(const std::string& player)
     if (name == "human") return PlayerType::HumanPlayer;
     if (name == "tscp") return PlayerType::TscpIA;
     if (name == "loki") return PlayerType::LokiIA;
+    if (name == "alphabeta") return PlayerType::AlphaBetaIA;
 
     throw std::string("Unknonw PlayerType '" + player + "'");
 }
@@ -22,6 +22,7 @@
 #  define PLAYER_HPP
 
 #  include "Chess/Rules.hpp"
+#  include "Chess/Search.hpp"
 
 // *****************************************************************************
 //! \brief Define here all type of chess players. Currently implemented:
@@ -30,8 +31,9 @@
 //! -- TSCP: play against TSCP software (you shall install it)
 //! -- Loki: play against Loki3 software (you shall install it)
 //! -- NeuNeu: play against my neural network IA.
+//! -- AlphaBeta: play against the native alpha-beta search.
 // *****************************************************************************
-enum PlayerType { HumanPlayer, StockfishIA, TscpIA, LokiIA, NeuNeuIA };
+enum PlayerType { HumanPlayer, StockfishIA, TscpIA, LokiIA, NeuNeuIA, AlphaBetaIA };
 
 // *****************************************************************************
 //! \brief Abstract class for a chess player. If you desire to add your own IA
@@ -54,16 +56,49 @@ public:
 
     //! \brief Compute and return a legal move (like "e7e8q") or return
     //! Move::none for stalemate case or return Move::error in case of internal
-    //! error.
+    //! error or return IPlayer::quitting when aborted.
     //!
     //! This method can take long minutes to be done. This is normal because
     //! computations can be heavy. Therefore this method should be called from a
     //! thread.
-    virtual std::string play() = 0;
+    //!
+    //! \param[in] limits budget of this move (depth, nodes, movetime,
+    //! deadline) combined with the budget the player has been created with.
+    //! Players return their best move so far when the budget is exhausted.
+    //! SearchLimits::stop is the request of the caller for the best move so
+    //! far (ie the UCI "stop" command): players able to honor it (alphabeta,
+    //! neuneu) return a move, the others ignore it. Contrary to abort(), it
+    //! does not make play() return IPlayer::quitting.
+    virtual std::string play(SearchLimits const& limits) = 0;
+
+    //! \brief Ask the running play() to return as soon as possible (can be
+    //! called from another thread). The request persists until resume(): a
+    //! play() called after abort() returns at once.
+    void abort()
+    {
+        m_stop.request();
+        wake();
+    }
+
+    //! \brief Cancel abort() before calling play() again.
+    inline void resume()
+    {
+        m_stop.reset();
+    }
+
+    //! \brief Has abort() been called since the last resume() ?
+    inline bool aborted() const
+    {
+        return m_stop.requested();
+    }
 
-    //! \brief Abort signal for halting properly the play() method.
-    //! Implement it as you desired (usually a simple bool).
-    virtual void abort() = 0;
+    //! \brief Number of positions searched by the running play(). Can be
+    //! called from another thread (ie for displaying the progress of the
+    //! search). Return 0 if the player does not count them.
+    virtual uint64_t nodes() const
+    {
+        return 0u;
+    }
 
     //! \brief Getter returning the color of the play (white/black).
     inline Color side() const
@@ -83,6 +118,16 @@ public:
     //! \brief Used by the play() method when the user want to quit ChessNeuNeu.
     static constexpr const char* quitting = "::quitting";
 
+protected:
+
+    //! \brief Called by abort() after the stop token has been requested for
+    //! waking up a play() blocked on a condition variable or on a system call.
+    //! Players polling aborted() have nothing to do.
+    virtual void wake() {}
+
+    //! \brief Requested by abort(), polled by play().
+    StopToken m_stop;
+
 private:
 
     PlayerType m_type;
@@ -0,0 +1,58 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "PlayerFactory.hpp"
+#include "Stockfish.hpp"
+#include "TSCP.hpp"
+#include "Loki.hpp"
+#include "NeuNeu.hpp"
+#include "Human.hpp"
+
+//------------------------------------------------------------------------------
+std::shared_ptr<IPlayer> createPlayer(const PlayerType type, const Rules& rules,
+                                      const Color side, std::string const& fen,
+                                      AlphaBetaOptions const& options,
+                                      EnginePools const* pools)
+{
+    if (pools != nullptr)
+    {
+        auto it = pools->find(type);
+        if (it != pools->end())
+            return std::make_shared<UciEngine>(type, rules, side, fen, options.limits, it->second);
+    }
+
+    switch (type)
+    {
+    case PlayerType::StockfishIA:
+        return std::make_shared<Stockfish>(rules, side, fen, options.limits);
+    case PlayerType::TscpIA:
+        return std::make_shared<Tscp>(rules, side, options.limits);
+    case PlayerType::LokiIA:
+        return std::make_shared<Loki>(rules, side, fen, options.limits);
+    case PlayerType::NeuNeuIA:
+        return std::make_shared<NeuNeu>(rules, side);
+    case PlayerType::AlphaBetaIA:
+        return std::make_shared<AlphaBeta>(rules, side, options);
+    case PlayerType::HumanPlayer:
+        return std::make_shared<Human>(rules, side);
+    default:
+        throw std::string("createPlayer: Unknown PlayerType");
+    }
+}
@@ -0,0 +1,41 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef PLAYER_FACTORY_HPP
+#  define PLAYER_FACTORY_HPP
+
+#  include "AlphaBeta.hpp"
+#  include "EnginePool.hpp"
+#  include <memory>
+
+//! \brief Factory creating a player of the given type and color playing on the
+//! given rules (shall outlive the player).
+//! \param fen the initial chessboard given to external engines (empty for the
+//! initial position).
+//! \param options settings of the native alphabeta player (its limits are
+//! also given to external engines).
+//! \param pools optional pools of started UCI engines: a UCI player having a
+//! pool leases its engine from it instead of starting a new process.
+std::shared_ptr<IPlayer> createPlayer(const PlayerType type, const Rules& rules,
+                                      const Color side, std::string const& fen,
+                                      AlphaBetaOptions const& options,
+                                      EnginePools const* pools = nullptr);
+
+#endif
@@ -21,14 +21,13 @@
 #ifndef STOCKFISH_HPP
 #  define STOCKFISH_HPP
 
-#  include "Player.hpp"
-#  include "Utils/IPC.hpp"
+#  include "UciEngine.hpp"
 
 // *****************************************************************************
 //! \brief Implement a chess player. Call the stockfish program and
-//! communicate with it through a bidirectional pipe.
+//! communicate with it through a UCI session on a bidirectional pipe.
 // *****************************************************************************
-class Stockfish: public IPC, public IPlayer
+class Stockfish: public UciEngine
 {
 public:
 
@@ -36,21 +35,9 @@ public:
     //! \param fen if the game shall starts from a loaded chessboard: in this
     //! case use a Forsyth-Edwards Notation string. In the case you desire
     //! starting from the initial chessboard position pass an empty string.
-    Stockfish(const Rules &rules, const Color side, std::string const& fen = "");
-    //! \brief return the Stockfish move.
-    virtual std::string play() override;
-    virtual void abort() override;
-
-private:
-
-    //! \brief start the game from a loaded chessboard. Use Forsyth-Edwards
-    //! Notation.
-    std::string m_initial_board;
-    //! \brief We need to access to the chess rules for getting the list of
-    //! played moves.
-    const Rules &m_rules;
-    //! \brief For leaving loop
-    bool m_aborting = false;
+    //! \param limits limits of the search of each move.
+    Stockfish(const Rules &rules, const Color side, std::string const& fen = "",
+              SearchLimits const& limits = SearchLimits());
 };
 
 #endif
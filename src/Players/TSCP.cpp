@@ -19,20 +19,29 @@
 //=====================================================================
 
 #include "TSCP.hpp"
-#include <algorithm> // std::min
+#include <chrono>
+#include <iostream>
 
 //------------------------------------------------------------------------------
 // FIXME TSCP has a bug: it misses flushing code therefore complete
 // message cannot be received. So with version 181 you have to add
 // some "fflush(stdout);" on its code (after printf() function not
 // using "\n".
-Tscp::Tscp(const Rules &rules, const Color side)
-    : IPC("tscp"), IPlayer(PlayerType::TscpIA, side), m_rules(rules)
+Tscp::Tscp(const Rules &rules, const Color side, SearchLimits const& limits)
+    : IPC("tscp"), IPlayer(PlayerType::TscpIA, side), m_rules(rules),
+      m_limits(limits)
 {
+    const std::string command = budget(limits);
+    if (!command.empty())
+    {
+        write(command);
+    }
+
     // Force TSCP to move
     if (Color::White == side)
     {
         write("on\n");
+        m_playing = true;
     }
 }
 
@@ -43,94 +52,129 @@ Tscp::~Tscp()
 }
 
 //------------------------------------------------------------------------------
-void Tscp::abort()
+void Tscp::wake()
 {
-    m_aborting = true;
+    interrupt();
 }
 
 //------------------------------------------------------------------------------
-std::string Tscp::play()
+std::string Tscp::budget(SearchLimits const& limits)
 {
-    // Extract the last move
-    std::string last_move(m_rules.m_moved.substr(m_rules.m_moved.rfind(" ") + 1));
+    // Search limits: "st" in seconds or "sd" in plies
+    std::string command;
+    if (limits.movetime != 0u)
+    {
+        command = "st " + std::to_string((limits.movetime + 999u) / 1000u) + '\n';
+    }
+    else if (limits.depth < MaxSearchPlies - 1u)
+    {
+        command = "sd " + std::to_string(limits.depth) + '\n';
+    }
 
-    // Force TSCP to move at first iteration
-    if ((m_rules.m_moved.size() <= 4) && (Color::Black == side()))
+    if (command == m_budget)
+        return {};
+    m_budget = command;
+    return command;
+}
+
+//------------------------------------------------------------------------------
+std::string Tscp::play(SearchLimits const& request)
+{
+    // A wake up byte of a previous abort() is dropped before checking the
+    // stop token: an abort() arriving after the check interrupts the wait.
+    clearInterrupt();
+    if (aborted())
+        return IPlayer::quitting;
+
+    // Number of moves of the game known by TSCP
+    size_t known = std::min<size_t>(m_moves.size(), m_rules.plies());
+    for (size_t i = 0u; i < known; ++i)
     {
-        last_move += " on";
+        if (!(m_moves[i] == m_rules.m_undo[i].move))
+        {
+            known = i;
+            break;
+        }
     }
 
-    // Create and send the command to TSCP
-    write(last_move + '\n');
+    // Moves have been reverted (ie by the GUI): replay the game from scratch
+    std::string command;
+    if (known < m_moves.size())
+    {
+        command = "new\n";
+        m_moves.clear();
+        m_playing = false;
+        known = 0u;
+    }
 
-    // Get and parse the TSCP answer
-    std::string answer;
-    std::string move;
-    uint8_t retry = 0u;
-    int found;
+    // Budget of this move, set before TSCP starts thinking on the opponent
+    // move. TSCP only understands durations.
+    const SearchLimits limits = tightest(m_limits, request).relative();
+    command += budget(limits);
 
-    do
+    // Send the moves TSCP does not know (usually the last opponent move)
+    for (size_t i = known; i < m_rules.plies(); ++i)
     {
-        // The player wants to quit the game (from GUI) while we are
-        // parsing TSCP answer ?
-        if (m_aborting)
-            goto l_quit;
+        m_moves.push_back(m_rules.m_undo[i].move);
+        command += toStrMove(m_rules.m_undo[i].move);
+        command += '\n';
+    }
 
-        // Read TSCP message from the IPC pipe
-        if (!read(answer))
-            goto l_error;
+    // Force TSCP to move at first iteration
+    if (!m_playing)
+    {
+        command += "on\n";
+        m_playing = true;
+    }
 
-        // Look for the keyword giving the move
-        usleep(10000);
-        found = answer.find("move: ");
+    // Send the command to TSCP
+    const auto start = std::chrono::steady_clock::now();
+    write(command);
 
-        if (found >= 0)
+    // Get and parse the TSCP answer: sleep until TSCP sends the line
+    // "Computer's move: <move>" or "(no legal moves)"
+    std::string move;
+    const ReadStatus status = readLines([&move](std::string const& line)
+    {
+        if (line.find("(no legal moves)") != std::string::npos)
         {
-            // Keyword found ! Try extracting the move
-            // 6 == strlen("move: ")
-            // 5 == chess move with promotion or white space
-            //      (ie: "e2e4 " or "e7e8q").
-            move = answer.substr(found + 6, 5);
-
-            // TSCP did not finish sending all its message: keep
-            // looping.
-            if (move.length() < 5)
-                found = -1;
+            move = Move::none;
+            return true;
         }
 
-        // No move found: wait a little to let TSCP returning a bigger
-        // message and try again to extract the move.
-        if  (-1 == found)
-        {
-            // Give time to TSCP to send more message
-            usleep(10000);
+        const size_t found = line.find("move: ");
+        if (found == std::string::npos)
+            return false;
 
-            // Too many failures: abort
-            if (++retry > 100)
-                goto l_error;
-        }
-    }
-    while (-1 == found);
+        // 6 == strlen("move: ")
+        move = line.substr(found + 6u, line.find(' ', found + 6u) - found - 6u);
+        return true;
+    }, ReadTimeout + int(limits.movetime));
 
-    // Check if the returned move is well formed.
-    assert(
-        // Stalemate case
-        (move == "(no l") ||
-        // Regexp of move [a-h][1-8][a-h][1-8]
-        ((move[0] >= 'a') && (move[0] <= 'h') &&
-         (move[1] >= '1') && (move[1] <= '8') &&
-         (move[2] >= 'a') && (move[2] <= 'h') &&
-         (move[3] >= '1') && (move[3] <= '8') &&
-         // Regexp of pawn promotion or white space
-         ((move[4] == ' ') || (move[4] == '\n') ||
-          (move[4] == 'n') || (move[4] == 'b') ||
-          (move[4] == 'q') || (move[4] == 'r')))
-           );
-
-    // TSCP returns "(no legal move)" for stalemate
-    if (move[0] == '(')
+    // The player wants to quit the game (from GUI) while we are
+    // waiting for TSCP answer ?
+    if (status == ReadStatus::Interrupted)
+        goto l_quit;
+
+    if (status != ReadStatus::Done)
+        goto l_error;
+
+    m_latency.record(std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count());
+
+    // TSCP returns "(no legal moves)" for stalemate
+    if (move == Move::none)
         return Move::none;
 
+    // Check if the returned move is well formed.
+    if (!isWellFormed(move))
+    {
+        goto l_error;
+    }
+
+    // TSCP played this move: it is part of the game it knows
+    m_moves.push_back(Move(move));
+
     // Chess move extracted with success
     return move;
 
@@ -138,6 +182,6 @@ l_quit:
     return IPlayer::quitting;
 
 l_error:
-    std::cerr << "Failed reading TSCP move" << std::endl;
+    std::cerr << "Failed reading TSCP move '" << move << "'" << std::endl;
     return IPlayer::error;
 }
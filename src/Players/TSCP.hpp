@@ -22,27 +22,56 @@
 #  define TSCP_HPP
 
 #  include "Player.hpp"
+#  include "Chess/Search.hpp"
 #  include "Utils/IPC.hpp"
+#  include <vector>
 
 // *****************************************************************************
 //! \brief Implement a chess player. Call the TSCP program and communicate with
-//! it through a bidirectional pipe.
+//! it through a bidirectional pipe. TSCP keeps the game during the whole
+//! session: only the moves it does not know yet are sent.
 // *****************************************************************************
 class Tscp: public IPC, public IPlayer
 {
 public:
 
-    Tscp(const Rules &rules, const Color side);
+    //! \brief Constructor.
+    //! \param limits only the movetime (rounded up to seconds) or the depth
+    //! are understood by TSCP.
+    Tscp(const Rules &rules, const Color side, SearchLimits const& limits = SearchLimits());
     ~Tscp();
-    virtual std::string play() override;
-    virtual void abort() override;
+
+    //! \param limits only the movetime, the deadline or the depth are
+    //! understood by TSCP.
+    virtual std::string play(SearchLimits const& limits) override;
+
+    //! \brief Statistics of move -> answer round trips.
+    inline Latency const& latency() const { return m_latency; }
+
+private:
+
+    //! \brief Interrupt the wait for the TSCP answer.
+    virtual void wake() override;
+
+    //! \brief Return the TSCP command setting the search limits ("st" in
+    //! seconds or "sd" in plies) or an empty string if they are already set.
+    std::string budget(SearchLimits const& limits);
 
 private:
 
     //! \brief We need to access to the chess rules for getting the list of
     //! played moves.
     const Rules &m_rules;
-    bool m_aborting = false;
+    //! \brief Moves of the game known by TSCP.
+    std::vector<Move> m_moves;
+    //! \brief Limits the player has been created with.
+    SearchLimits m_limits;
+    //! \brief Last limits command sent to TSCP.
+    std::string m_budget;
+    //! \brief Has TSCP been asked to play its side ("on") ?
+    bool m_playing = false;
+    //! \brief Round trips of moves.
+    Latency m_latency;
 };
 
 #endif
@@ -0,0 +1,88 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "UciEngine.hpp"
+#include "EnginePool.hpp"
+
+//------------------------------------------------------------------------------
+bool isUciEngine(const PlayerType type)
+{
+    return (type == PlayerType::StockfishIA) || (type == PlayerType::LokiIA);
+}
+
+//------------------------------------------------------------------------------
+UciEngineConfig uciEngineConfig(const PlayerType type)
+{
+    switch (type)
+    {
+    case PlayerType::StockfishIA:
+        return UciEngineConfig("stockfish");
+    case PlayerType::LokiIA:
+        return UciEngineConfig(THIRDPART "/Loki/Loki3");
+    default:
+        throw std::string("uciEngineConfig: not a UCI engine");
+    }
+}
+
+//------------------------------------------------------------------------------
+UciEngine::UciEngine(const PlayerType type, const Rules &rules, const Color side,
+                     std::string const& fen, SearchLimits const& limits,
+                     UciEngineConfig const& config)
+    : IPlayer(type, side),
+      m_rules(rules),
+      m_session(std::make_unique<UciSession>(config, fen, limits))
+{}
+
+//------------------------------------------------------------------------------
+UciEngine::UciEngine(const PlayerType type, const Rules &rules, const Color side,
+                     std::string const& fen, SearchLimits const& limits,
+                     std::shared_ptr<EnginePool> pool)
+    : IPlayer(type, side),
+      m_rules(rules),
+      m_pool(pool),
+      m_session(pool->acquire(fen, limits))
+{}
+
+//------------------------------------------------------------------------------
+UciEngine::~UciEngine()
+{
+    if (m_pool != nullptr)
+    {
+        m_pool->release(std::move(m_session), m_failed);
+    }
+}
+
+//------------------------------------------------------------------------------
+void UciEngine::wake()
+{
+    m_session->stop();
+}
+
+//------------------------------------------------------------------------------
+std::string UciEngine::play(SearchLimits const& limits)
+{
+    SearchLimits budget(limits);
+    budget.stop = &m_stop;
+
+    std::string move = m_session->go(m_rules, budget);
+    if (move == IPlayer::error)
+        m_failed = true;
+    return move;
+}
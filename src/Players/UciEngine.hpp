@@ -0,0 +1,88 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef UCI_ENGINE_HPP
+#  define UCI_ENGINE_HPP
+
+#  include "Player.hpp"
+#  include "UciSession.hpp"
+#  include <memory>
+
+class EnginePool;
+
+//! \brief Is the player an external engine talking UCI (Stockfish, Loki) ?
+bool isUciEngine(const PlayerType type);
+
+//! \brief Return how to start the UCI engine of the given player type.
+//! \throw std::string if the player is not a UCI engine.
+UciEngineConfig uciEngineConfig(const PlayerType type);
+
+// *****************************************************************************
+//! \brief Implement a chess player with any external engine talking the
+//! Universal Chess Interface. The engine is either started for this player or
+//! leased from an EnginePool of already started engines and given back when
+//! the player is destroyed.
+// *****************************************************************************
+class UciEngine: public IPlayer
+{
+public:
+
+    //! \brief Start an engine for this player.
+    //! \param fen if the game shall starts from a loaded chessboard: in this
+    //! case use a Forsyth-Edwards Notation string. In the case you desire
+    //! starting from the initial chessboard position pass an empty string.
+    //! \param limits limits of the search of each move.
+    //! \param config path of the engine program and its options.
+    UciEngine(const PlayerType type, const Rules &rules, const Color side,
+              std::string const& fen, SearchLimits const& limits,
+              UciEngineConfig const& config);
+
+    //! \brief Lease an engine from the pool (wait for a free one).
+    UciEngine(const PlayerType type, const Rules &rules, const Color side,
+              std::string const& fen, SearchLimits const& limits,
+              std::shared_ptr<EnginePool> pool);
+
+    //! \brief Give back the engine to its pool (or stop it).
+    ~UciEngine();
+
+    //! \brief return the engine move.
+    virtual std::string play(SearchLimits const& limits) override;
+
+    //! \brief The session with the engine (latency ...).
+    inline UciSession const& session() const { return *m_session; }
+
+private:
+
+    //! \brief Interrupt the wait for the engine answer.
+    virtual void wake() override;
+
+private:
+
+    //! \brief We need to access to the chess rules for getting the list of
+    //! played moves.
+    const Rules &m_rules;
+    //! \brief Owner of the engine when leased.
+    std::shared_ptr<EnginePool> m_pool;
+    std::unique_ptr<UciSession> m_session;
+    //! \brief The engine failed answering: do not reuse it.
+    bool m_failed = false;
+};
+
+#endif
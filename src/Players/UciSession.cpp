@@ -0,0 +1,259 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "UciSession.hpp"
+#include "Player.hpp"
+#include <iostream>
+
+//! \brief Max duration in milliseconds for the engine to answer "uci" and
+//! "isready".
+static constexpr int c_handshake_timeout = 10000;
+
+//! \brief Max duration in milliseconds for the engine to answer "stop" when
+//! aborted.
+static constexpr int c_stop_timeout = 200;
+
+//------------------------------------------------------------------------------
+UciSession::UciSession(UciEngineConfig const& config, std::string const& fen,
+                       SearchLimits const& limits)
+    : IPC(config.path), m_limits(limits)
+{
+    if (!handshake("uci\n", "uciok"))
+        throw std::string("UCI engine '") + config.path + "' did not answer to 'uci'";
+
+    // Options are applied (ie hash tables allocated) before "readyok"
+    for (auto const& option: config.options)
+    {
+        write("setoption name " + option.first + " value " + option.second + '\n');
+    }
+
+    if (!newGame(fen))
+        throw std::string("UCI engine '") + config.path + "' is not ready";
+}
+
+//------------------------------------------------------------------------------
+bool UciSession::handshake(std::string const& command, std::string const& answer)
+{
+    write(command);
+    return readLines([&answer](std::string const& line)
+    {
+        return line.compare(0u, answer.size(), answer) == 0;
+    }, c_handshake_timeout) == ReadStatus::Done;
+}
+
+//------------------------------------------------------------------------------
+bool UciSession::newGame(std::string const& fen)
+{
+    m_fen = fen;
+    m_position.clear();
+    m_moves.clear();
+    m_clock[Color::White] = m_clock[Color::Black] = m_limits.time;
+    m_has_answered = false;
+    clearInterrupt();
+
+    // Drop the answer of a search stopped by stop()
+    if (m_searching)
+    {
+        write("stop\n");
+        std::string move;
+        if (bestMove(move, c_handshake_timeout) != ReadStatus::Done)
+            return false;
+    }
+
+    return handshake("ucinewgame\nisready\n", "readyok");
+}
+
+//------------------------------------------------------------------------------
+std::string const& UciSession::position(Rules const& rules)
+{
+    // Length of the game already known by the engine
+    size_t known = std::min<size_t>(m_moves.size(), rules.plies());
+    for (size_t i = 0u; i < known; ++i)
+    {
+        if (!(m_moves[i] == rules.m_undo[i].move))
+        {
+            known = i;
+            break;
+        }
+    }
+
+    // Moves have been reverted (ie by the GUI): rebuild the command
+    if (m_position.empty() || (known < m_moves.size()))
+    {
+        m_moves.clear();
+        m_position = "position ";
+        m_position += m_fen.empty() ? "startpos" : ("fen " + m_fen);
+        m_position += " moves";
+        known = 0u;
+    }
+
+    // Append the new moves only
+    for (size_t i = known; i < rules.plies(); ++i)
+    {
+        m_moves.push_back(rules.m_undo[i].move);
+        m_position += ' ';
+        m_position += toStrMove(rules.m_undo[i].move);
+    }
+
+    return m_position;
+}
+
+//------------------------------------------------------------------------------
+std::string UciSession::goCommand() const
+{
+    return goCommand(m_limits);
+}
+
+//------------------------------------------------------------------------------
+std::string UciSession::goCommand(SearchLimits const& limits) const
+{
+    std::string command("go");
+
+    if (limits.time != 0u)
+    {
+        // Never send a negative or null clock (the engine would play instantly)
+        command += " wtime " + std::to_string(std::max<int64_t>(1, m_clock[Color::White]));
+        command += " btime " + std::to_string(std::max<int64_t>(1, m_clock[Color::Black]));
+        if (limits.inc != 0u)
+        {
+            command += " winc " + std::to_string(limits.inc);
+            command += " binc " + std::to_string(limits.inc);
+        }
+    }
+    if (limits.movetime != 0u)
+        command += " movetime " + std::to_string(limits.movetime);
+    if (limits.nodes != 0u)
+        command += " nodes " + std::to_string(limits.nodes);
+    if (limits.depth < MaxSearchPlies - 1u)
+        command += " depth " + std::to_string(limits.depth);
+
+    // No limit: keep the historical fixed depth rather than searching forever
+    if (command.size() == 2u)
+        command += " depth 6";
+
+    return command + '\n';
+}
+
+//------------------------------------------------------------------------------
+IPC::ReadStatus UciSession::bestMove(std::string& move, const int timeout_ms)
+{
+    ReadStatus status = readLines([&move](std::string const& line)
+    {
+        if (line.compare(0u, 9u, "bestmove ") != 0)
+            return false;
+
+        // 9 == strlen("bestmove ")
+        move = line.substr(9u, line.find(' ', 9u) - 9u);
+        return true;
+    }, timeout_ms);
+
+    if (status == ReadStatus::Done)
+        m_searching = false;
+    return status;
+}
+
+//------------------------------------------------------------------------------
+void UciSession::stop()
+{
+    interrupt();
+}
+
+//------------------------------------------------------------------------------
+std::string UciSession::go(Rules const& rules, SearchLimits const& request)
+{
+    using namespace std::chrono;
+
+    const Color side = rules.m_side;
+    std::string move;
+
+    // A wake up byte of a previous stop() is dropped before checking the
+    // token: a stop() arriving after the check interrupts the wait below.
+    clearInterrupt();
+    if (request.stopRequested())
+        return IPlayer::quitting;
+
+    // Drop the answer of a search stopped by stop()
+    if (m_searching)
+    {
+        write("stop\n");
+        if (bestMove(move, c_handshake_timeout) != ReadStatus::Done)
+            return IPlayer::error;
+    }
+
+    // Charge the thinking time of the opponent on its clock
+    auto start = steady_clock::now();
+    if ((m_limits.time != 0u) && m_has_answered)
+    {
+        m_clock[opposite(side)] -= duration_cast<milliseconds>(start - m_answered).count();
+        m_clock[opposite(side)] += m_limits.inc;
+    }
+
+    // Ask the engine to search the position. The engine only understands
+    // durations: the deadline becomes a movetime.
+    const SearchLimits limits = tightest(m_limits, request).relative();
+    write(position(rules) + '\n' + goCommand(limits));
+    m_searching = true;
+
+    // Sleep until the engine answers. Let it spend its time and more.
+    const int timeout = ReadTimeout + int(limits.movetime) +
+                        int(std::max<int64_t>(0, m_clock[side]));
+    ReadStatus status = bestMove(move, timeout);
+
+    // Aborted while waiting for the engine answer: the best move found so
+    // far is returned if the engine answers "stop" quickly. Else its answer
+    // is dropped by the next call.
+    if (status == ReadStatus::Interrupted)
+    {
+        write("stop\n");
+        status = bestMove(move, c_stop_timeout);
+        if (status != ReadStatus::Done)
+            return IPlayer::quitting;
+    }
+
+    if (status != ReadStatus::Done)
+    {
+        std::cerr << "Failed reading the UCI engine move" << std::endl;
+        return IPlayer::error;
+    }
+
+    // Round trip and clock of the engine
+    m_answered = steady_clock::now();
+    m_has_answered = true;
+    const auto elapsed = duration_cast<microseconds>(m_answered - start).count();
+    m_latency.record(double(elapsed) / 1000000.0);
+    if (m_limits.time != 0u)
+    {
+        m_clock[side] -= elapsed / 1000;
+        m_clock[side] += m_limits.inc;
+    }
+
+    // The engine returns "(none)" for stalemate and checkmate
+    if (move == "(none)")
+        return Move::none;
+
+    if (!isWellFormed(move))
+    {
+        std::cerr << "Failed reading the UCI engine move '"
+                  << move << "'" << std::endl;
+        return IPlayer::error;
+    }
+
+    return move;
+}
@@ -0,0 +1,143 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef UCI_SESSION_HPP
+#  define UCI_SESSION_HPP
+
+#  include "Chess/Search.hpp"
+#  include "Utils/IPC.hpp"
+#  include <chrono>
+#  include <utility>
+#  include <vector>
+
+//! \brief UCI option of an engine sent by "setoption name <first> value
+//! <second>" (ie { "Hash", "64" }).
+using UciOption = std::pair<std::string, std::string>;
+
+// *****************************************************************************
+//! \brief How to start an external UCI engine.
+// *****************************************************************************
+struct UciEngineConfig
+{
+    UciEngineConfig(std::string const& path_, std::vector<UciOption> const& options_ = {})
+        : path(path_), options(options_)
+    {}
+
+    //! \brief Path of the engine program.
+    std::string path;
+    //! \brief Options set once after the "uci" handshake.
+    std::vector<UciOption> options;
+};
+
+// *****************************************************************************
+//! \brief Long-lived session with an external engine talking the Universal
+//! Chess Interface protocol (Stockfish, Loki ...). The engine process is
+//! started and initialized ("uci", "isready") once, then each move is a
+//! "position" + "go" request answered by "bestmove".
+//!
+//! The session remembers the moves already sent to the engine: the position
+//! command is extended with the new moves only instead of being rebuilt from
+//! the whole game (UCI has no command for sending a position delta, so the
+//! command itself still holds all moves). The engine clock is tracked when
+//! the limits define one and the round trip of each move is measured.
+// *****************************************************************************
+class UciSession: public IPC
+{
+public:
+
+    //! \brief Start the engine, set its options and wait until it is ready.
+    //! \param[in] config the path of the engine program and its options.
+    //! \param[in] fen the initial position (empty string for the initial
+    //! chessboard position).
+    //! \param[in] limits limits given to the "go" command.
+    //! \throw std::string if the engine does not answer to the handshake.
+    UciSession(UciEngineConfig const& config, std::string const& fen,
+               SearchLimits const& limits);
+
+    //! \brief Change the limits of the next "go" commands. Call newGame()
+    //! after for resetting the clock.
+    inline void setLimits(SearchLimits const& limits) { m_limits = limits; }
+
+    //! \brief Start a new game from the given position ("ucinewgame" then
+    //! "isready"): forget the moves sent and reset the clock.
+    //! \return false if the engine did not answer "readyok".
+    bool newGame(std::string const& fen);
+
+    //! \brief Send the position of rules and return the move found by the
+    //! engine in UCI notation, or Move::none if there is no legal move, or
+    //! IPlayer::quitting if the stop token of limits has been requested, or
+    //! IPlayer::error.
+    //! \param[in] limits budget of this move combined with the limits of the
+    //! session (see tightest()).
+    std::string go(Rules const& rules, SearchLimits const& limits = SearchLimits());
+
+    //! \brief Wake up go() from another thread after the stop token given
+    //! to go() has been requested. The engine is asked to stop searching: its
+    //! answer is dropped by the next call to go() or newGame().
+    void stop();
+
+    //! \brief Return the "position" command for the given game and remember
+    //! its moves as known by the engine.
+    std::string const& position(Rules const& rules);
+
+    //! \brief Return the "go" command with the limits of the session and the
+    //! clocks.
+    std::string goCommand() const;
+
+    //! \brief Return the "go" command with the given limits and the clocks.
+    std::string goCommand(SearchLimits const& limits) const;
+
+    //! \brief Statistics of "go" -> "bestmove" round trips.
+    inline Latency const& latency() const { return m_latency; }
+
+    //! \brief Remaining time in milliseconds on the clock of the side.
+    inline int64_t clock(const Color side) const { return m_clock[side]; }
+
+private:
+
+    //! \brief Send a command and wait for the line starting with the given
+    //! answer.
+    bool handshake(std::string const& command, std::string const& answer);
+
+    //! \brief Wait for the "bestmove" line and extract its move.
+    ReadStatus bestMove(std::string& move, const int timeout_ms);
+
+    //! \brief Initial position: empty for the initial chessboard position.
+    std::string m_fen;
+    //! \brief Limits of the "go" command.
+    SearchLimits m_limits;
+    //! \brief Last position command sent to the engine.
+    std::string m_position;
+    //! \brief Moves of the game held by m_position.
+    std::vector<Move> m_moves;
+    //! \brief Remaining time on the clock of each side (milliseconds).
+    int64_t m_clock[2];
+    //! \brief When the engine returned its last move (for charging the
+    //! thinking time of the opponent on its clock).
+    std::chrono::steady_clock::time_point m_answered;
+    //! \brief Has m_answered been set in this game ?
+    bool m_has_answered = false;
+    //! \brief A "bestmove" is still expected from an aborted search.
+    bool m_searching = false;
+    //! \brief Round trips of "go" commands.
+    Latency m_latency;
+};
+
+#endif
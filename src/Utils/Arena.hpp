@@ -0,0 +1,170 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef ARENA_HPP
+#  define ARENA_HPP
+
+#  include <cstddef>
+#  include <cstdint>
+#  include <memory>
+#  include <new>
+#  include <string>
+#  include <type_traits>
+#  include <utility>
+
+// *****************************************************************************
+//! \brief Memory arena (bump allocator) for objects of the hot paths: copies
+//! of positions (Rules), move lists, undo records of searches and trainings.
+//! The memory is allocated once, objects are placed one after the other and
+//! released all at once in O(1) by reset() or rewind(): no malloc nor free
+//! while walking the tree of moves. Destructors are never called, so only
+//! trivially destructible types are accepted.
+//!
+//! An arena is not thread-safe: use one arena per thread (see local()).
+// *****************************************************************************
+class Arena
+{
+public:
+
+    //! \brief Default capacity of arenas returned by local().
+    static constexpr size_t DefaultCapacity = 4u * 1024u * 1024u;
+
+    //! \brief Allocate the memory of the arena (the only malloc).
+    //! \param[in] capacity size of the arena in bytes.
+    explicit Arena(const size_t capacity = DefaultCapacity)
+        : m_buffer(new uint8_t[capacity]), m_capacity(capacity)
+    {}
+
+    Arena(Arena const&) = delete;
+    Arena& operator=(Arena const&) = delete;
+
+    //! \brief Return the arena of the calling thread. Its memory is allocated
+    //! the first time the thread calls this method.
+    static Arena& local()
+    {
+        thread_local Arena arena;
+        return arena;
+    }
+
+    //! \brief Construct an object inside the arena.
+    //! \throw std::string if the arena has not enough free memory.
+    template<class T, class... Args>
+    T* create(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Destructors of objects of the arena are never called");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    //! \brief Allocate an array of default constructed objects inside the
+    //! arena.
+    //! \throw std::string if the arena has not enough free memory.
+    template<class T>
+    T* array(const size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Destructors of objects of the arena are never called");
+        return new (allocate(count * sizeof(T), alignof(T))) T[count]();
+    }
+
+    //! \brief Return the current position in the arena for releasing later
+    //! with rewind() all objects created after this call.
+    inline size_t mark() const { return m_used; }
+
+    //! \brief Release in O(1) all objects created since mark() was called.
+    inline void rewind(const size_t mark) { m_used = mark; }
+
+    //! \brief Release in O(1) all objects of the arena (ie between two games).
+    //! Counters are not reset.
+    inline void reset() { m_used = 0u; }
+
+    //! \brief Number of bytes currently used.
+    inline size_t used() const { return m_used; }
+
+    //! \brief Highest number of bytes used since the creation.
+    inline size_t peak() const { return m_peak; }
+
+    //! \brief Size of the arena in bytes.
+    inline size_t capacity() const { return m_capacity; }
+
+    //! \brief Number of objects created since the creation (for computing
+    //! the number of allocations per node of a search).
+    inline size_t allocations() const { return m_allocations; }
+
+private:
+
+    //! \brief Reserve aligned memory inside the arena.
+    void* allocate(const size_t bytes, const size_t alignment)
+    {
+        const size_t start = (m_used + alignment - 1u) & ~(alignment - 1u);
+        if (start + bytes > m_capacity)
+        {
+            throw std::string("Arena: not enough memory for allocating ")
+                + std::to_string(bytes) + " bytes";
+        }
+
+        m_used = start + bytes;
+        if (m_used > m_peak)
+            m_peak = m_used;
+        ++m_allocations;
+        return m_buffer.get() + start;
+    }
+
+private:
+
+    //! \brief Memory of the arena (aligned for any fundamental type).
+    std::unique_ptr<uint8_t[]> m_buffer;
+    //! \brief Size of m_buffer in bytes.
+    size_t m_capacity;
+    //! \brief Number of bytes used in m_buffer.
+    size_t m_used = 0u;
+    //! \brief Highest value of m_used.
+    size_t m_peak = 0u;
+    //! \brief Number of objects created.
+    size_t m_allocations = 0u;
+};
+
+// *****************************************************************************
+//! \brief Release when leaving the scope all objects created in the arena
+//! inside this scope.
+// *****************************************************************************
+class ArenaScope
+{
+public:
+
+    explicit ArenaScope(Arena& arena)
+        : m_arena(arena), m_mark(arena.mark())
+    {}
+
+    ~ArenaScope()
+    {
+        m_arena.rewind(m_mark);
+    }
+
+    ArenaScope(ArenaScope const&) = delete;
+    ArenaScope& operator=(ArenaScope const&) = delete;
+
+private:
+
+    Arena& m_arena;
+    const size_t m_mark;
+};
+
+#endif
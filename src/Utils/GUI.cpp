@@ -24,7 +24,8 @@
 Application::Application()
 {
     m_window.create(sf::VideoMode(504, 504), "ChessNeuNeu");
-    //m_window.setFramerateLimit(10);
+    // Sleep between frames instead of rendering as fast as possible
+    m_window.setFramerateLimit(60);
 }
 
 Application::~Application()
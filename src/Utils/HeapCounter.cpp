@@ -0,0 +1,105 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "HeapCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+//! \brief Counter of calls to the global operator new.
+static std::atomic<uint64_t> s_allocations{0u};
+
+//------------------------------------------------------------------------------
+uint64_t heapAllocations()
+{
+    return s_allocations.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+//! \brief Common part of the replaced operators new.
+static void* allocate(std::size_t size) noexcept
+{
+    s_allocations.fetch_add(1u, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1u);
+}
+
+//------------------------------------------------------------------------------
+void* operator new(std::size_t size)
+{
+    if (void* p = allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+//------------------------------------------------------------------------------
+void* operator new[](std::size_t size)
+{
+    if (void* p = allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+//------------------------------------------------------------------------------
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    return allocate(size);
+}
+
+//------------------------------------------------------------------------------
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+    return allocate(size);
+}
+
+//------------------------------------------------------------------------------
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+//------------------------------------------------------------------------------
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+//------------------------------------------------------------------------------
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+//------------------------------------------------------------------------------
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+//------------------------------------------------------------------------------
+void operator delete(void* p, std::nothrow_t const&) noexcept
+{
+    std::free(p);
+}
+
+//------------------------------------------------------------------------------
+void operator delete[](void* p, std::nothrow_t const&) noexcept
+{
+    std::free(p);
+}
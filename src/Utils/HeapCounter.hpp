@@ -0,0 +1,32 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef HEAP_COUNTER_HPP
+#  define HEAP_COUNTER_HPP
+
+#  include <cstdint>
+
+//! \brief Number of calls to the global operator new (all threads) since the
+//! start of the program. HeapCounter.cpp replaces the global operator new and
+//! operator delete by malloc and free counting the allocations: benchmarks
+//! and unit tests check with it that hot paths make no allocation per node.
+uint64_t heapAllocations();
+
+#endif
@@ -20,16 +20,43 @@
 
 #include "IPC.hpp"
 #include <fcntl.h>
+#include <poll.h>
+#include <chrono>
 #include <iostream>
 #include <vector>
 #include <stdexcept>
 #include <stdio.h>
 #include <string.h>
 
+void Latency::record(const double seconds)
+{
+    ++count;
+    last = seconds;
+    total += seconds;
+    if (seconds > max)
+        max = seconds;
+}
+
+std::ostream& operator<<(std::ostream& os, Latency const& latency)
+{
+    return os << "round trips: " << latency.count
+              << ", mean: " << latency.mean() * 1000.0 << " ms"
+              << ", max: " << latency.max * 1000.0 << " ms";
+}
+
 IPC::IPC(std::string const& command)
 {
+    // Created before starting the process: the destructor is not called when
+    // the constructor throws, so nothing shall be running then.
+    if (pipe2(m_wakeup, O_CLOEXEC | O_NONBLOCK))
+    {
+        throw std::invalid_argument("Failed Creating the wake up pipe");
+    }
+
     if (!open(command))
     {
+        ::close(m_wakeup[0]);
+        ::close(m_wakeup[1]);
         throw std::invalid_argument("Failed Creating bidirectional pipe");
     }
 }
@@ -43,7 +70,6 @@ bool IPC::open(std::string const& command)
 {
     std::cout << "Opening IPC with " << command
               << " ..." << std::endl;
-    int status;
     int wpipe[2];
     int rpipe[2];
 
@@ -54,9 +80,18 @@ bool IPC::open(std::string const& command)
 
     //fflush(stdout);
 
-    if (pipe(wpipe) || pipe(rpipe))
+    // Close-on-exec: other processes started concurrently shall not inherit
+    // our pipes else the process would never read the end of its stdin.
+    if (pipe2(wpipe, O_CLOEXEC))
+    {
+        std::cerr << "Pipe creation failed" << std::endl;
+        return false;
+    }
+    if (pipe2(rpipe, O_CLOEXEC))
     {
         std::cerr << "Pipe creation failed" << std::endl;
+        ::close(wpipe[0]);
+        ::close(wpipe[1]);
         return false;
     }
 
@@ -73,6 +108,9 @@ bool IPC::open(std::string const& command)
         return false;
 
     case 0: // child
+        // The caller may be multithreaded (engines started concurrently):
+        // only async-signal-safe functions until exec (no iostream, no
+        // malloc).
         dup2(wpipe[0], STDIN_FILENO);
         dup2(rpipe[1], STDOUT_FILENO);
 
@@ -81,31 +119,16 @@ bool IPC::open(std::string const& command)
 
         // Ask kernel to deliver SIGTERM in case the parent dies
         //prctl(PR_SET_PDEATHSIG, SIGTERM);
-        if (execvp(command.c_str(), argc.data()) == -1)
+        execvp(argc[0], argc.data());
         {
-            std::cerr << "execl failed. Reason: "
-                      << strerror(errno) << std::endl;
+            static const char error[] = "IPC: execvp failed\n";
+            const ssize_t written = ::write(STDERR_FILENO, error, sizeof(error) - 1u);
+            (void) written;
         }
 
-        // Check if child succeed
-        m_pid = wait(&status);
-        if (WIFEXITED(status))
-        {
-            std::cerr << "PID " << m_pid << " exited with status "
-                      << WEXITSTATUS(status) << std::endl;
-            return false;
-        }
-        else
-        {
-            std::cerr << "PID " << m_pid << " exited abnormally"
-                      << std::endl;
-            return false;
-        }
-
-        // FIXME never preinted
-        std::cerr << "Child forked process eneded" << std::endl;
-        exit(1);
-        break;
+        // Never return in the forked copy of the caller: it would continue
+        // running the caller code (ie other game threads).
+        _exit(127);
 
     default: // Parent
         std::cout << "PID created " << m_pid << std::endl;
@@ -113,6 +136,10 @@ bool IPC::open(std::string const& command)
         ::close(wpipe[0]);
         ::close(rpipe[1]);
 
+        // Writing to a crashed process shall fail with EPIPE instead of
+        // killing us
+        signal(SIGPIPE, SIG_IGN);
+
         // Force to non-blocking read
         int flags = fcntl(rpipe[0], F_GETFL, 0);
         int retval = fcntl(rpipe[0], F_SETFL, flags | O_NONBLOCK);
@@ -134,11 +161,22 @@ void IPC::close()
 
     ::close(m_wfd);
     ::close(m_rfd);
+    if (m_wakeup[0] >= 0)
+    {
+        ::close(m_wakeup[0]);
+        ::close(m_wakeup[1]);
+    }
     do {
         p = waitpid(m_pid, &status, 0);
     } while (p == -1 && errno == EINTR);
 }
 
+bool IPC::running()
+{
+    int status;
+    return waitpid(m_pid, &status, WNOHANG) == 0;
+}
+
 int IPC::write(std::string const& msg)
 {
     return ::write(m_wfd, msg.c_str(), msg.size());
@@ -174,3 +212,99 @@ bool IPC::read(std::string& msg)
     // Read at least one char ?
     return (nb >= 0);
 }
+
+void IPC::interrupt()
+{
+    const char c = '!';
+    if (::write(m_wakeup[1], &c, 1) < 0)
+    {
+        // Pipe full: a wake up is already pending
+    }
+}
+
+void IPC::clearInterrupt()
+{
+    char buffer[64];
+    while (::read(m_wakeup[0], buffer, sizeof(buffer)) > 0)
+        ;
+}
+
+bool IPC::dispatchLines(LineHandler const& handler)
+{
+    size_t start = 0u;
+    size_t end;
+    bool done = false;
+
+    while (!done && ((end = m_buffer.find('\n', start)) != std::string::npos))
+    {
+        size_t length = end - start;
+        if ((length > 0u) && (m_buffer[end - 1u] == '\r'))
+            --length;
+        done = handler(m_buffer.substr(start, length));
+        start = end + 1u;
+    }
+
+    m_buffer.erase(0u, start);
+    return done;
+}
+
+IPC::ReadStatus IPC::readLines(LineHandler const& handler, const int timeout_ms)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+    char buffer[4096];
+
+    // Lines received by a previous call
+    if (dispatchLines(handler))
+        return ReadStatus::Done;
+
+    while (true)
+    {
+        int timeout = -1;
+        if (timeout_ms >= 0)
+        {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - Clock::now()).count();
+            if (remaining <= 0)
+                return ReadStatus::Timeout;
+            timeout = int(remaining);
+        }
+
+        struct pollfd fds[2] = { { m_rfd, POLLIN, 0 }, { m_wakeup[0], POLLIN, 0 } };
+        const int ready = poll(fds, 2, timeout);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "IPC: poll failed: " << strerror(errno) << std::endl;
+            return ReadStatus::Error;
+        }
+        if (ready == 0)
+            return ReadStatus::Timeout;
+
+        // Woken up by interrupt()
+        if (fds[1].revents & POLLIN)
+        {
+            clearInterrupt();
+            return ReadStatus::Interrupted;
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            const ssize_t nb = ::read(m_rfd, buffer, sizeof(buffer));
+            if (nb == 0)
+                return ReadStatus::Closed;
+            if (nb < 0)
+            {
+                if ((errno == EWOULDBLOCK) || (errno == EAGAIN) || (errno == EINTR))
+                    continue;
+                std::cerr << "IPC: Failed reading in pipe" << std::endl;
+                return ReadStatus::Error;
+            }
+
+            m_buffer.append(buffer, size_t(nb));
+            if (dispatchLines(handler))
+                return ReadStatus::Done;
+        }
+    }
+}
@@ -26,8 +26,35 @@
 //#  include <sys/prctl.h>
 #  include <signal.h>
 #  include <stdlib.h>
+#  include <functional>
+#  include <iosfwd>
 #  include <string>
 
+// *****************************************************************************
+//! \brief Statistics of the round-trip latency between sending a request to
+//! the external process and receiving its answer (ie "go" -> "bestmove").
+// *****************************************************************************
+struct Latency
+{
+    //! \brief Add the duration of a round trip.
+    void record(const double seconds);
+
+    //! \brief Mean duration of a round trip in seconds.
+    double mean() const { return (count == 0u) ? 0.0 : total / double(count); }
+
+    //! \brief Number of round trips.
+    size_t count = 0u;
+    //! \brief Duration of the last round trip in seconds.
+    double last = 0.0;
+    //! \brief Longest round trip in seconds.
+    double max = 0.0;
+    //! \brief Cumulated duration of round trips in seconds.
+    double total = 0.0;
+};
+
+//! \brief Print the latency statistics (in milliseconds).
+std::ostream& operator<<(std::ostream& os, Latency const& latency);
+
 // *****************************************************************************
 //! \brief Implement a generic bidirectional Inter Process Communication (IPC)
 //! link based on Linux pipes. This allows two processes to talk (requests and
@@ -52,6 +79,36 @@ public:
     //! \brief Receive a message from the external process.
     bool read(std::string& msg);
 
+    //! \brief Default max duration (in milliseconds) for waiting the answer of
+    //! the external process.
+    static constexpr int ReadTimeout = 60000;
+
+    //! \brief Callback receiving a complete line sent by the external process
+    //! (without the end of line).
+    //! \return true when the awaited line has been received (stop reading).
+    using LineHandler = std::function<bool(std::string const& line)>;
+
+    //! \brief Outcome of readLines().
+    enum class ReadStatus { Done, Timeout, Interrupted, Closed, Error };
+
+    //! \brief Sleep in poll() until the external process sends data, and give
+    //! each complete line to the handler until it returns true. Incomplete
+    //! lines and lines following the awaited one are kept for the next call.
+    //! \param[in] timeout_ms max duration of the wait in milliseconds (negative
+    //! for no limit).
+    //! \return ReadStatus::Done when the handler returned true,
+    //! ReadStatus::Interrupted when interrupt() has been called.
+    ReadStatus readLines(LineHandler const& handler, const int timeout_ms);
+
+    //! \brief Wake up readLines() from another thread (ie for aborting).
+    void interrupt();
+
+    //! \brief Forget calls to interrupt() not yet seen by readLines().
+    void clearInterrupt();
+
+    //! \brief Check if the external process has not exited (or crashed).
+    bool running();
+
     //! \brief Return the PID of the process in communication
     inline int pid() const { return m_pid; }
 
@@ -60,9 +117,16 @@ private:
     bool open(std::string const& command);
     void close();
 
+    //! \brief Give the complete lines of m_buffer to the handler.
+    bool dispatchLines(LineHandler const& handler);
+
     pid_t m_pid;
     int m_wfd;
     int m_rfd;
+    //! \brief Self-pipe waking up poll() on interrupt().
+    int m_wakeup[2] = { -1, -1 };
+    //! \brief Data received but not yet given to a LineHandler.
+    std::string m_buffer;
 };
 
 #endif
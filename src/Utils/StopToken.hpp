@@ -0,0 +1,50 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#ifndef STOP_TOKEN_HPP
+#  define STOP_TOKEN_HPP
+
+#  include <atomic>
+
+// *****************************************************************************
+//! \brief Request of halting a computation running in another thread (search,
+//! training, waiting for an external engine). The computation polls
+//! requested() at its own pace. The request persists until reset() so that a
+//! computation started after the request also halts.
+// *****************************************************************************
+class StopToken
+{
+public:
+
+    //! \brief Ask the computation to halt (can be called from any thread).
+    inline void request() { m_stop.store(true, std::memory_order_release); }
+
+    //! \brief Cancel request() before starting a new computation.
+    inline void reset() { m_stop.store(false, std::memory_order_release); }
+
+    //! \brief Has the computation been asked to halt ?
+    inline bool requested() const { return m_stop.load(std::memory_order_acquire); }
+
+private:
+
+    std::atomic<bool> m_stop{false};
+};
+
+#endif
@@ -20,48 +20,31 @@
 
 #include "main.hpp"
 #include "GUI/Board.hpp"
-#include "Players/Stockfish.hpp"
-#include "Players/TSCP.hpp"
-#include "Players/Loki.hpp"
+#include "Players/PlayerFactory.hpp"
 #include "Players/NeuNeu.hpp"
-#include "Players/Human.hpp"
+#include "Chess/Perft.hpp"
+#include "Match/Tournament.hpp"
+#include "Match/UciServer.hpp"
+#include <sstream>
 
 // -----------------------------------------------------------------------------
 void ChessNeuNeu::createPlayer(const PlayerType type, const Color side)
 {
-    switch (type)
-    {
-    case PlayerType::StockfishIA:
-        m_players[side] = std::make_shared<Stockfish>(m_rules, side, m_fen);
-        break;
-    case PlayerType::TscpIA:
-        m_players[side] = std::make_shared<Tscp>(m_rules, side);
-        break;
-    case PlayerType::LokiIA:
-        m_players[side] = std::make_shared<Loki>(m_rules, side);
-        break;
-    case PlayerType::NeuNeuIA:
-        m_players[side] = std::make_shared<NeuNeu>(m_rules, side);
-        break;
-    case PlayerType::HumanPlayer:
-        m_players[side] = std::make_shared<Human>(m_rules, side);
-        break;
-    default:
-        throw std::string("createPlayer: Unknown PlayerType");
-        break;
-    }
+    m_players[side] = ::createPlayer(type, m_rules, side, m_fen, m_alphabeta);
 }
 
 // -----------------------------------------------------------------------------
-ChessNeuNeu::ChessNeuNeu(const PlayerType white, const PlayerType black, std::string const& fen)
-    : m_resources("figures.png", "board.png"), m_fen(fen), m_rules(fen)
+ChessNeuNeu::ChessNeuNeu(const PlayerType white, const PlayerType black, std::string const& fen,
+                         AlphaBetaOptions const& options)
+    : m_resources("figures.png", "board.png"), m_fen(fen), m_alphabeta(options), m_rules(fen)
 {
     init(white, black);
 }
 
 // -----------------------------------------------------------------------------
-ChessNeuNeu::ChessNeuNeu(const PlayerType white, const PlayerType black)
-    : m_resources("figures.png", "board.png")
+ChessNeuNeu::ChessNeuNeu(const PlayerType white, const PlayerType black,
+                         AlphaBetaOptions const& options)
+    : m_resources("figures.png", "board.png"), m_alphabeta(options)
 {
     init(white, black);
 }
@@ -122,9 +105,36 @@ int main(int argc, char** argv)
     // Help/Usage
     if (getCmdOption(argc, argv, "-h", "--help") != "")
     {
-        std::cout << "Usage:\n  " << argv[0] << " --white NAME --black NAME [--fen FEN]\n"
-                  << "With:\n  NAME: human | stockfish | loki | tcsp | neuneu\n"
-                  << "  FEN: Optional oard position in Forsyth-Edwards notation. See https://lichess.org/editor\n";
+        std::cout << "Usage:\n  " << argv[0] << " --white NAME --black NAME [--fen FEN] [--movetime MS] [--depth DEPTH] [--nodes NODES]\n"
+                  << "          [--time MS --inc MS] [--threads N] [--hash MB]\n"
+                  << "  " << argv[0] << " --selfplay GAMES --white NAME --black NAME [--fen FEN] [--movetime MS]\n"
+                  << "          [--depth DEPTH] [--nodes NODES] [--threads N] [--hash MB]\n"
+                  << "  " << argv[0] << " --tournament FORMAT --players NAME,NAME[,NAME...] [--rounds ROUNDS]\n"
+                  << "          [--openings FILE] [--workers N] [--movetime MS] [--depth DEPTH] [--nodes NODES]\n"
+                  << "          [--threads N] [--hash MB]\n"
+                  << "  " << argv[0] << " --uci [NAME] [--threads N] [--hash MB]\n"
+                  << "  " << argv[0] << " --perft DEPTH [--fen FEN] [--threads N] [--hash MB]\n"
+                  << "  " << argv[0] << " --benchmark [--threads N]\n"
+                  << "  " << argv[0] << " --search-benchmark [--threads N] [--depth DEPTH]\n"
+                  << "  " << argv[0] << " --neuneu-benchmark\n"
+                  << "With:\n  NAME: human | stockfish | loki | tcsp | neuneu | alphabeta\n"
+                  << "        (--uci: the engine answering UCI commands on stdin/stdout, default: neuneu)\n"
+                  << "  GAMES: Number of headless games (no GUI) between two engines\n"
+                  << "  FORMAT: roundrobin (everyone against everyone) | gauntlet (the first player against\n"
+                  << "          the others)\n"
+                  << "  ROUNDS: Number of pairs of games (swapped colors) of each pairing for each opening\n"
+                  << "  FILE: File of openings in Forsyth-Edwards notation (one by line)\n"
+                  << "  FEN: Optional oard position in Forsyth-Edwards notation. See https://lichess.org/editor\n"
+                  << "  MS: Max duration in milliseconds of the alphabeta search of a move (default: 1000)\n"
+                  << "  DEPTH: Number of plies of the performance test of the move generator or max\n"
+                  << "         depth of the alphabeta search\n"
+                  << "  NODES: Max number of nodes of the alphabeta search of a move\n"
+                  << "  --time, --inc: Clock of each side and increment per move in milliseconds given\n"
+                  << "         to UCI engines (stockfish, loki)\n"
+                  << "  N: Number of threads of perft or of the alphabeta search, or number of games\n"
+                  << "     played concurrently by a tournament (0 for all cores)\n"
+                  << "  MB: Size in mega bytes of the perft hash table (default: 0 for none) or of the\n"
+                  << "      alphabeta transposition table (default: 16)\n";
         return EXIT_SUCCESS;
     }
 
@@ -132,9 +142,185 @@ int main(int argc, char** argv)
     std::string w(getCmdOption(argc, argv, "-w", "--white"));
     std::string b(getCmdOption(argc, argv, "-b", "--black"));
     std::string fen(getCmdOption(argc, argv, "-f", "--fen"));
+    std::string perft_depth(getCmdOption(argc, argv, "-p", "--perft"));
+    bool bench = (getCmdOption(argc, argv, "--benchmark", "--benchmark") != "");
+    bool search_bench = (getCmdOption(argc, argv, "--search-benchmark", "--search-benchmark") != "");
+    bool neuneu_bench = (getCmdOption(argc, argv, "--neuneu-benchmark", "--neuneu-benchmark") != "");
+    std::string threads(getCmdOption(argc, argv, "-t", "--threads"));
+    std::string hash(getCmdOption(argc, argv, "--hash", "--hash"));
+    std::string movetime(getCmdOption(argc, argv, "--movetime", "--movetime"));
+    std::string search_depth(getCmdOption(argc, argv, "--depth", "--depth"));
+    std::string nodes(getCmdOption(argc, argv, "--nodes", "--nodes"));
+    std::string clock_time(getCmdOption(argc, argv, "--time", "--time"));
+    std::string clock_inc(getCmdOption(argc, argv, "--inc", "--inc"));
+    std::string selfplay(getCmdOption(argc, argv, "--selfplay", "--selfplay"));
+    std::string tournament(getCmdOption(argc, argv, "--tournament", "--tournament"));
+    std::string players(getCmdOption(argc, argv, "--players", "--players"));
+    std::string rounds(getCmdOption(argc, argv, "--rounds", "--rounds"));
+    std::string openings(getCmdOption(argc, argv, "--openings", "--openings"));
+    std::string workers(getCmdOption(argc, argv, "--workers", "--workers"));
+    std::string uci(getCmdOption(argc, argv, "--uci", "--uci"));
 
     try
     {
+        // Headless modes: count the nodes of the tree of legal moves (no GUI)
+        int nb_threads = threads.empty() ? ((bench || search_bench) ? 0 : 1) : std::stoi(threads);
+        if (nb_threads < 0)
+            throw std::string("Invalid number of threads: ") + threads;
+
+        if (bench)
+        {
+            return benchmark(std::cout, unsigned(nb_threads)) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        if (search_bench)
+        {
+            int depth = search_depth.empty() ? 7 : std::stoi(search_depth);
+            if ((depth <= 0) || (depth >= int(MaxSearchPlies)))
+                throw std::string("Invalid search depth: ") + search_depth;
+
+            searchBenchmark(std::cout, unsigned(nb_threads), uint8_t(depth));
+            return EXIT_SUCCESS;
+        }
+        if (neuneu_bench)
+        {
+            Rules rules;
+            NeuNeu(rules, Color::White).benchmark(std::cout);
+            return EXIT_SUCCESS;
+        }
+        if (!perft_depth.empty())
+        {
+            int depth = std::stoi(perft_depth);
+            if ((depth <= 0) || (depth > 255))
+                throw std::string("Invalid perft depth: ") + perft_depth;
+
+            int hash_mb = hash.empty() ? 0 : std::stoi(hash);
+            if (hash_mb < 0)
+                throw std::string("Invalid hash size: ") + hash;
+
+            Rules rules;
+            if (!fen.empty() && !rules.load(fen))
+                throw std::string("Invalid FEN: ") + fen;
+
+            divide(rules, uint8_t(depth), std::cout, unsigned(nb_threads), size_t(hash_mb));
+            return EXIT_SUCCESS;
+        }
+
+        // Settings of the native alphabeta player
+        AlphaBetaOptions options;
+        options.threads = unsigned(nb_threads);
+        if (!hash.empty())
+        {
+            const int hash_mb = std::stoi(hash);
+            if (hash_mb < 0)
+                throw std::string("Invalid hash size: ") + hash;
+            options.hash_mb = size_t(hash_mb);
+        }
+        options.limits.movetime = clock_time.empty() ? 1000u : 0u;
+        if (!movetime.empty())
+        {
+            const long ms = std::stol(movetime);
+            if (ms < 0)
+                throw std::string("Invalid movetime: ") + movetime;
+            options.limits.movetime = uint32_t(ms);
+        }
+        if (!search_depth.empty())
+        {
+            const int depth = std::stoi(search_depth);
+            if ((depth <= 0) || (depth >= int(MaxSearchPlies)))
+                throw std::string("Invalid search depth: ") + search_depth;
+            options.limits.depth = uint8_t(depth);
+        }
+        if (!nodes.empty())
+        {
+            const long long n = std::stoll(nodes);
+            if (n < 0)
+                throw std::string("Invalid number of nodes: ") + nodes;
+            options.limits.nodes = uint64_t(n);
+        }
+        if (!clock_time.empty())
+        {
+            const long ms = std::stol(clock_time);
+            if (ms < 0)
+                throw std::string("Invalid clock time: ") + clock_time;
+            options.limits.time = uint32_t(ms);
+        }
+        if (!clock_inc.empty())
+        {
+            const long ms = std::stol(clock_inc);
+            if (ms < 0)
+                throw std::string("Invalid clock increment: ") + clock_inc;
+            options.limits.inc = uint32_t(ms);
+        }
+
+        // Be driven by a chess GUI or a tournament manager: UCI on stdin and
+        // stdout. The search budget is given by each "go" command.
+        if (!uci.empty())
+        {
+            options.limits = SearchLimits();
+            PlayerType type = playerType(((uci[0] != '-') ? uci : "neuneu"));
+
+            // Only UCI answers are written on stdout: messages of players go
+            // to stderr
+            std::ostream protocol(std::cout.rdbuf());
+            std::streambuf* console = std::cout.rdbuf(std::cerr.rdbuf());
+            UciServer(type, options, std::cin, protocol).run();
+            std::cout.rdbuf(console);
+            return EXIT_SUCCESS;
+        }
+
+        // Headless games between two engines (no GUI)
+        if (!selfplay.empty())
+        {
+            const long long games = std::stoll(selfplay);
+            if (games <= 0)
+                throw std::string("Invalid number of games: ") + selfplay;
+
+            PlayerType Whites = playerType(w != "" ? w : "alphabeta");
+            PlayerType Blacks = playerType(b != "" ? b : "alphabeta");
+            return selfPlay(std::cout, size_t(games), Whites, Blacks, fen, options)
+                    ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        // Headless games between several engines played concurrently
+        if (!tournament.empty())
+        {
+            TournamentOptions settings;
+            settings.alphabeta = options;
+            if (tournament == "roundrobin")
+                settings.pairing = Pairing::RoundRobin;
+            else if (tournament == "gauntlet")
+                settings.pairing = Pairing::Gauntlet;
+            else
+                throw std::string("Invalid tournament format: ") + tournament;
+
+            std::istringstream iss(players);
+            std::string name;
+            while (std::getline(iss, name, ','))
+            {
+                settings.players.push_back(playerType(name));
+            }
+            if (!rounds.empty())
+            {
+                const long long n = std::stoll(rounds);
+                if (n <= 0)
+                    throw std::string("Invalid number of rounds: ") + rounds;
+                settings.rounds = size_t(n);
+            }
+            if (!workers.empty())
+            {
+                const int n = std::stoi(workers);
+                if (n < 0)
+                    throw std::string("Invalid number of workers: ") + workers;
+                settings.workers = unsigned(n);
+            }
+            if (!openings.empty())
+                settings.openings = loadOpenings(openings);
+            else if (!fen.empty())
+                settings.openings = { fen };
+
+            return Tournament(settings).run(std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
         std::unique_ptr<ChessNeuNeu> chess;
 
         // Get Player types from command-line options --white and --black.
@@ -146,11 +332,11 @@ int main(int argc, char** argv)
         // comand-line --fen (Forsyth-Edwards notation).
         if (fen.empty())
         {
-            chess = std::make_unique<ChessNeuNeu>(Whites, Blacks);
+            chess = std::make_unique<ChessNeuNeu>(Whites, Blacks, options);
         }
         else
         {
-            chess = std::make_unique<ChessNeuNeu>(Whites, Blacks, fen);
+            chess = std::make_unique<ChessNeuNeu>(Whites, Blacks, fen, options);
         }
 
         // Launch the GUI thread which will also start the game logic thread
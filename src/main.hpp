@@ -24,6 +24,7 @@
 #  include "GUI/Resources.hpp"
 #  include "Utils/GUI.hpp"
 #  include "Players/Player.hpp"
+#  include "Players/AlphaBeta.hpp"
 #  include <memory>
 
 // *****************************************************************************
@@ -36,13 +37,16 @@ class ChessNeuNeu : public Application
 public:
 
     //! \brief Constructor. Start with initial board and white to play.
-    ChessNeuNeu(const PlayerType Whites, const PlayerType Blacks);
+    //! \param options: settings of the native alphabeta player.
+    ChessNeuNeu(const PlayerType Whites, const PlayerType Blacks,
+                AlphaBetaOptions const& options = AlphaBetaOptions());
 
     //! \brief Constructor. Start with a given board using the Forsyth-Edwards
     //! notation.
     //! \param fen: the board using the Forsyth-Edwards notation.
     //! You can use this site https://lichess.org/editor for generating FEN strings.
-    ChessNeuNeu(const PlayerType Whites, const PlayerType Blacks, std::string const& fen);
+    ChessNeuNeu(const PlayerType Whites, const PlayerType Blacks, std::string const& fen,
+                AlphaBetaOptions const& options = AlphaBetaOptions());
 
     //! \brief Return the main GUI (board)
     GUI& gui() { return *m_gui_board; }
@@ -65,6 +69,9 @@ public:
     //! will be used for Stockfish.
     std::string m_fen;
 
+    //! \brief Settings of the native alphabeta player.
+    AlphaBetaOptions m_alphabeta;
+
     //! \the Chess referee and game states.
     Rules m_rules;
 
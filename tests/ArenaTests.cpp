@@ -0,0 +1,158 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Utils/Arena.hpp"
+#include "Utils/HeapCounter.hpp"
+#include "Chess/MoveGenerator.hpp"
+#include "Chess/Perft.hpp"
+#include "Chess/Search.hpp"
+#include "Players/NeuNeu.hpp"
+
+//------------------------------------------------------------------------------
+TEST(Arena, Allocations)
+{
+    // The only allocation on the heap
+    const uint64_t heap = heapAllocations();
+    Arena arena(1024u);
+    ASSERT_EQ(heap + 1u, heapAllocations());
+    ASSERT_EQ(1024u, arena.capacity());
+    ASSERT_EQ(0u, arena.used());
+    ASSERT_EQ(0u, arena.allocations());
+
+    uint8_t* c = arena.create<uint8_t>(uint8_t(42u));
+    ASSERT_EQ(42u, *c);
+    ASSERT_EQ(1u, arena.used());
+
+    // Objects are aligned
+    uint64_t* u = arena.create<uint64_t>(0x1234u);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(u) % alignof(uint64_t));
+    ASSERT_EQ(0x1234u, *u);
+    ASSERT_EQ(16u, arena.used());
+
+    // Arrays are value initialized
+    uint32_t* values = arena.array<uint32_t>(10u);
+    for (size_t i = 0u; i < 10u; ++i)
+    {
+        ASSERT_EQ(0u, values[i]);
+    }
+    ASSERT_EQ(56u, arena.used());
+    ASSERT_EQ(3u, arena.allocations());
+
+    // Release objects created after the mark
+    const size_t mark = arena.mark();
+    {
+        ArenaScope scope(arena);
+        arena.array<uint8_t>(100u);
+        ASSERT_EQ(156u, arena.used());
+    }
+    ASSERT_EQ(mark, arena.used());
+    ASSERT_EQ(156u, arena.peak());
+
+    // Not enough memory
+    ASSERT_THROW(arena.array<uint8_t>(2000u), std::string);
+    ASSERT_EQ(mark, arena.used());
+
+    // Reset in O(1): counters are kept
+    arena.reset();
+    ASSERT_EQ(0u, arena.used());
+    ASSERT_EQ(4u, arena.allocations());
+    ASSERT_EQ(156u, arena.peak());
+}
+
+//------------------------------------------------------------------------------
+TEST(Arena, Local)
+{
+    // One arena per thread
+    Arena& arena = Arena::local();
+    ASSERT_EQ(&arena, &Arena::local());
+    ASSERT_EQ(size_t(Arena::DefaultCapacity), arena.capacity());
+
+    ArenaScope scope(arena);
+    const size_t allocations = arena.allocations();
+    Rules& rules = *arena.create<Rules>();
+    ASSERT_EQ(20u, rules.m_legal_moves.size());
+    ASSERT_EQ(allocations + 1u, arena.allocations());
+    ASSERT_LE(sizeof(Rules), arena.used());
+}
+
+//------------------------------------------------------------------------------
+//! \brief Walk the tree of moves with the staged generator.
+static uint64_t walk(Rules& rules, const uint8_t depth)
+{
+    if (depth == 0u)
+        return 1u;
+
+    uint64_t nodes = 0u;
+    MoveGenerator generator(rules);
+    Move move;
+    while (generator.next(move))
+    {
+        rules.makeMove(move);
+        nodes += walk(rules, uint8_t(depth - 1u));
+        rules.unmakeMove();
+    }
+    return nodes;
+}
+
+//------------------------------------------------------------------------------
+TEST(Arena, NoHeapAllocationInHotPaths)
+{
+    Arena& arena = Arena::local();
+    ArenaScope scope(arena);
+    Rules& rules = *arena.create<Rules>(c_perft_suite[1].fen);
+
+    // Zero allocation per node for perft, the staged generator, make/unmake
+    // and status detection.
+    uint64_t before = heapAllocations();
+    ASSERT_EQ(c_perft_suite[1].nodes[2], perft(rules, 3u));
+    ASSERT_EQ(c_perft_suite[1].nodes[2], walk(rules, 3u));
+    ASSERT_EQ(Status::Playing, rules.computeStatus());
+    ASSERT_EQ(0u, heapAllocations() - before);
+
+    // Copies of positions in the arena
+    before = heapAllocations();
+    for (int i = 0; i < 100; ++i)
+    {
+        ArenaScope node(arena);
+        Rules& copy = *arena.create<Rules>(rules);
+        copy.makeMove(copy.m_legal_moves[0]);
+    }
+    ASSERT_EQ(0u, heapAllocations() - before);
+
+    // Alpha-beta search
+    TranspositionTable tt(1u);
+    Search search(tt);
+    SearchLimits limits;
+    limits.depth = 4u;
+    before = heapAllocations();
+    const SearchResult result = search.run(rules, limits);
+    ASSERT_EQ(0u, heapAllocations() - before);
+    ASSERT_TRUE(rules.isValidMove(toStrMove(result.move)));
+
+    // Training of the neural networks
+    Rules initial;
+    NeuNeu neuneu(initial, Color::White);
+    before = heapAllocations();
+    const std::string move = neuneu.play(SearchLimits());
+    ASSERT_EQ(0u, heapAllocations() - before);
+    ASSERT_TRUE(neuneu.trained());
+    ASSERT_TRUE(initial.isValidMove(move));
+}
@@ -0,0 +1,104 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Chess/Bitboard.hpp"
+
+//------------------------------------------------------------------------------
+TEST(Bitboard, Squares)
+{
+    ASSERT_EQ(1u, bit(sqA8));
+    ASSERT_EQ(sqA8, lsb(bit(sqA8) | bit(sqH1)));
+    ASSERT_EQ(sqH1, msb(bit(sqA8) | bit(sqH1)));
+    ASSERT_EQ(8, popCount(Bitboard::ColA));
+    ASSERT_EQ(8, popCount(Bitboard::Row1));
+    ASSERT_NE(0u, Bitboard::Row1 & bit(sqE1));
+    ASSERT_NE(0u, Bitboard::ColH & bit(sqH5));
+
+    bitboard b = bit(sqC3) | bit(sqE5);
+    ASSERT_EQ(sqE5, popLsb(b));
+    ASSERT_EQ(sqC3, popLsb(b));
+    ASSERT_EQ(0u, b);
+}
+
+//------------------------------------------------------------------------------
+TEST(Bitboard, LeaperAttacks)
+{
+    ASSERT_EQ(bit(sqB3) | bit(sqC2), knightAttacks(sqA1));
+    ASSERT_EQ(8, popCount(knightAttacks(sqE4)));
+    ASSERT_EQ(bit(sqG8) | bit(sqG7) | bit(sqH7), kingAttacks(sqH8));
+    ASSERT_EQ(8, popCount(kingAttacks(sqD5)));
+
+    ASSERT_EQ(bit(sqD3) | bit(sqF3), pawnAttacks(Color::White, sqE2));
+    ASSERT_EQ(bit(sqD6) | bit(sqF6), pawnAttacks(Color::Black, sqE7));
+    ASSERT_EQ(bit(sqB3), pawnAttacks(Color::White, sqA2));
+    ASSERT_EQ(bit(sqG6), pawnAttacks(Color::Black, sqH7));
+}
+
+//------------------------------------------------------------------------------
+TEST(Bitboard, SliderAttacks)
+{
+    // Empty chessboard
+    ASSERT_EQ(14, popCount(rookAttacks(sqD4, 0u)));
+    ASSERT_EQ(7, popCount(bishopAttacks(sqA1, 0u)));
+    ASSERT_EQ(13, popCount(bishopAttacks(sqD4, 0u)));
+    ASSERT_EQ(27, popCount(queenAttacks(sqD4, 0u)));
+
+    // Blockers are included in attacks but stop the slide
+    const bitboard occupancy = bit(sqD6) | bit(sqB4) | bit(sqF2);
+    const bitboard rook = rookAttacks(sqD4, occupancy);
+    ASSERT_NE(0u, rook & bit(sqD6));
+    ASSERT_EQ(0u, rook & bit(sqD7));
+    ASSERT_NE(0u, rook & bit(sqB4));
+    ASSERT_EQ(0u, rook & bit(sqA4));
+    ASSERT_NE(0u, rook & bit(sqD1));
+    ASSERT_NE(0u, rook & bit(sqH4));
+
+    const bitboard bishop = bishopAttacks(sqD4, occupancy);
+    ASSERT_NE(0u, bishop & bit(sqF2));
+    ASSERT_EQ(0u, bishop & bit(sqG1));
+    ASSERT_NE(0u, bishop & bit(sqA7));
+    ASSERT_NE(0u, bishop & bit(sqH8));
+}
+
+//------------------------------------------------------------------------------
+TEST(Bitboard, LoadAndAttackers)
+{
+    Bitboards bb;
+    bb.load(Chessboard::Init);
+
+    ASSERT_EQ(32, popCount(bb.occupied));
+    ASSERT_EQ(Bitboard::Row1 | (Bitboard::Row1 >> 8), bb.colors[Color::White]);
+    ASSERT_EQ(bit(sqE1), bb.pieces[Color::White][PieceType::King]);
+    ASSERT_EQ(bit(sqD8), bb.pieces[Color::Black][PieceType::Queen]);
+    ASSERT_EQ(8, popCount(bb.pieces[Color::Black][PieceType::Pawn]));
+
+    // F3 is defended by the pawns E2, G2 and the knight G1
+    ASSERT_EQ(bit(sqE2) | bit(sqG2) | bit(sqG1), bb.attackers(sqF3, Color::White, bb.occupied));
+    ASSERT_EQ(true, bb.attacked(sqF6, Color::Black));
+    ASSERT_EQ(false, bb.attacked(sqE4, Color::Black));
+
+    // Remove the pawn E2: the queen and the bishop can now reach E2
+    bb.remove(sqE2, WhitePawn);
+    ASSERT_EQ(bit(sqD1) | bit(sqE1) | bit(sqF1) | bit(sqG1),
+              bb.attackers(sqE2, Color::White, bb.occupied));
+    bb.add(sqE2, WhitePawn);
+    ASSERT_EQ(32, popCount(bb.occupied));
+}
@@ -0,0 +1,85 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Match/Game.hpp"
+
+//------------------------------------------------------------------------------
+static AlphaBetaOptions fastOptions()
+{
+    AlphaBetaOptions options;
+    options.limits.depth = 2u;
+    options.hash_mb = 1u;
+    options.verbose = false;
+    return options;
+}
+
+//------------------------------------------------------------------------------
+TEST(Game, Headless)
+{
+    // White mates in one
+    Game game(PlayerType::AlphaBetaIA, PlayerType::AlphaBetaIA,
+              "6k1/5ppp/8/8/8/8/8/R5K1 w - -", fastOptions());
+    GameResult result = game.play();
+    ASSERT_EQ(Status::WhiteWon, result.status);
+    ASSERT_EQ(1u, result.plies);
+    ASSERT_EQ("a1a8", result.moves);
+    ASSERT_STREQ("1-0", result.pgn());
+    ASSERT_EQ(1.0, result.whiteScore());
+    ASSERT_GT(result.thinking[Color::White], 0.0);
+    ASSERT_EQ(0.0, result.thinking[Color::Black]);
+    ASSERT_FALSE(result.failed());
+
+    // Kings alone
+    Game draw(PlayerType::AlphaBetaIA, PlayerType::AlphaBetaIA,
+              "4k3/8/8/8/8/8/8/4K3 w - -", fastOptions());
+    result = draw.play();
+    ASSERT_EQ(Status::InsufficientMaterial, result.status);
+    ASSERT_EQ(0u, result.plies);
+    ASSERT_STREQ("1/2-1/2", result.pgn());
+
+    // Adjudicated
+    Game longest(PlayerType::AlphaBetaIA, PlayerType::AlphaBetaIA, "", fastOptions());
+    result = longest.play(10u);
+    ASSERT_EQ(Status::Playing, result.status);
+    ASSERT_EQ(10u, result.plies);
+    ASSERT_EQ(0.5, result.whiteScore());
+    ASSERT_EQ(longest.rules().moves(), result.moves);
+}
+
+//------------------------------------------------------------------------------
+TEST(Game, Errors)
+{
+    ASSERT_THROW(Game(PlayerType::HumanPlayer, PlayerType::AlphaBetaIA, "", fastOptions()),
+                 std::string);
+    ASSERT_THROW(Game(PlayerType::AlphaBetaIA, PlayerType::AlphaBetaIA, "8/8/8/8 w - -", fastOptions()),
+                 std::string);
+}
+
+//------------------------------------------------------------------------------
+TEST(Game, SelfPlay)
+{
+    std::stringstream ss;
+    ASSERT_TRUE(selfPlay(ss, 2u, PlayerType::AlphaBetaIA, PlayerType::AlphaBetaIA,
+                         "6k1/5ppp/8/8/8/8/8/R5K1 w - -", fastOptions()));
+    ASSERT_NE(std::string::npos, ss.str().find("Game 2: 1-0 (White won) 1 plies"));
+    ASSERT_NE(std::string::npos, ss.str().find("+2 =0 -0 failed 0"));
+    ASSERT_NE(std::string::npos, ss.str().find("games/hour"));
+}
@@ -0,0 +1,87 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Utils/IPC.hpp"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+TEST(IPC, ReadLines)
+{
+    // cat echoes what we send to it
+    IPC ipc("cat");
+    std::vector<std::string> lines;
+    auto handler = [&lines](std::string const& line)
+    {
+        lines.push_back(line);
+        return line == "bestmove e2e4";
+    };
+
+    // Incomplete line is kept until its end of line is received
+    ipc.write("info depth 1\ninfo dep");
+    ASSERT_EQ(IPC::ReadStatus::Timeout, ipc.readLines(handler, 50));
+    ASSERT_EQ(1u, lines.size());
+    ASSERT_STREQ("info depth 1", lines[0].c_str());
+
+    // Lines following the awaited one are kept for the next call
+    ipc.write("th 2\r\nbestmove e2e4\nbestmove e7e5\n");
+    ASSERT_EQ(IPC::ReadStatus::Done, ipc.readLines(handler, 1000));
+    ASSERT_EQ(3u, lines.size());
+    ASSERT_STREQ("info depth 2", lines[1].c_str());
+    ASSERT_STREQ("bestmove e2e4", lines[2].c_str());
+
+    ASSERT_EQ(IPC::ReadStatus::Timeout, ipc.readLines(handler, 0));
+    ASSERT_EQ(4u, lines.size());
+    ASSERT_STREQ("bestmove e7e5", lines[3].c_str());
+}
+
+//------------------------------------------------------------------------------
+TEST(IPC, Interrupt)
+{
+    IPC ipc("cat");
+    auto handler = [](std::string const&) { return true; };
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread aborter([&ipc]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ipc.interrupt();
+    });
+    ASSERT_EQ(IPC::ReadStatus::Interrupted, ipc.readLines(handler, 10000));
+    aborter.join();
+
+    // Woken up long before the timeout
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    ASSERT_LT(elapsed, 5000);
+}
+
+//------------------------------------------------------------------------------
+TEST(IPC, UnknownCommand)
+{
+    // The forked process exits when the command cannot be executed
+    IPC ipc("/nonexistent/ChessNeuNeu-engine");
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (ipc.running() && (std::chrono::steady_clock::now() < end))
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_FALSE(ipc.running());
+}
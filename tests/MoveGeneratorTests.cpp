@@ -0,0 +1,118 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Chess/MoveGenerator.hpp"
+#include "Chess/Perft.hpp"
+
+//------------------------------------------------------------------------------
+//! \brief Is the move a capture or a promotion in the given position ?
+static bool isCapture(Rules const& rules, Move const& move)
+{
+    return (rules.m_board[move.to].type != PieceType::Empty) || move.ep() ||
+           (move.promote() != PieceType::Empty);
+}
+
+//------------------------------------------------------------------------------
+//! \brief Check staged moves against generateValidMoves() for the position and
+//! its children.
+static void checkStages(Rules& rules, const uint8_t depth)
+{
+    const MoveList legal = rules.generateValidMoves();
+
+    MoveList staged;
+    MoveGenerator generator(rules);
+    Move move;
+    bool quiets = false;
+    while (generator.next(move))
+    {
+        // Captures and promotions before quiet moves
+        const bool capture = isCapture(rules, move);
+        ASSERT_FALSE(capture && quiets) << move;
+        quiets = quiets || !capture;
+        staged.push_back(move);
+    }
+    ASSERT_FALSE(generator.next(move));
+
+    // Same moves than generateValidMoves()
+    ASSERT_EQ(legal.size(), staged.size());
+    for (auto const& m: legal)
+    {
+        ASSERT_NE(staged.end(), std::find(staged.begin(), staged.end(), m)) << m;
+    }
+    ASSERT_EQ(!legal.empty(), rules.hasAnyLegalMove());
+
+    // Only captures and promotions when quiet moves are not desired
+    MoveGenerator captures(rules, false);
+    size_t count = 0u;
+    while (captures.next(move))
+    {
+        ASSERT_TRUE(isCapture(rules, move)) << move;
+        ++count;
+    }
+    ASSERT_EQ(size_t(std::count_if(legal.begin(), legal.end(), [&](Move const& m)
+    {
+        return isCapture(rules, m);
+    })), count);
+
+    if (depth > 1u)
+    {
+        for (auto const& m: legal)
+        {
+            rules.makeMove(m);
+            checkStages(rules, uint8_t(depth - 1u));
+            rules.unmakeMove();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(MoveGenerator, Stages)
+{
+    for (auto const& position: c_perft_suite)
+    {
+        Rules rules(position.fen);
+        checkStages(rules, 2u);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(MoveGenerator, HasAnyLegalMove)
+{
+    Rules rules;
+    ASSERT_TRUE(rules.hasAnyLegalMove());
+
+    // Checkmate
+    ASSERT_TRUE(rules.load("R5k1/5ppp/8/8/8/8/8/6K1 b - -"));
+    ASSERT_FALSE(rules.hasAnyLegalMove());
+
+    // Stalemate
+    ASSERT_TRUE(rules.load("2k5/2P5/2K5/8/8/8/8/8 b - -"));
+    ASSERT_FALSE(rules.hasAnyLegalMove());
+
+    // Only legal move is a quiet King move while in check
+    ASSERT_TRUE(rules.load("k2r4/8/8/6b1/8/8/PPP5/2K5 w - -"));
+    MoveGenerator generator(rules);
+    Move move;
+    ASSERT_TRUE(generator.next(move));
+    ASSERT_EQ(Move("c1b1"), move);
+    ASSERT_FALSE(generator.next(move));
+    ASSERT_TRUE(rules.hasAnyLegalMove());
+}
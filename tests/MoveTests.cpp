@@ -0,0 +1,105 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Chess/Move.hpp"
+
+//------------------------------------------------------------------------------
+TEST(Move, Packing)
+{
+    ASSERT_EQ(2u, sizeof(Move));
+
+    Move m("e2e4");
+    ASSERT_EQ(sqE2, m.from);
+    ASSERT_EQ(sqE4, m.to);
+    ASSERT_EQ(PieceType::Empty, m.promote());
+    ASSERT_EQ(Castle::NoCastle, m.castle());
+    ASSERT_EQ(false, m.ep());
+    ASSERT_EQ(false, m.double_move());
+
+    ASSERT_EQ(true, PawnDoubleMove(sqE2, sqE4).double_move());
+    ASSERT_EQ(m, PawnDoubleMove(sqE2, sqE4));
+    ASSERT_EQ(true, PawnSimpleMove(sqD5, sqE6, true).ep());
+    ASSERT_EQ(Castle::Little, CastleMove(sqE1, sqG1, Castle::Little).castle());
+    ASSERT_EQ(Castle::Big, CastleMove(sqE8, sqC8, Castle::Big).castle());
+
+    for (int p = PieceType::Rook; p <= PieceType::Queen; ++p)
+    {
+        Move promote = PromoteMove(sqH7, sqH8, static_cast<PieceType>(p));
+        ASSERT_EQ(p, promote.promote());
+        ASSERT_EQ(Castle::NoCastle, promote.castle());
+        ASSERT_EQ(false, promote.ep());
+    }
+    ASSERT_EQ(PieceType::Knight, Move("h7h8n").promote());
+    ASSERT_EQ(PromoteMove(sqH7, sqH8, PieceType::Queen), Move("h7h8q"));
+    ASSERT_EQ(false, PromoteMove(sqH7, sqH8, PieceType::Queen) == Move("h7h8"));
+}
+
+//------------------------------------------------------------------------------
+TEST(Move, WellFormed)
+{
+    ASSERT_EQ(true, isWellFormed("e2e4"));
+    ASSERT_EQ(true, isWellFormed("a1h8"));
+    ASSERT_EQ(true, isWellFormed("h7h8q"));
+    ASSERT_EQ(true, isWellFormed("a2a1n"));
+
+    ASSERT_EQ(false, isWellFormed(""));
+    ASSERT_EQ(false, isWellFormed("e2"));
+    ASSERT_EQ(false, isWellFormed("e2e"));
+    ASSERT_EQ(false, isWellFormed("i1a1"));
+    ASSERT_EQ(false, isWellFormed("e0e4"));
+    ASSERT_EQ(false, isWellFormed("e2e9"));
+    ASSERT_EQ(false, isWellFormed("E2E4"));
+    ASSERT_EQ(false, isWellFormed("h7h8k"));
+    ASSERT_EQ(false, isWellFormed("h7h8qq"));
+    ASSERT_EQ(false, isWellFormed("0000"));
+}
+
+//------------------------------------------------------------------------------
+TEST(Move, MoveList)
+{
+    MoveList list;
+    ASSERT_EQ(true, list.empty());
+
+    list.push_back(Move("e2e4"));
+    list.push_back(Move("d2d4"));
+    ASSERT_EQ(2u, list.size());
+    ASSERT_EQ(Move("d2d4"), list[1]);
+
+    MoveList copy(list);
+    list.pop_back();
+    ASSERT_EQ(1u, list.size());
+    ASSERT_EQ(2u, copy.size());
+    ASSERT_EQ(Move("d2d4"), *(copy.end() - 1));
+
+    copy = list;
+    ASSERT_EQ(1u, copy.size());
+    ASSERT_EQ(Move("e2e4"), *copy.begin());
+
+    list.clear();
+    ASSERT_EQ(list.begin(), list.end());
+
+    // Never written past the end
+    for (uint16_t i = 0u; i < MaxMoves; ++i)
+        list.push_back(Move("e2e4"));
+    ASSERT_DEBUG_DEATH(list.push_back(Move("d2d4")), "MoveList is full");
+    ASSERT_EQ(MaxMoves, list.size());
+    ASSERT_EQ(Move("e2e4"), list[MaxMoves - 1u]);
+}
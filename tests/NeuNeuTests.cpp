@@ -0,0 +1,113 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Players/NeuNeu.hpp"
+#include <random>
+#include <sstream>
+
+//------------------------------------------------------------------------------
+//! \brief Fill the weights with random values.
+static void randomize(Synaps& synaps)
+{
+    std::mt19937 random(42u);
+    std::uniform_real_distribution<float> weight(0.0f, 1.0f);
+    for (auto& row: synaps.weights)
+    {
+        for (auto& w: row)
+            w = weight(random);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(NeuNeu, OneHotGather)
+{
+    std::unique_ptr<Synaps> synaps = std::make_unique<Synaps>();
+    randomize(*synaps);
+
+    float e[NbSquares] = { 0.0f };
+    float expected[NbSquares];
+    float q[NbSquares];
+    for (uint8_t from = 0u; from < NbSquares; ++from)
+    {
+        e[from] = 1.0f;
+        synapsProductScalar(*synaps, e, expected);
+        e[from] = 0.0f;
+
+        synapsGather(*synaps, from, q);
+        for (uint8_t i = 0u; i < NbSquares; ++i)
+        {
+            ASSERT_EQ(expected[i], q[i]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(NeuNeu, DenseProduct)
+{
+    std::unique_ptr<Synaps> synaps = std::make_unique<Synaps>();
+    randomize(*synaps);
+
+    float e[NbSquares];
+    for (uint8_t i = 0u; i < NbSquares; ++i)
+        e[i] = float(i % 3u) * 0.5f;
+
+    float expected[NbSquares];
+    float q[NbSquares];
+    synapsProductScalar(*synaps, e, expected);
+    synapsProduct(*synaps, e, q);
+    for (uint8_t i = 0u; i < NbSquares; ++i)
+    {
+        ASSERT_NEAR(expected[i], q[i], 1e-4f);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(NeuNeu, Normalize)
+{
+    float q[NbSquares];
+    for (uint8_t i = 0u; i < NbSquares; ++i)
+        q[i] = float(i);
+
+    synapsNormalize(q);
+    float sum = 0.0f;
+    for (uint8_t i = 0u; i < NbSquares; ++i)
+        sum += q[i];
+    ASSERT_NEAR(1.0f, sum, 1e-5f);
+    ASSERT_NEAR(63.0f / 2016.0f, q[63], 1e-6f);
+
+    // No division by 0
+    for (uint8_t i = 0u; i < NbSquares; ++i)
+        q[i] = 0.0f;
+    synapsNormalize(q);
+    ASSERT_EQ(0.0f, q[0]);
+}
+
+//------------------------------------------------------------------------------
+TEST(NeuNeu, Benchmark)
+{
+    Rules rules;
+    NeuNeu player(rules, Color::White);
+    std::ostringstream os;
+    player.benchmark(os, 1000u);
+    ASSERT_TRUE(player.trained());
+    ASSERT_NE(std::string::npos, os.str().find(synapsInstructionSet()));
+    ASSERT_NE(std::string::npos, os.str().find("Black Pawn"));
+}
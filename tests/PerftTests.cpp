@@ -0,0 +1,104 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Chess/Perft.hpp"
+#include <sstream>
+
+//------------------------------------------------------------------------------
+TEST(Perft, Suite)
+{
+    // Shallow depths for keeping unit tests fast: the full depths are checked
+    // by 'make benchmark'.
+    for (auto const& position: c_perft_suite)
+    {
+        Rules rules(position.fen);
+        const Rules initial(position.fen);
+        const std::string moves = rules.moves();
+        const size_t legal_moves = rules.m_legal_moves.size();
+
+        for (uint8_t depth = 1u; depth <= 3u; ++depth)
+        {
+            ASSERT_EQ(position.nodes[depth - 1u], perft(rules, depth)) << position.name;
+        }
+
+        // Root position is restored
+        ASSERT_EQ(initial.m_board, rules.m_board);
+        ASSERT_EQ(initial.m_side, rules.m_side);
+        ASSERT_EQ(initial.m_ep, rules.m_ep);
+        ASSERT_EQ(moves, rules.moves());
+        ASSERT_EQ(legal_moves, rules.m_legal_moves.size());
+        ASSERT_EQ(0u, rules.plies());
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(Perft, Divide)
+{
+    Rules rules;
+    std::stringstream ss;
+
+    ASSERT_EQ(400u, divide(rules, 2u, ss));
+    std::string out = ss.str();
+    ASSERT_NE(std::string::npos, out.find("e2e4: 20\n"));
+    ASSERT_NE(std::string::npos, out.find("g1f3: 20\n"));
+    ASSERT_NE(std::string::npos, out.find("Nodes searched: 400\n"));
+
+    // Promotions are suffixed by the piece
+    rules.load("4k3/1P6/8/8/8/8/8/4K3 w - -");
+    ss.str("");
+    ASSERT_EQ(9u, divide(rules, 1u, ss));
+    out = ss.str();
+    ASSERT_NE(std::string::npos, out.find("b7b8q: 1\n"));
+    ASSERT_NE(std::string::npos, out.find("b7b8n: 1\n"));
+}
+
+//------------------------------------------------------------------------------
+TEST(Perft, Multithreaded)
+{
+    for (auto const& position: c_perft_suite)
+    {
+        Rules rules(position.fen);
+        const Rules initial(position.fen);
+
+        // Without and with the shared hash table, splitting root moves or
+        // root moves and their replies (depth >= 3).
+        for (uint8_t depth = 1u; depth <= 3u; ++depth)
+        {
+            ASSERT_EQ(position.nodes[depth - 1u], perft(rules, depth, 4u, 0u)) << position.name;
+            ASSERT_EQ(position.nodes[depth - 1u], perft(rules, depth, 3u, 1u)) << position.name;
+        }
+        ASSERT_EQ(position.nodes[3], perft(rules, 4u, 2u, 16u)) << position.name;
+
+        // Root position is restored
+        ASSERT_EQ(initial.m_board, rules.m_board);
+        ASSERT_EQ(initial.m_side, rules.m_side);
+        ASSERT_EQ(initial.hash(), rules.hash());
+        ASSERT_EQ(0u, rules.plies());
+    }
+
+    // Divide with threads gives the same output than the sequential one
+    Rules rules;
+    std::stringstream ss1, ss2;
+    divide(rules, 3u, ss1, 1u, 0u);
+    divide(rules, 3u, ss2, 4u, 1u);
+    ASSERT_EQ(ss1.str().substr(0u, ss1.str().find("Nodes")),
+              ss2.str().substr(0u, ss2.str().find("Nodes")));
+}
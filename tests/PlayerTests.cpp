@@ -0,0 +1,236 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Players/AlphaBeta.hpp"
+#include "Players/Human.hpp"
+#include "Players/NeuNeu.hpp"
+#include "Players/UciEngine.hpp"
+#include <fstream>
+#include <future>
+#include <thread>
+#include <sys/stat.h>
+
+//! \brief Max duration between IPlayer::abort() and the return of
+//! IPlayer::play() (ms).
+static constexpr double c_max_stop_latency = 100.0;
+
+//------------------------------------------------------------------------------
+//! \brief Call play() from a thread, abort it after the given delay and return
+//! the duration in milliseconds between abort() and the return of play().
+static double stopLatency(IPlayer& player, const std::chrono::milliseconds delay,
+                          std::string& move)
+{
+    using Clock = std::chrono::steady_clock;
+
+    player.resume();
+    std::future<std::string> playing = std::async(std::launch::async, [&player]()
+    {
+        return player.play(SearchLimits());
+    });
+    std::this_thread::sleep_for(delay);
+
+    const auto start = Clock::now();
+    player.abort();
+    move = playing.get();
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "Stop latency of " << player.type() << ": " << ms << " ms" << std::endl;
+    return ms;
+}
+
+//------------------------------------------------------------------------------
+//! \brief Write a shell script faking a UCI engine which never ends its
+//! search before "stop" and return its path.
+static std::string slowEngine()
+{
+    const char* path = "/tmp/ChessNeuNeu-slow-uci.sh";
+    {
+        std::ofstream file(path);
+        file << "#!/bin/sh\n"
+             << "while read cmd args; do\n"
+             << "  case \"$cmd\" in\n"
+             << "    uci) echo 'id name Slow'; echo 'uciok';;\n"
+             << "    isready) echo 'readyok';;\n"
+             << "    stop) echo 'bestmove e7e5';;\n"
+             << "    quit) exit 0;;\n"
+             << "  esac\n"
+             << "done\n";
+    }
+    chmod(path, 0755);
+    return path;
+}
+
+//------------------------------------------------------------------------------
+TEST(Player, AlphaBetaLimits)
+{
+    AlphaBetaOptions options;
+    options.hash_mb = 1u;
+    options.verbose = false;
+    Rules rules;
+    AlphaBeta player(rules, Color::White, options);
+
+    SearchLimits limits;
+    limits.depth = 2u;
+    ASSERT_TRUE(rules.isValidMove(player.play(limits)));
+    ASSERT_EQ(2u, player.lastResult().depth);
+
+    limits.depth = MaxSearchPlies - 1u;
+    limits.nodes = 2000u;
+    ASSERT_TRUE(rules.isValidMove(player.play(limits)));
+    ASSERT_LE(player.lastResult().nodes, 2000u);
+
+    limits.nodes = 0u;
+    limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    ASSERT_TRUE(rules.isValidMove(player.play(limits)));
+    ASSERT_LT(player.lastResult().seconds, 1.0);
+
+    // Aborted before play(): quitting at once
+    player.abort();
+    ASSERT_STREQ(IPlayer::quitting, player.play(SearchLimits()).c_str());
+    ASSERT_EQ(0u, player.lastResult().depth);
+    player.resume();
+
+    // Halted by the caller before play(): a legal move is returned at once
+    StopToken token;
+    token.request();
+    limits.stop = &token;
+    ASSERT_TRUE(rules.isValidMove(player.play(limits)));
+    ASSERT_EQ(0u, player.lastResult().depth);
+    limits.stop = nullptr;
+    limits.deadline = std::chrono::steady_clock::time_point::max();
+    limits.depth = 1u;
+    ASSERT_TRUE(rules.isValidMove(player.play(limits)));
+    ASSERT_EQ(1u, player.lastResult().depth);
+}
+
+//------------------------------------------------------------------------------
+TEST(Player, AlphaBetaStop)
+{
+    AlphaBetaOptions options;
+    options.hash_mb = 1u;
+    options.threads = 2u;
+    options.verbose = false;
+    Rules rules;
+    AlphaBeta player(rules, Color::White, options);
+
+    std::string move;
+    ASSERT_LT(stopLatency(player, std::chrono::milliseconds(50), move), c_max_stop_latency);
+    ASSERT_STREQ(IPlayer::quitting, move.c_str());
+
+    // Halted by the caller: the best move so far
+    player.resume();
+    StopToken token;
+    SearchLimits limits;
+    limits.stop = &token;
+    std::future<std::string> playing = std::async(std::launch::async, [&player, &limits]()
+    {
+        return player.play(limits);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    token.request();
+    ASSERT_EQ(std::future_status::ready, playing.wait_for(std::chrono::seconds(1)));
+    ASSERT_TRUE(rules.isValidMove(playing.get()));
+}
+
+//------------------------------------------------------------------------------
+TEST(Player, NeuNeuStop)
+{
+    Rules rules;
+    NeuNeu player(rules, Color::White);
+
+    // Aborted during the training: trained networks are kept
+    ASSERT_FALSE(player.trained());
+    player.abort();
+    ASSERT_STREQ(IPlayer::quitting, player.play(SearchLimits()).c_str());
+    ASSERT_FALSE(player.trained());
+
+    std::string move;
+    ASSERT_LT(stopLatency(player, std::chrono::milliseconds(1), move), c_max_stop_latency);
+
+    player.resume();
+    move = player.play(SearchLimits());
+    ASSERT_TRUE(player.trained());
+    ASSERT_TRUE(rules.isValidMove(move));
+
+    // Out of time: the first legal move
+    SearchLimits limits;
+    limits.deadline = std::chrono::steady_clock::now();
+    ASSERT_EQ(toStrMove(rules.m_legal_moves[0]), player.play(limits));
+}
+
+//------------------------------------------------------------------------------
+TEST(Player, NeuNeuDeadlineDuringTraining)
+{
+    Rules rules;
+    SearchLimits limits;
+
+    // The first move is given in time: the training is not finished
+    NeuNeu player(rules, Color::White);
+    limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+    std::string move = player.play(limits);
+    ASSERT_TRUE(rules.isValidMove(move)) << move;
+
+    // Also when the caller asks for the move (ie the UCI "stop" command) but
+    // not when aborted
+    NeuNeu halted(rules, Color::White);
+    StopToken token;
+    token.request();
+    limits.deadline = std::chrono::steady_clock::time_point::max();
+    limits.stop = &token;
+    move = halted.play(limits);
+    ASSERT_TRUE(rules.isValidMove(move)) << move;
+    ASSERT_FALSE(halted.trained());
+    halted.abort();
+    ASSERT_STREQ(IPlayer::quitting, halted.play(limits).c_str());
+}
+
+//------------------------------------------------------------------------------
+TEST(Player, UciEngineStop)
+{
+    Rules rules;
+    ASSERT_TRUE(rules.applyMove(Move("e2e4")));
+    UciEngine player(PlayerType::StockfishIA, rules, Color::Black, "", SearchLimits(),
+                     UciEngineConfig(slowEngine()));
+
+    // The engine answers "stop" with its best move
+    std::string move;
+    ASSERT_LT(stopLatency(player, std::chrono::milliseconds(50), move), c_max_stop_latency);
+    ASSERT_EQ("e7e5", move);
+
+    // Nothing is sent when aborted before play()
+    ASSERT_STREQ(IPlayer::quitting, player.play(SearchLimits()).c_str());
+    ASSERT_EQ(1u, player.session().latency().count);
+}
+
+//------------------------------------------------------------------------------
+TEST(Player, HumanStop)
+{
+    Rules rules;
+    Human player(rules, Color::White);
+
+    std::string move;
+    ASSERT_LT(stopLatency(player, std::chrono::milliseconds(10), move), c_max_stop_latency);
+    ASSERT_STREQ(IPlayer::quitting, move.c_str());
+
+    // Move notified by the GUI before play()
+    player.resume();
+    player.notified("e2e4");
+    ASSERT_EQ("e2e4", player.play(SearchLimits()));
+}
@@ -49,7 +49,7 @@ TEST(Constructor, LoadFromMovesCorrect)
     Rules rulesRef("rnbqkb1r/pppp1ppp/5n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq -");
     Rules rules;
 
-    ASSERT_EQ(true, rules.m_moved == "");
+    ASSERT_EQ(true, rules.moves() == "");
 
     // Revert last move from init board
     ASSERT_EQ(true, Chessboard::Init == rules.m_board);
@@ -57,18 +57,18 @@ TEST(Constructor, LoadFromMovesCorrect)
     ASSERT_EQ(true, "" == rules.revertLastMove());
     ASSERT_EQ(true, Chessboard::Init == rules.m_board);
     ASSERT_EQ(Color::White, rules.m_side);
-    ASSERT_EQ(true, rules.m_moved == "");
+    ASSERT_EQ(true, rules.moves() == "");
 
     // Load moves
     ASSERT_EQ(true, rules.applyMoves("e2e4 e7e5 g1f3 g8f6 f1c4", true));
     ASSERT_EQ(true, rulesRef.m_board == rules.m_board);
     ASSERT_EQ(Color::Black, rules.m_side);
-    ASSERT_EQ(true, rules.m_moved == "e2e4 e7e5 g1f3 g8f6 f1c4");
+    ASSERT_EQ(true, rules.moves() == "e2e4 e7e5 g1f3 g8f6 f1c4");
 
     // Revert last move
     ASSERT_EQ(true, "f1c4" == rules.revertLastMove());
     ASSERT_EQ(Color::White, rules.m_side);
-    ASSERT_EQ(true, rules.m_moved == "e2e4 e7e5 g1f3 g8f6");
+    ASSERT_EQ(true, rules.moves() == "e2e4 e7e5 g1f3 g8f6");
     Rules rules3 = rulesRef;
     rules3.m_board[sqC4] = NoPiece;
     rules3.m_board[sqF1] = WhiteBishop;
@@ -77,26 +77,204 @@ TEST(Constructor, LoadFromMovesCorrect)
     // Revert last move
     ASSERT_EQ(true, "g8f6" == rules.revertLastMove());
     ASSERT_EQ(Color::Black, rules.m_side);
-    ASSERT_EQ(true, rules.m_moved == "e2e4 e7e5 g1f3");
+    ASSERT_EQ(true, rules.moves() == "e2e4 e7e5 g1f3");
     ASSERT_EQ(true, "g1f3" == rules.revertLastMove());
     ASSERT_EQ(Color::White, rules.m_side);
-    ASSERT_EQ(true, rules.m_moved == "e2e4 e7e5");
+    ASSERT_EQ(true, rules.moves() == "e2e4 e7e5");
     ASSERT_EQ(true, "e7e5" == rules.revertLastMove());
     ASSERT_EQ(Color::Black, rules.m_side);
-    ASSERT_EQ(true, rules.m_moved == "e2e4");
+    ASSERT_EQ(true, rules.moves() == "e2e4");
     ASSERT_EQ(true, "e2e4" == rules.revertLastMove());
     ASSERT_EQ(Color::White, rules.m_side);
-    ASSERT_EQ(true, rules.m_moved == "");
+    ASSERT_EQ(true, rules.moves() == "");
 
     // Load moves
     ASSERT_EQ(true, rules.applyMoves("e2e4 e7e5 g1f3 g8f6 f1c4", true));
     ASSERT_EQ(true, rulesRef.m_board == rules.m_board);
     ASSERT_EQ(Color::Black, rules.m_side);
-    ASSERT_EQ(true, rules.m_moved == "e2e4 e7e5 g1f3 g8f6 f1c4");
+    ASSERT_EQ(true, rules.moves() == "e2e4 e7e5 g1f3 g8f6 f1c4");
 }
 
-// TODO castle + revert
-// TODO  ep + revert
+//------------------------------------------------------------------------------
+TEST(Constructor, RevertCastle)
+{
+    Rules rulesRef("r3k2r/8/8/8/8/8/8/R3K2R w KQkq -");
+    Rules rules("r3k2r/8/8/8/8/8/8/R3K2R w KQkq -");
+
+    ASSERT_EQ(true, rules.applyMoves("e1g1 e8c8", false));
+    ASSERT_EQ(WhiteRook, rules.m_board[sqF1]);
+    ASSERT_EQ(BlackRook, rules.m_board[sqD8]);
+    ASSERT_EQ(Castle::NoCastle, rules.m_castle[Color::White]);
+    ASSERT_EQ(Castle::NoCastle, rules.m_castle[Color::Black]);
+
+    ASSERT_EQ(true, "e8c8" == rules.revertLastMove());
+    ASSERT_EQ(true, "e1g1" == rules.revertLastMove());
+    ASSERT_EQ(true, rulesRef.m_board == rules.m_board);
+    ASSERT_EQ(Color::White, rules.m_side);
+    ASSERT_EQ(Castle::Both, rules.m_castle[Color::White]);
+    ASSERT_EQ(Castle::Both, rules.m_castle[Color::Black]);
+    ASSERT_EQ(rulesRef.m_legal_moves.size(), rules.m_legal_moves.size());
+}
+
+//------------------------------------------------------------------------------
+TEST(Constructor, RevertEnPassant)
+{
+    Rules rulesRef("4k3/3p4/8/4P3/8/8/8/4K3 b - -");
+    Rules rules("4k3/3p4/8/4P3/8/8/8/4K3 b - -");
+
+    ASSERT_EQ(true, rules.applyMoves("d7d5 e5d6", false));
+    ASSERT_EQ(WhitePawn, rules.m_board[sqD6]);
+    ASSERT_EQ(NoPiece, rules.m_board[sqD5]);
+
+    ASSERT_EQ(true, "e5d6" == rules.revertLastMove());
+    ASSERT_EQ(BlackPawn, rules.m_board[sqD5]);
+    ASSERT_EQ(WhitePawn, rules.m_board[sqE5]);
+    ASSERT_EQ(sqD6, rules.m_ep);
+    ASSERT_EQ(true, rules.isValidMove("e5d6"));
+
+    ASSERT_EQ(true, "d7d5" == rules.revertLastMove());
+    ASSERT_EQ(true, rulesRef.m_board == rules.m_board);
+    ASSERT_EQ(Square::OOB, rules.m_ep);
+    ASSERT_EQ(Color::Black, rules.m_side);
+}
+
+//------------------------------------------------------------------------------
+TEST(Constructor, MakeUnmakeMoves)
+{
+    // Kiwipete: castles, en-passant, promotions, takes ...
+    Rules rules("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+    const chessboard board = rules.m_board;
+    const MoveList moves = rules.m_legal_moves;
+
+    for (auto const& move: moves)
+    {
+        rules.makeMove(move);
+        ASSERT_EQ(Color::Black, rules.m_side);
+        ASSERT_EQ(1u, rules.plies());
+
+        const MoveList replies = rules.generateValidMoves();
+        for (auto const& reply: replies)
+        {
+            rules.makeMove(reply);
+            rules.unmakeMove();
+        }
+
+        rules.unmakeMove();
+        ASSERT_EQ(0u, rules.plies());
+        ASSERT_EQ(true, board == rules.m_board);
+        ASSERT_EQ(Color::White, rules.m_side);
+        ASSERT_EQ(Square::OOB, rules.m_ep);
+        ASSERT_EQ(Castle::Both, rules.m_castle[Color::White]);
+        ASSERT_EQ(Castle::Both, rules.m_castle[Color::Black]);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(Constructor, TakenRookForbidsCastle)
+{
+    Rules rules("r3k2r/8/8/8/8/8/8/R3K2R w KQkq -");
+
+    // Rook takes the opposite rook: both sides lost a castle
+    ASSERT_EQ(true, rules.applyMoves("h1h8", false));
+    ASSERT_EQ(Castle::Big, rules.m_castle[Color::White]);
+    ASSERT_EQ(Castle::Big, rules.m_castle[Color::Black]);
+    ASSERT_EQ(false, rules.isValidMove("e8g8"));
+
+    // En passant is no longer possible after a King move
+    ASSERT_EQ(true, rules.load("4k3/8/8/8/3p4/8/4P3/4K3 w - -"));
+    ASSERT_EQ(true, rules.applyMoves("e2e4 e8e7", false));
+    ASSERT_EQ(Square::OOB, rules.m_ep);
+}
+
+//------------------------------------------------------------------------------
+TEST(Constructor, PieceLists)
+{
+    Rules rules("r3k2r/1P6/8/3pP3/8/8/8/R3K2R w KQkq d6");
+
+    ASSERT_EQ(5u, rules.m_pieces.count[Color::White]);
+    ASSERT_EQ(4u, rules.m_pieces.count[Color::Black]);
+    ASSERT_EQ(sqE1, rules.findKing(Color::White));
+    ASSERT_EQ(sqE8, rules.findKing(Color::Black));
+
+    // Castle, en-passant and promotion with capture
+    ASSERT_EQ(true, rules.applyMoves("e5d6 e8g8 e1c1 g8g7 b7a8q", false));
+    ASSERT_EQ(sqC1, rules.findKing(Color::White));
+    ASSERT_EQ(sqG7, rules.findKing(Color::Black));
+    ASSERT_EQ(5u, rules.m_pieces.count[Color::White]);
+    ASSERT_EQ(2u, rules.m_pieces.count[Color::Black]);
+    ASSERT_EQ(false, rules.isKingInCheck(Color::Black));
+    ASSERT_EQ(true, rules.applyMove("f8f2"));
+    ASSERT_EQ(true, rules.applyMove("a8b7"));
+    ASSERT_EQ(true, rules.isKingInCheck(Color::Black));
+
+    // Each listed square holds a piece of the color
+    for (int c = Color::Black; c <= Color::White; ++c)
+    {
+        for (uint8_t i = 0u; i < rules.m_pieces.count[c]; ++i)
+        {
+            const uint8_t sq = rules.m_pieces.squares[c][i];
+            ASSERT_EQ(c, rules.m_board[sq].color);
+            ASSERT_EQ(i, rules.m_pieces.index[sq]);
+        }
+    }
+
+    while (rules.plies() != 0u)
+    {
+        rules.revertLastMove();
+    }
+    ASSERT_EQ(5u, rules.m_pieces.count[Color::White]);
+    ASSERT_EQ(4u, rules.m_pieces.count[Color::Black]);
+    ASSERT_EQ(sqE1, rules.findKing(Color::White));
+    ASSERT_EQ(sqE8, rules.findKing(Color::Black));
+}
+
+//------------------------------------------------------------------------------
+TEST(Constructor, BinaryMoves)
+{
+    Rules rules("r3k2r/1P6/8/3pP3/8/8/8/R3K2R w KQkq d6");
+
+    // Flags are deduced from the chessboard
+    ASSERT_EQ(true, rules.isValid(Move(sqE5, sqD6, MoveFlag::Quiet)));
+    ASSERT_EQ(false, rules.isValid(Move(sqE5, sqF6, MoveFlag::Quiet)));
+    ASSERT_EQ(false, rules.isValid(Move(sqB7, sqB8, MoveFlag::Quiet)));
+    ASSERT_EQ(true, rules.isValid(PromoteMove(sqB7, sqA8, PieceType::Knight)));
+    ASSERT_EQ(false, rules.isValid(PromoteMove(sqE1, sqE2, PieceType::Queen)));
+
+    ASSERT_EQ(true, rules.applyMove(Move(sqE5, sqD6, MoveFlag::Quiet)));
+    ASSERT_EQ(NoPiece, rules.m_board[sqD5]);
+    ASSERT_EQ(true, rules.applyMove(Move(sqE8, sqG8, MoveFlag::Quiet)));
+    ASSERT_EQ(BlackRook, rules.m_board[sqF8]);
+    ASSERT_EQ(false, rules.applyMove(Move(sqE1, sqE1 - 16, MoveFlag::Quiet)));
+    ASSERT_EQ(true, rules.applyMove(PromoteMove(sqB7, sqA8, PieceType::Queen)));
+    ASSERT_EQ(WhiteQueen, rules.m_board[sqA8]);
+
+    // History in UCI notation is built on demand
+    ASSERT_EQ(3u, rules.plies());
+    ASSERT_EQ(PromoteMove(sqB7, sqA8, PieceType::Queen), rules.lastMove());
+    ASSERT_EQ("e5d6 e8g8 b7a8q", rules.moves());
+    ASSERT_EQ("b7a8q", rules.revertLastMove());
+    ASSERT_EQ("e5d6 e8g8", rules.moves());
+}
+
+//------------------------------------------------------------------------------
+TEST(Constructor, MaxPlies)
+{
+    // Knights going back and forth: the history is full after MaxPlies moves
+    std::string moves;
+    for (uint16_t i = 0u; i < MaxPlies / 4u; ++i)
+        moves += "g1f3 g8f6 f3g1 f6g8 ";
+
+    Rules rules;
+    ASSERT_EQ(true, rules.applyMoves(moves, true));
+    ASSERT_EQ(MaxPlies, rules.plies());
+    ASSERT_EQ(false, rules.applyMove(Move("g1f3")));
+    ASSERT_EQ(false, rules.applyMoves(moves + "g1f3", true));
+    ASSERT_EQ(MaxPlies, rules.plies());
+
+    // Reverting a move makes room again
+    rules.revertLastMove();
+    ASSERT_EQ(true, rules.applyMove(Move("f6g8")));
+}
 
 //------------------------------------------------------------------------------
 TEST(Constructor, LoadFromMovesFailure)
@@ -140,8 +318,8 @@ TEST(PawnMoves, PawnMoveWE2_BE7)
     Rules rules(board, Color::White, WithNoKings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(2, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("e2e3")));
     ASSERT_NE(e, std::find(b, e, Move("e2e4")));
 
@@ -174,8 +352,8 @@ TEST(PawnMoves, PawnMoveWD3_BD6)
     Rules rules(board, Color::White, WithNoKings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(1, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("d3d4")));
 
     ASSERT_EQ(true, rules.isValidMove("d3d4"));
@@ -220,8 +398,8 @@ TEST(PawnMoves, PawnMoveWC4_BB5)
     Rules rules(board, Color::White, WithNoKings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(4, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("c4c5")));
     ASSERT_NE(e, std::find(b, e, Move("c4b5")));
     ASSERT_NE(e, std::find(b, e, Move("a4a5")));
@@ -238,6 +416,26 @@ TEST(PawnMoves, PawnMoveWC4_BB5)
     ASSERT_NE(e, std::find(b, e, Move("b5b4")));
 }
 
+//------------------------------------------------------------------------------
+TEST(PawnMoves, DoubleMoveBlocked)
+{
+    // Empty chessboard, No King, Pawns cannot jump over a piece
+    chessboard board = Chessboard::Empty;
+    board[sqE2] = WhitePawn;
+    board[sqE3] = BlackKnight;
+    board[sqD7] = BlackPawn;
+    board[sqD6] = WhiteKnight;
+
+    Rules rules(board, Color::White, WithNoKings);
+    ASSERT_EQ(false, rules.isValidMove("e2e3"));
+    ASSERT_EQ(false, rules.isValidMove("e2e4"));
+
+    rules.m_side = Color::Black;
+    rules.generateValidMoves();
+    ASSERT_EQ(false, rules.isValidMove("d7d6"));
+    ASSERT_EQ(false, rules.isValidMove("d7d5"));
+}
+
 //------------------------------------------------------------------------------
 TEST(PawnMoves, PawnPromotionMove)
 {
@@ -250,8 +448,8 @@ TEST(PawnMoves, PawnPromotionMove)
     Rules rules(board, Color::White, WithNoKings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(4, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("g7g8r")));
     ASSERT_NE(e, std::find(b, e, Move("g7g8n")));
     ASSERT_NE(e, std::find(b, e, Move("g7g8b")));
@@ -286,8 +484,8 @@ TEST(PawnMoves, WhiteEnPassantAllowed)
     ASSERT_EQ(2, rules.m_legal_moves.size());
 
     // Check movement
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("e5e6")));
     ASSERT_NE(e, std::find(b, e, Move("e5d6")));
 
@@ -312,8 +510,8 @@ TEST(PawnMoves, BlackEnPassantAllowed)
     ASSERT_EQ(2, rules.m_legal_moves.size());
 
     // Check movement
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("d4d3")));
     ASSERT_NE(e, std::find(b, e, Move("d4e3")));
 
@@ -337,8 +535,8 @@ TEST(PawnMoves, EnPassantNotAllowed)
     ASSERT_EQ(WithNoKings, rules.m_no_kings);
     ASSERT_EQ(1, rules.m_legal_moves.size());
 
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("d4d3")));
 }
 
@@ -356,8 +554,8 @@ TEST(PawnMoves, GenerateWhiteEnPassant)
     ASSERT_EQ(sqD6, rules.m_ep);
     ASSERT_EQ(2, rules.m_legal_moves.size());
 
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("e5e6")));
     ASSERT_NE(e, std::find(b, e, Move("e5d6")));
 }
@@ -376,8 +574,8 @@ TEST(PawnMoves, GenerateBlackEnPassant)
     ASSERT_EQ(sqE3, rules.m_ep);
     ASSERT_EQ(2, rules.m_legal_moves.size());
 
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("d4d3")));
     ASSERT_NE(e, std::find(b, e, Move("d4e3")));
 }
@@ -394,8 +592,8 @@ TEST(KnightMoves, BasicKnightMoves)
     rules.generateValidMoves();
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(3, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("b1a3")));
     ASSERT_NE(e, std::find(b, e, Move("b1c3")));
     ASSERT_NE(e, std::find(b, e, Move("b1d2")));
@@ -461,8 +659,8 @@ TEST(KnightMoves, BlockedKnightMoves)
     rules.generateValidMoves();
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(3, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_EQ(e, std::find(b, e, Move("a1b3")));
     ASSERT_EQ(e, std::find(b, e, Move("a1c2")));
 }
@@ -477,8 +675,8 @@ TEST(BishopMoves, BasicBishopMoves)
     ASSERT_EQ(WithNoKings, rules.m_no_kings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(26, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
 
     ASSERT_NE(e, std::find(b, e, Move("d4e5")));
     ASSERT_NE(e, std::find(b, e, Move("d4f6")));
@@ -547,8 +745,8 @@ TEST(BishopMoves, BlockedBoshopMoves)
     ASSERT_EQ(WithNoKings, rules.m_no_kings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(36, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
 
     ASSERT_NE(e, std::find(b, e, Move("d7e8")));
     ASSERT_NE(e, std::find(b, e, Move("d7c8")));
@@ -633,8 +831,8 @@ TEST(RookMoves, BasicRookMoves)
     ASSERT_EQ(WithNoKings, rules.m_no_kings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(28, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
 
     ASSERT_NE(e, std::find(b, e, Move("d5d6")));
     ASSERT_NE(e, std::find(b, e, Move("d5d7")));
@@ -710,8 +908,8 @@ TEST(RookMoves, BlockedRookMoves)
     ASSERT_EQ(WithNoKings, rules.m_no_kings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(44, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
 
     ASSERT_NE(e, std::find(b, e, Move("d7d8")));
     ASSERT_NE(e, std::find(b, e, Move("d7e7")));
@@ -804,8 +1002,8 @@ TEST(QueenMoves, BasicQueenMoves)
     ASSERT_EQ(WithNoKings, rules.m_no_kings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(50, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("b5b6")));
     ASSERT_NE(e, std::find(b, e, Move("b5b7")));
     ASSERT_NE(e, std::find(b, e, Move("b5b8")));
@@ -868,8 +1066,8 @@ TEST(QueenMoves, BlockedQueenMoves)
     ASSERT_EQ(WithNoKings, rules.m_no_kings);
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(48, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("c5c6")));
     ASSERT_NE(e, std::find(b, e, Move("c5c7")));
     ASSERT_NE(e, std::find(b, e, Move("c5c8")));
@@ -969,13 +1167,14 @@ TEST(KingMoves, BasicKingMoves)
 {
     Rules rules;
     ASSERT_EQ(true, rules.load("8/6k1/8/8/4K3/8/8/8 w - -"));
+    // Legal moves are still generated but the game is a draw
 
     ASSERT_EQ(Color::White, rules.m_side);
     ASSERT_EQ(WithKings, rules.m_no_kings);
-    ASSERT_EQ(Status::Playing, rules.status());
+    ASSERT_EQ(Status::InsufficientMaterial, rules.status());
     ASSERT_EQ(8, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("e4e5")));
     ASSERT_NE(e, std::find(b, e, Move("e4e3")));
     ASSERT_NE(e, std::find(b, e, Move("e4f4")));
@@ -986,7 +1185,7 @@ TEST(KingMoves, BasicKingMoves)
     ASSERT_NE(e, std::find(b, e, Move("e4d3")));
 
     rules.applyMove("e4d5");
-    ASSERT_EQ(Status::Playing, rules.status());
+    ASSERT_EQ(Status::InsufficientMaterial, rules.status());
     ASSERT_EQ(8, rules.m_legal_moves.size());
     b = rules.m_legal_moves.begin();
     e = rules.m_legal_moves.end();
@@ -1009,8 +1208,8 @@ TEST(KingMoves, BlockedKingMoves)
     ASSERT_EQ(Color::White, rules.m_side);
     ASSERT_EQ(WithKings, rules.m_no_kings);
     ASSERT_EQ(Status::Playing, rules.status());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("e4d4")));
     ASSERT_NE(e, std::find(b, e, Move("e4d3")));
     ASSERT_NE(e, std::find(b, e, Move("e4f3")));
@@ -1050,6 +1249,47 @@ TEST(KingMoves, BlackBlockedByCheck)
     ASSERT_EQ(0, rules.m_legal_moves.size());
 }
 
+//------------------------------------------------------------------------------
+TEST(KingMoves, PinnedPieces)
+{
+    Rules rules;
+
+    // Rook pinned on the column can only slide along it. Pinned Knight
+    // cannot move.
+    ASSERT_EQ(true, rules.load("k7/4r3/8/8/1b6/8/3NR3/4K3 w - -"));
+    ASSERT_EQ(8, rules.m_legal_moves.size());
+    ASSERT_EQ(true, rules.isValidMove("e2e7"));
+    ASSERT_EQ(true, rules.isValidMove("e2e3"));
+    ASSERT_EQ(false, rules.isValidMove("e2f2"));
+    ASSERT_EQ(false, rules.isValidMove("d2b3"));
+    ASSERT_EQ(false, rules.isValidMove("d2f3"));
+
+    // En-passant would discover a check on the row
+    ASSERT_EQ(true, rules.load("8/8/8/K1pP3r/8/8/8/7k w - c6"));
+    ASSERT_EQ(false, rules.isValidMove("d5c6"));
+    ASSERT_EQ(true, rules.isValidMove("d5d6"));
+}
+
+//------------------------------------------------------------------------------
+TEST(KingMoves, EvadeChecks)
+{
+    Rules rules;
+
+    // Simple check: block the rook or move the King
+    ASSERT_EQ(true, rules.load("k3r3/8/8/8/8/8/7R/4K3 w - -"));
+    ASSERT_EQ(5, rules.m_legal_moves.size());
+    ASSERT_EQ(true, rules.isValidMove("h2e2"));
+    ASSERT_EQ(false, rules.isValidMove("h2h3"));
+    ASSERT_EQ(false, rules.isValidMove("e1e2"));
+
+    // Double check: only the King can move
+    ASSERT_EQ(true, rules.load("k3r3/8/8/8/8/3n4/7R/4K3 w - -"));
+    ASSERT_EQ(3, rules.m_legal_moves.size());
+    ASSERT_EQ(false, rules.isValidMove("h2e2"));
+    ASSERT_EQ(true, rules.isValidMove("e1d2"));
+    ASSERT_EQ(false, rules.isValidMove("e1f2"));
+}
+
 //------------------------------------------------------------------------------
 TEST(KingMoves, AllowedCastle)
 {
@@ -1061,8 +1301,8 @@ TEST(KingMoves, AllowedCastle)
     ASSERT_EQ(Castle::Both, rules.m_castle[Color::White]);
     ASSERT_EQ(Castle::Both, rules.m_castle[Color::Black]);
 
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("e1c1")));
     ASSERT_NE(e, std::find(b, e, Move("e1g1")));
 
@@ -1189,8 +1429,8 @@ TEST(KingMoves, InitPos)
 
     rules.dispLegalMoves();
 
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("a2a3")));
     ASSERT_NE(e, std::find(b, e, Move("a2a4")));
     ASSERT_NE(e, std::find(b, e, Move("b2b3")));
@@ -1239,8 +1479,8 @@ TEST(ChessStatus, BlackCheckMate)
     rules.applyMove("e7g5");
     ASSERT_EQ(Status::Playing, rules.status());
     ASSERT_EQ(1, rules.m_legal_moves.size());
-    std::vector<Move>::iterator b = rules.m_legal_moves.begin();
-    std::vector<Move>::iterator e = rules.m_legal_moves.end();
+    MoveList::iterator b = rules.m_legal_moves.begin();
+    MoveList::iterator e = rules.m_legal_moves.end();
     ASSERT_NE(e, std::find(b, e, Move("c1b1")));
 
     rules.applyMove("c1b1");
@@ -1278,3 +1518,130 @@ TEST(ChessStatus, BlackStalemate)
     ASSERT_EQ(Status::Stalemate, rules.status());
     ASSERT_EQ(0, rules.m_legal_moves.size());
 }
+
+//------------------------------------------------------------------------------
+TEST(ChessStatus, ThreefoldRepetition)
+{
+    Rules rules;
+    ASSERT_EQ(true, rules.applyMoves("g1f3 g8f6 f3g1 f6g8", true));
+    ASSERT_EQ(false, rules.isThreefoldRepetition());
+    ASSERT_EQ(Status::Playing, rules.status());
+
+    ASSERT_EQ(true, rules.applyMoves("g1f3 g8f6 f3g1 f6g8 g1f3 g8f6 f3g1 f6g8", true));
+    ASSERT_EQ(true, rules.isThreefoldRepetition());
+    ASSERT_EQ(Status::Repetition, rules.status());
+    ASSERT_EQ(Status::Repetition, rules.computeStatus());
+
+    // A pawn move cannot be reverted: positions before it cannot repeat
+    ASSERT_EQ(true, rules.applyMoves("g1f3 g8f6 f3g1 f6g8 e2e3 g8f6 g1f3 f6g8 f3g1", true));
+    ASSERT_EQ(Status::Playing, rules.status());
+    ASSERT_EQ(true, rules.applyMove("g8f6"));
+    ASSERT_EQ(Status::Playing, rules.status());
+
+    // Reverting moves restores the status
+    rules.unmakeMove();
+    ASSERT_EQ(Status::Playing, rules.computeStatus());
+}
+
+//------------------------------------------------------------------------------
+TEST(ChessStatus, FiftyMoves)
+{
+    Rules rules;
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/8/R6K w - - 98 80"));
+    ASSERT_EQ(98u, rules.halfmoves());
+    ASSERT_EQ(Status::Playing, rules.status());
+
+    ASSERT_EQ(true, rules.applyMove("a1a2"));
+    ASSERT_EQ(99u, rules.halfmoves());
+    ASSERT_EQ(Status::Playing, rules.status());
+
+    ASSERT_EQ(true, rules.applyMove("h8g8"));
+    ASSERT_EQ(100u, rules.halfmoves());
+    ASSERT_EQ(Status::FiftyMoves, rules.status());
+    ASSERT_EQ(Status::FiftyMoves, rules.computeStatus());
+
+    rules.unmakeMove();
+    ASSERT_EQ(99u, rules.halfmoves());
+
+    // Checkmate has priority on the fifty-move rule
+    ASSERT_EQ(true, rules.load("6k1/5ppp/8/8/8/8/8/R5K1 w - - 99 80"));
+    ASSERT_EQ(true, rules.applyMove("a1a8"));
+    ASSERT_EQ(Status::WhiteWon, rules.status());
+
+    // Captures and pawn moves reset the counter
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/P7/6K1 w - - 42 80"));
+    ASSERT_EQ(true, rules.applyMove("a2a3"));
+    ASSERT_EQ(0u, rules.halfmoves());
+
+    // Missing clock
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/P7/6K1 w - -"));
+    ASSERT_EQ(0u, rules.halfmoves());
+}
+
+//------------------------------------------------------------------------------
+TEST(ChessStatus, InsufficientMaterial)
+{
+    Rules rules;
+
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/8/6K1 w - -"));
+    ASSERT_EQ(Status::InsufficientMaterial, rules.status());
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/8/5NK1 w - -"));
+    ASSERT_EQ(Status::InsufficientMaterial, rules.status());
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/8/5BK1 w - -"));
+    ASSERT_EQ(Status::InsufficientMaterial, rules.status());
+
+    // Bishops on squares of the same color
+    ASSERT_EQ(true, rules.load("5b1k/8/8/8/8/8/8/4B1K1 w - -"));
+    ASSERT_EQ(Status::InsufficientMaterial, rules.status());
+    ASSERT_EQ(Status::InsufficientMaterial, rules.computeStatus());
+
+    // Mate is still possible
+    ASSERT_EQ(true, rules.load("4b2k/8/8/8/8/8/8/4B1K1 w - -"));
+    ASSERT_EQ(Status::Playing, rules.status());
+    ASSERT_EQ(true, rules.load("6nk/8/8/8/8/8/8/5NK1 w - -"));
+    ASSERT_EQ(Status::Playing, rules.status());
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/8/4NNK1 w - -"));
+    ASSERT_EQ(Status::Playing, rules.status());
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/P7/6K1 w - -"));
+    ASSERT_EQ(Status::Playing, rules.status());
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/8/5RK1 w - -"));
+    ASSERT_EQ(Status::Playing, rules.status());
+
+    // The last piece is taken
+    ASSERT_EQ(true, rules.load("7k/8/8/8/8/8/6r1/6K1 w - -"));
+    ASSERT_EQ(Status::Playing, rules.status());
+    ASSERT_EQ(true, rules.applyMove("g1g2"));
+    ASSERT_EQ(Status::InsufficientMaterial, rules.status());
+}
+
+//------------------------------------------------------------------------------
+//! \brief computeStatus() shall match the status of generateValidMoves().
+static void checkStatus(Rules& rules, const uint8_t depth)
+{
+    const MoveList moves = rules.generateValidMoves();
+    ASSERT_EQ(rules.status(), rules.computeStatus());
+
+    if (depth == 0u)
+        return ;
+
+    for (auto const& move: moves)
+    {
+        rules.makeMove(move);
+        checkStatus(rules, uint8_t(depth - 1u));
+        rules.unmakeMove();
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(ChessStatus, ComputeStatus)
+{
+    for (auto const& fen: { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+                            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+                            "k2r4/4b3/8/8/8/8/PPP5/2K5 b - -",
+                            "6k1/5ppp/8/8/8/8/8/R5K1 w - -",
+                            "8/8/8/8/8/5k2/6p1/6K1 b - -" })
+    {
+        Rules rules(fen);
+        checkStatus(rules, 3u);
+    }
+}
@@ -0,0 +1,327 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Chess/Search.hpp"
+#include <thread>
+
+//------------------------------------------------------------------------------
+TEST(Search, Evaluate)
+{
+    // Symmetric position
+    Rules rules;
+    ASSERT_EQ(0, evaluate(rules));
+    rules.applyMove("e2e4");
+    ASSERT_EQ(-evaluate(Rules("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR w KQkq -")),
+              evaluate(rules));
+
+    // Material from the side to move view
+    ASSERT_GT(evaluate(Rules("4k3/8/8/8/8/8/8/Q3K3 w - -")), 800);
+    ASSERT_LT(evaluate(Rules("4k3/8/8/8/8/8/8/Q3K3 b - -")), -800);
+}
+
+//------------------------------------------------------------------------------
+TEST(Search, TranspositionTable)
+{
+    TranspositionTable tt(1u);
+    TTEntry entry;
+
+    ASSERT_EQ(0u, tt.size() & (tt.size() - 1u));
+    ASSERT_FALSE(tt.probe(42u, entry));
+
+    tt.store(42u, 5u, 100, Bound::ExactBound, Move("e2e4"));
+    ASSERT_TRUE(tt.probe(42u, entry));
+    ASSERT_EQ(42u, entry.key);
+    ASSERT_EQ(5u, entry.depth);
+    ASSERT_EQ(100, entry.score);
+    ASSERT_EQ(Bound::ExactBound, entry.bound);
+    ASSERT_EQ(Move("e2e4"), entry.move);
+
+    // Shallower bound does not replace a deeper search
+    tt.store(42u, 2u, -50, Bound::UpperBound, Move::null());
+    ASSERT_TRUE(tt.probe(42u, entry));
+    ASSERT_EQ(5u, entry.depth);
+
+    // Best move is kept when the new search has none
+    tt.store(42u, 6u, -50, Bound::UpperBound, Move::null());
+    ASSERT_TRUE(tt.probe(42u, entry));
+    ASSERT_EQ(6u, entry.depth);
+    ASSERT_EQ(Move("e2e4"), entry.move);
+
+    // Negative scores
+    tt.store(43u, 1u, -31000, Bound::LowerBound, Move("a7a8q"));
+    ASSERT_TRUE(tt.probe(43u, entry));
+    ASSERT_EQ(-31000, entry.score);
+    ASSERT_EQ(Bound::LowerBound, entry.bound);
+    ASSERT_EQ(Move("a7a8q"), entry.move);
+
+    tt.clear();
+    ASSERT_FALSE(tt.probe(42u, entry));
+    ASSERT_FALSE(tt.probe(43u, entry));
+}
+
+//------------------------------------------------------------------------------
+TEST(Search, TranspositionTableBuckets)
+{
+    TranspositionTable tt(1u);
+    const uint64_t buckets = tt.size() / TranspositionTable::BucketSize;
+    TTEntry entry;
+
+    ASSERT_EQ(1024u * 1024u / TranspositionTable::CacheLineSize, buckets);
+    ASSERT_EQ(0u, tt.hashfull());
+
+    // Positions of the same bucket are all kept until the bucket is full
+    for (uint64_t i = 1u; i <= TranspositionTable::BucketSize; ++i)
+    {
+        ASSERT_FALSE(tt.store(i * buckets, uint8_t(i), 0, Bound::ExactBound, Move::null()));
+    }
+    for (uint64_t i = 1u; i <= TranspositionTable::BucketSize; ++i)
+    {
+        ASSERT_TRUE(tt.probe(i * buckets, entry));
+        ASSERT_EQ(i, entry.depth);
+    }
+    ASSERT_GT(tt.hashfull(), 0u);
+
+    // Full bucket: the shallowest entry is evicted
+    const uint64_t key = (TranspositionTable::BucketSize + 1u) * buckets;
+    ASSERT_TRUE(tt.store(key, 10u, 0, Bound::ExactBound, Move::null()));
+    ASSERT_TRUE(tt.probe(key, entry));
+    ASSERT_FALSE(tt.probe(buckets, entry));
+    ASSERT_TRUE(tt.probe(2u * buckets, entry));
+
+    // Entries of older searches are evicted first, even deeper
+    tt.newSearch();
+    ASSERT_EQ(0u, tt.hashfull());
+    tt.store(2u * buckets, 1u, 0, Bound::ExactBound, Move::null());
+    ASSERT_TRUE(tt.store(7u * buckets, 1u, 0, Bound::ExactBound, Move::null()));
+    ASSERT_TRUE(tt.probe(7u * buckets, entry));
+    ASSERT_FALSE(tt.probe(3u * buckets, entry));
+    ASSERT_TRUE(tt.probe(4u * buckets, entry));
+    ASSERT_TRUE(tt.probe(key, entry));
+
+    // A shallower result of a new search replaces the result of an old one
+    ASSERT_TRUE(tt.probe(2u * buckets, entry));
+    ASSERT_EQ(1u, entry.depth);
+}
+
+//------------------------------------------------------------------------------
+TEST(Search, MateInOne)
+{
+    TranspositionTable tt(1u);
+    Search search(tt);
+    SearchLimits limits;
+    limits.depth = 4u;
+
+    Rules rules("6k1/5ppp/8/8/8/8/8/R5K1 w - -");
+    const uint64_t hash = rules.hash();
+    SearchResult result = search.run(rules, limits);
+    ASSERT_EQ(Move("a1a8"), result.move);
+    ASSERT_EQ(ScoreMate - 1, result.score);
+    ASSERT_EQ(hash, rules.hash());
+    ASSERT_EQ(0u, rules.plies());
+
+    // Black is mated
+    Rules mated("R5k1/5ppp/8/8/8/8/8/6K1 b - -");
+    result = search.run(mated, limits);
+    ASSERT_TRUE(result.move.isNull());
+}
+
+//------------------------------------------------------------------------------
+TEST(Search, WinMaterial)
+{
+    TranspositionTable tt(1u);
+    Search search(tt);
+    SearchLimits limits;
+    limits.depth = 4u;
+
+    // Take the hanging Queen
+    Rules rules("4k3/8/8/3q4/8/8/3R4/3RK3 w - -");
+    SearchResult result = search.run(rules, limits);
+    ASSERT_EQ(Move("d2d5"), result.move);
+    ASSERT_GT(result.score, 500);
+
+    // Do not take the defended pawn with the Queen
+    Rules defended("4k3/2p5/3p4/8/8/8/3Q4/4K3 w - -");
+    result = search.run(defended, limits);
+    ASSERT_FALSE(Move("d2d6") == result.move);
+}
+
+//------------------------------------------------------------------------------
+TEST(Search, Limits)
+{
+    TranspositionTable tt(1u);
+    Search search(tt);
+    Rules rules;
+
+    SearchLimits limits;
+    limits.nodes = 5000u;
+    SearchResult result = search.run(rules, limits);
+    ASSERT_LE(result.nodes, limits.nodes);
+    ASSERT_FALSE(result.move.isNull());
+    ASSERT_EQ(Status::Playing, rules.m_status);
+    ASSERT_EQ(0u, rules.plies());
+
+    limits.nodes = 0u;
+    limits.movetime = 50u;
+    result = search.run(rules, limits);
+    ASSERT_LT(result.seconds, 1.0);
+    ASSERT_GT(result.depth, 0u);
+    ASSERT_FALSE(result.move.isNull());
+
+    limits.movetime = 0u;
+    limits.depth = 3u;
+    result = search.run(rules, limits);
+    ASSERT_EQ(3u, result.depth);
+
+    // Deadline and stop token
+    limits.depth = MaxSearchPlies - 1u;
+    limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    result = search.run(rules, limits);
+    ASSERT_LT(result.seconds, 1.0);
+    ASSERT_FALSE(result.move.isNull());
+
+    StopToken token;
+    token.request();
+    limits.deadline = std::chrono::steady_clock::time_point::max();
+    limits.stop = &token;
+    result = search.run(rules, limits);
+    ASSERT_EQ(0u, result.depth);
+    ASSERT_FALSE(result.move.isNull());
+
+    limits.stop = nullptr;
+    limits.abort = &token;
+    result = search.run(rules, limits);
+    ASSERT_EQ(0u, result.depth);
+    ASSERT_FALSE(result.move.isNull());
+}
+
+//------------------------------------------------------------------------------
+TEST(Search, CombineLimits)
+{
+    using Clock = std::chrono::steady_clock;
+
+    SearchLimits player;
+    player.depth = 8u;
+    player.movetime = 1000u;
+    player.time = 60000u;
+
+    SearchLimits move;
+    move.nodes = 5000u;
+    move.movetime = 2000u;
+    const SearchLimits limits = tightest(player, move);
+    ASSERT_EQ(8u, limits.depth);
+    ASSERT_EQ(5000u, limits.nodes);
+    ASSERT_EQ(1000u, limits.movetime);
+    ASSERT_EQ(60000u, limits.time);
+    ASSERT_EQ(Clock::time_point::max(), limits.deadline);
+    ASSERT_EQ(nullptr, limits.stop);
+    ASSERT_EQ(nullptr, limits.abort);
+
+    // The earliest of movetime and deadline ends the search
+    const auto start = Clock::now();
+    ASSERT_EQ(start + std::chrono::milliseconds(1000), limits.end(start));
+    move.deadline = start + std::chrono::milliseconds(10);
+    ASSERT_EQ(move.deadline, tightest(player, move).end(start));
+    ASSERT_EQ(Clock::time_point::max(), SearchLimits().end(start));
+
+    // Deadline converted into a movetime for external engines
+    move.deadline = Clock::now() + std::chrono::milliseconds(500);
+    const SearchLimits relative = move.relative();
+    ASSERT_LE(relative.movetime, 500u);
+    ASSERT_GT(relative.movetime, 400u);
+    ASSERT_EQ(Clock::time_point::max(), relative.deadline);
+    move.deadline = Clock::now() - std::chrono::milliseconds(500);
+    ASSERT_EQ(1u, move.relative().movetime);
+}
+
+//------------------------------------------------------------------------------
+TEST(Search, LazySMP)
+{
+    TranspositionTable tt(1u);
+    ParallelSearch search(tt, 3u);
+    ASSERT_EQ(3u, search.threads());
+
+    SearchLimits limits;
+    limits.depth = 4u;
+
+    // The position is not modified
+    const Rules rules("6k1/5ppp/8/8/8/8/8/R5K1 w - -");
+    const uint64_t hash = rules.hash();
+    SearchResult result = search.run(rules, limits);
+    ASSERT_EQ(Move("a1a8"), result.move);
+    ASSERT_EQ(ScoreMate - 1, result.score);
+    ASSERT_EQ(hash, rules.hash());
+
+    // Helpers are halted when the main thread returns
+    limits.depth = 3u;
+    result = search.run(Rules(), limits);
+    ASSERT_EQ(3u, result.depth);
+    ASSERT_FALSE(result.move.isNull());
+
+    // Halted from another thread
+    limits.depth = MaxSearchPlies - 1u;
+    std::thread stopper([&search]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        search.stop();
+    });
+    result = search.run(Rules(), limits);
+    stopper.join();
+    ASSERT_LT(result.seconds, 5.0);
+    ASSERT_FALSE(result.move.isNull());
+}
+
+//------------------------------------------------------------------------------
+TEST(Search, SharedTranspositionTable)
+{
+    // Threads writing the same slots: torn entries shall never be returned
+    TranspositionTable tt(1u);
+    const size_t size = tt.size();
+    std::vector<std::thread> threads;
+    for (uint8_t t = 0u; t < 4u; ++t)
+    {
+        threads.emplace_back([&tt, size, t]()
+        {
+            for (uint64_t i = 0u; i < 100000u; ++i)
+            {
+                // Same slot, different keys
+                const uint64_t key = ((i % 7u) + 1u) * size + (i % 16u);
+                const int16_t score = int16_t(key % 1000u);
+                tt.store(key, uint8_t(t + 1u), score, Bound::ExactBound,
+                         Move(uint8_t(key % 64u), uint8_t((key + 1u) % 64u), 0u));
+            }
+        });
+    }
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+
+    TTEntry entry;
+    for (uint64_t i = 0u; i < 112u; ++i)
+    {
+        const uint64_t key = ((i % 7u) + 1u) * size + (i % 16u);
+        if (tt.probe(key, entry))
+        {
+            ASSERT_EQ(int16_t(key % 1000u), entry.score);
+            ASSERT_EQ(key % 64u, entry.move.from);
+        }
+    }
+}
@@ -0,0 +1,137 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Match/Tournament.hpp"
+#include <fstream>
+
+//------------------------------------------------------------------------------
+TEST(Tournament, Schedule)
+{
+    TournamentOptions options;
+    options.players = { PlayerType::AlphaBetaIA, PlayerType::NeuNeuIA,
+                        PlayerType::StockfishIA, PlayerType::LokiIA };
+    options.openings = { "", "4k3/8/8/8/8/8/4P3/4K3 w - -" };
+    options.rounds = 3u;
+
+    // 6 pairs, 2 openings, 3 rounds of 2 games
+    options.pairing = Pairing::RoundRobin;
+    std::vector<ScheduledGame> games = schedule(options);
+    ASSERT_EQ(6u * 2u * 3u * 2u, games.size());
+
+    // 3 pairs
+    options.pairing = Pairing::Gauntlet;
+    games = schedule(options);
+    ASSERT_EQ(3u * 2u * 3u * 2u, games.size());
+    size_t whites[4] = { 0u, 0u, 0u, 0u };
+    for (auto const& game: games)
+    {
+        ASSERT_TRUE((game.white == 0u) || (game.black == 0u));
+        ASSERT_NE(game.white, game.black);
+        ++whites[game.white];
+    }
+
+    // Same number of games with each color
+    ASSERT_EQ(games.size() / 2u, whites[0]);
+    ASSERT_EQ(whites[1], whites[2]);
+    ASSERT_EQ(whites[1], whites[3]);
+}
+
+//------------------------------------------------------------------------------
+TEST(Tournament, Elo)
+{
+    ASSERT_NEAR(0.0, eloDifference(0.5), 1e-9);
+    ASSERT_NEAR(191.0, eloDifference(0.75), 1.0);
+    ASSERT_NEAR(-191.0, eloDifference(0.25), 1.0);
+}
+
+//------------------------------------------------------------------------------
+TEST(Tournament, Openings)
+{
+    const char* path = "/tmp/ChessNeuNeu-openings.fen";
+    {
+        std::ofstream file(path);
+        file << "# Comment\n\n  4k3/8/8/8/8/8/4P3/4K3 w - -  \r\n6k1/5ppp/8/8/8/8/8/R5K1 w - -\n";
+    }
+    const std::vector<std::string> openings = loadOpenings(path);
+    ASSERT_EQ(2u, openings.size());
+    ASSERT_EQ("4k3/8/8/8/8/8/4P3/4K3 w - -", openings[0]);
+    ASSERT_EQ("6k1/5ppp/8/8/8/8/8/R5K1 w - -", openings[1]);
+
+    ASSERT_THROW(loadOpenings("/nonexistent/openings.fen"), std::string);
+}
+
+//------------------------------------------------------------------------------
+TEST(Tournament, Run)
+{
+    TournamentOptions options;
+    options.players = { PlayerType::AlphaBetaIA, PlayerType::AlphaBetaIA };
+    options.openings = { "6k1/5ppp/8/8/8/8/8/R5K1 w - -", "4k3/8/8/8/8/8/8/4K3 w - -" };
+    options.rounds = 2u;
+    options.workers = 3u;
+    options.alphabeta.limits.depth = 2u;
+    options.alphabeta.hash_mb = 1u;
+
+    ASSERT_THROW(Tournament{TournamentOptions()}, std::string);
+
+    // White mates on the first opening, draw on the second one
+    Tournament tournament(options);
+    std::stringstream ss;
+    ASSERT_TRUE(tournament.run(ss));
+    const std::vector<Standing> standings = tournament.standings();
+    ASSERT_EQ(2u, standings.size());
+    for (auto const& standing: standings)
+    {
+        ASSERT_EQ(4.0, standing.points);
+        ASSERT_EQ(8u, standing.games());
+        ASSERT_EQ(2u, standing.wins);
+        ASSERT_EQ(4u, standing.draws);
+        ASSERT_EQ(2u, standing.losses);
+        ASSERT_EQ(0u, standing.failures);
+    }
+    ASSERT_EQ("AlphaBeta", standings[0].name);
+    ASSERT_EQ("AlphaBeta#2", standings[1].name);
+    ASSERT_NE(std::string::npos, ss.str().find("Game 8/8"));
+    ASSERT_NE(std::string::npos, ss.str().find("games/min"));
+}
+
+//------------------------------------------------------------------------------
+TEST(Tournament, RunNeuNeu)
+{
+    // Concurrent games of NeuNeu players: each one trains and plays with its
+    // own random generator.
+    TournamentOptions options;
+    options.players = { PlayerType::NeuNeuIA, PlayerType::NeuNeuIA };
+    options.openings = { "4k3/8/8/8/8/8/4P3/4K3 w - -" };
+    options.rounds = 2u;
+    options.workers = 4u;
+
+    Tournament tournament(options);
+    std::stringstream ss;
+    ASSERT_TRUE(tournament.run(ss));
+    const std::vector<Standing> standings = tournament.standings();
+    ASSERT_EQ(2u, standings.size());
+    for (auto const& standing: standings)
+    {
+        ASSERT_EQ(4u, standing.games());
+        ASSERT_EQ(0u, standing.failures);
+    }
+    ASSERT_EQ(4.0, standings[0].points + standings[1].points);
+}
@@ -0,0 +1,221 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Match/UciServer.hpp"
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+//------------------------------------------------------------------------------
+static AlphaBetaOptions fastOptions()
+{
+    AlphaBetaOptions options;
+    options.hash_mb = 1u;
+    return options;
+}
+
+//------------------------------------------------------------------------------
+//! \brief Return the move of the "bestmove" line of the output.
+static std::string bestMove(std::string const& output)
+{
+    const size_t found = output.rfind("bestmove ");
+    if (found == std::string::npos)
+        return {};
+    return output.substr(found + 9u, output.find_first_of(" \n", found + 9u) - found - 9u);
+}
+
+//------------------------------------------------------------------------------
+TEST(UciServer, ParseGo)
+{
+    UciGo go = parseGo("wtime 60000 btime 30000 winc 1000 binc 0", Color::Black);
+    ASSERT_FALSE(go.infinite);
+    ASSERT_EQ(1000u, go.limits.movetime);
+    go = parseGo("wtime 60000 btime 30000 winc 1000 binc 0", Color::White);
+    ASSERT_EQ(2500u, go.limits.movetime);
+    go = parseGo("wtime 60000 btime 30000 movestogo 10", Color::White);
+    ASSERT_EQ(6000u, go.limits.movetime);
+
+    // Never more than the clock
+    go = parseGo("wtime 20 btime 20 winc 1000 binc 1000", Color::White);
+    ASSERT_EQ(10u, go.limits.movetime);
+
+    // Negative clocks once over time: move at once
+    go = parseGo("wtime -12 btime 1000", Color::White);
+    ASSERT_EQ(1u, go.limits.movetime);
+    go = parseGo("wtime -12 btime 1000", Color::Black);
+    ASSERT_EQ(33u, go.limits.movetime);
+    go = parseGo("wtime 1000 btime 1000 winc -5 movetime -3", Color::White);
+    ASSERT_EQ(1u, go.limits.movetime);
+    go = parseGo("wtime 100000000000000 btime 100000000000000", Color::White);
+    ASSERT_EQ(UINT32_MAX / 30u, go.limits.movetime);
+
+    go = parseGo("movetime 500 nodes 1000 depth 8", Color::White);
+    ASSERT_EQ(500u, go.limits.movetime);
+    ASSERT_EQ(1000u, go.limits.nodes);
+    ASSERT_EQ(8u, go.limits.depth);
+
+    // Pondering is not supported: the normal budget is used
+    go = parseGo("ponder wtime 3000 btime 3000", Color::White);
+    ASSERT_FALSE(go.infinite);
+    ASSERT_EQ(100u, go.limits.movetime);
+
+    go = parseGo("infinite", Color::White);
+    ASSERT_TRUE(go.infinite);
+    ASSERT_EQ(0u, go.limits.movetime);
+    ASSERT_EQ(0u, go.limits.nodes);
+}
+
+//------------------------------------------------------------------------------
+TEST(UciServer, Session)
+{
+    std::istringstream in("uci\nisready\nucinewgame\n"
+                          "position fen 6k1/5ppp/8/8/8/8/8/R5K1 w - - moves a1b1 g8h8\n"
+                          "go movetime 200\n");
+    std::ostringstream out;
+    UciServer(PlayerType::AlphaBetaIA, fastOptions(), in, out).run();
+
+    const std::string output = out.str();
+    ASSERT_NE(std::string::npos, output.find("id name ChessNeuNeu "));
+    ASSERT_NE(std::string::npos, output.find("uciok\n"));
+    ASSERT_NE(std::string::npos, output.find("readyok\n"));
+    ASSERT_NE(std::string::npos, output.find("info time "));
+
+    // The end of the input stops the search: the move is legal
+    Rules rules("6k1/5ppp/8/8/8/8/8/R5K1 w - -");
+    ASSERT_TRUE(rules.applyMoves("a1b1 g8h8", true));
+    ASSERT_TRUE(rules.isValidMove(bestMove(output))) << output;
+}
+
+//------------------------------------------------------------------------------
+TEST(UciServer, TooManyMoves)
+{
+    std::string moves;
+    for (uint16_t i = 0u; i <= MaxPlies / 4u; ++i)
+        moves += " g1f3 g8f6 f3g1 f6g8";
+
+    std::istringstream in;
+    std::ostringstream out;
+    UciServer server(PlayerType::AlphaBetaIA, fastOptions(), in, out);
+    ASSERT_TRUE(server.execute("position startpos moves" + moves));
+    ASSERT_NE(std::string::npos, out.str().find("info string Too many moves")) << out.str();
+}
+
+//------------------------------------------------------------------------------
+TEST(UciServer, InvalidMoves)
+{
+    std::istringstream in;
+    std::ostringstream out;
+    UciServer server(PlayerType::AlphaBetaIA, fastOptions(), in, out);
+    Rules rules;
+    ASSERT_TRUE(rules.applyMoves("e2e4", true));
+
+    // The position is rejected: the previous one is kept
+    ASSERT_TRUE(server.execute("position startpos moves e2e4"));
+    ASSERT_TRUE(server.execute("position startpos moves e2e4 e7"));
+    ASSERT_NE(std::string::npos, out.str().find("info string Invalid move: e7")) << out.str();
+    ASSERT_TRUE(server.execute("go depth 1"));
+    ASSERT_TRUE(server.execute("stop"));
+    ASSERT_TRUE(rules.isValidMove(bestMove(out.str()))) << out.str();
+
+    // "i1" would wrap to the square a8 once packed in a Move
+    ASSERT_TRUE(server.execute("position startpos moves i1a1"));
+    ASSERT_NE(std::string::npos, out.str().find("info string Invalid move: i1a1")) << out.str();
+    ASSERT_TRUE(server.execute("go depth 1"));
+    ASSERT_TRUE(server.execute("stop"));
+    ASSERT_TRUE(rules.isValidMove(bestMove(out.str()))) << out.str();
+
+    ASSERT_FALSE(Rules().applyMove(std::string("e2")));
+    ASSERT_FALSE(Rules().applyMove(std::string()));
+}
+
+//------------------------------------------------------------------------------
+TEST(UciServer, NeuNeuFirstMove)
+{
+    std::istringstream in;
+    std::ostringstream out;
+    UciServer server(PlayerType::NeuNeuIA, fastOptions(), in, out);
+
+    // The short movetime ends during the training of the networks
+    ASSERT_TRUE(server.execute("position startpos"));
+    ASSERT_TRUE(server.execute("go movetime 1"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_TRUE(server.execute("stop"));
+
+    Rules rules;
+    ASSERT_TRUE(rules.isValidMove(bestMove(out.str()))) << out.str();
+}
+
+//------------------------------------------------------------------------------
+TEST(UciServer, PonderHit)
+{
+    std::istringstream in;
+    std::ostringstream out;
+    UciServer server(PlayerType::AlphaBetaIA, fastOptions(), in, out);
+
+    // "bestmove" is given within the budget without waiting for "stop"
+    ASSERT_TRUE(server.execute("position startpos moves e2e4"));
+    ASSERT_TRUE(server.execute("go ponder movetime 100"));
+    ASSERT_TRUE(server.execute("ponderhit"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    ASSERT_TRUE(server.execute("stop"));
+
+    // The search ended long before "stop"
+    const std::string output = out.str();
+    const size_t found = output.rfind("info time ");
+    ASSERT_NE(std::string::npos, found) << output;
+    ASSERT_LT(std::stoul(output.substr(found + 10u)), 900u) << output;
+
+    Rules rules;
+    ASSERT_TRUE(rules.applyMoves("e2e4", true));
+    ASSERT_TRUE(rules.isValidMove(bestMove(output))) << output;
+}
+
+//------------------------------------------------------------------------------
+TEST(UciServer, Stop)
+{
+    std::istringstream in;
+    std::ostringstream out;
+    UciServer server(PlayerType::AlphaBetaIA, fastOptions(), in, out);
+
+    ASSERT_TRUE(server.execute("position startpos moves e2e4"));
+    ASSERT_TRUE(server.execute("go infinite"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // "stop" returns when "bestmove" has been sent
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(server.execute("stop"));
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    ASSERT_LT(ms, 500);
+
+    Rules rules;
+    ASSERT_TRUE(rules.applyMoves("e2e4", true));
+    ASSERT_TRUE(rules.isValidMove(bestMove(out.str()))) << out.str();
+    ASSERT_FALSE(server.execute("quit"));
+}
+
+//------------------------------------------------------------------------------
+TEST(UciServer, NoHuman)
+{
+    std::istringstream in;
+    std::ostringstream out;
+    ASSERT_THROW(UciServer(PlayerType::HumanPlayer, fastOptions(), in, out), std::string);
+}
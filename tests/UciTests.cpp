@@ -0,0 +1,200 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Players/EnginePool.hpp"
+#include "Players/Player.hpp"
+#include <fstream>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------------
+//! \brief Write a shell script faking a UCI engine which always answers the
+//! move e7e5 and return its path.
+static std::string fakeEngine()
+{
+    const char* path = "/tmp/ChessNeuNeu-fake-uci.sh";
+    {
+        std::ofstream file(path);
+        file << "#!/bin/sh\n"
+             << "while read cmd args; do\n"
+             << "  case \"$cmd\" in\n"
+             << "    uci) echo 'id name Fake'; echo 'uciok';;\n"
+             << "    isready) echo 'readyok';;\n"
+             << "    go) echo \"info string go $args\"; echo 'bestmove e7e5 ponder g1f3';;\n"
+             << "    quit) exit 0;;\n"
+             << "  esac\n"
+             << "done\n";
+    }
+    chmod(path, 0755);
+    return path;
+}
+
+//------------------------------------------------------------------------------
+TEST(UciSession, Position)
+{
+    Rules rules;
+    UciSession session(fakeEngine(), "", SearchLimits());
+
+    ASSERT_EQ("position startpos moves", session.position(rules));
+    ASSERT_TRUE(rules.applyMove(Move("e2e4")));
+    ASSERT_EQ("position startpos moves e2e4", session.position(rules));
+    ASSERT_TRUE(rules.applyMove(Move("e7e5")));
+    ASSERT_EQ("position startpos moves e2e4 e7e5", session.position(rules));
+
+    // Reverted moves: the command is rebuilt
+    rules.revertLastMove();
+    rules.revertLastMove();
+    ASSERT_TRUE(rules.applyMove(Move("d2d4")));
+    ASSERT_EQ("position startpos moves d2d4", session.position(rules));
+
+    // New game from a given position
+    const std::string fen("4k3/8/8/8/8/8/4P3/4K3 w - -");
+    ASSERT_TRUE(session.newGame(fen));
+    ASSERT_TRUE(rules.load(fen));
+    ASSERT_TRUE(rules.applyMove(Move("e2e4")));
+    ASSERT_EQ("position fen " + fen + " moves e2e4", session.position(rules));
+}
+
+//------------------------------------------------------------------------------
+TEST(UciSession, GoCommand)
+{
+    SearchLimits limits;
+    ASSERT_EQ("go depth 6\n", UciSession(fakeEngine(), "", limits).goCommand());
+
+    limits.movetime = 100u;
+    limits.nodes = 1000u;
+    limits.depth = 8u;
+    ASSERT_EQ("go movetime 100 nodes 1000 depth 8\n",
+              UciSession(fakeEngine(), "", limits).goCommand());
+
+    SearchLimits clock;
+    clock.time = 60000u;
+    clock.inc = 1000u;
+    ASSERT_EQ("go wtime 60000 btime 60000 winc 1000 binc 1000\n",
+              UciSession(fakeEngine(), "", clock).goCommand());
+
+    // Budget of a move combined with the limits of the session
+    SearchLimits move;
+    move.depth = 4u;
+    move.movetime = 50u;
+    ASSERT_EQ("go wtime 60000 btime 60000 winc 1000 binc 1000 movetime 50 depth 4\n",
+              UciSession(fakeEngine(), "", clock).goCommand(tightest(clock, move)));
+}
+
+//------------------------------------------------------------------------------
+TEST(UciSession, Go)
+{
+    SearchLimits limits;
+    limits.time = 60000u;
+    limits.inc = 1000u;
+
+    Rules rules;
+    ASSERT_TRUE(rules.applyMove(Move("e2e4")));
+    UciSession session(fakeEngine(), "", limits);
+
+    ASSERT_EQ("e7e5", session.go(rules));
+    ASSERT_EQ(1u, session.latency().count);
+    ASSERT_GT(session.latency().total, 0.0);
+    ASSERT_LE(session.clock(Color::Black), 61000);
+    ASSERT_GT(session.clock(Color::Black), 50000);
+    ASSERT_EQ(60000, session.clock(Color::White));
+
+    // Stop requested before the search: nothing is sent to the engine
+    StopToken token;
+    token.request();
+    SearchLimits aborted;
+    aborted.stop = &token;
+    ASSERT_STREQ(IPlayer::quitting, session.go(rules, aborted).c_str());
+    ASSERT_EQ(1u, session.latency().count);
+    ASSERT_TRUE(session.newGame(""));
+    ASSERT_EQ("e7e5", session.go(rules));
+    ASSERT_EQ(2u, session.latency().count);
+}
+
+//------------------------------------------------------------------------------
+TEST(UciSession, NoEngine)
+{
+    ASSERT_THROW(UciSession(UciEngineConfig("/bin/true"), "", SearchLimits()), std::string);
+}
+
+//------------------------------------------------------------------------------
+TEST(UciEngine, Play)
+{
+    Rules rules;
+    ASSERT_TRUE(rules.applyMove(Move("e2e4")));
+    UciEngine engine(PlayerType::StockfishIA, rules, Color::Black, "", SearchLimits(),
+                     UciEngineConfig(fakeEngine(), { { "Hash", "1" } }));
+
+    ASSERT_EQ(PlayerType::StockfishIA, engine.type());
+    ASSERT_EQ("e7e5", engine.play(SearchLimits()));
+    ASSERT_EQ(1u, engine.session().latency().count);
+}
+
+//------------------------------------------------------------------------------
+TEST(EnginePool, Lease)
+{
+    auto pool = std::make_shared<EnginePool>(UciEngineConfig(fakeEngine()), 2u);
+    ASSERT_EQ(2u, pool->size());
+    ASSERT_EQ(2u, pool->idle());
+
+    Rules rules;
+    ASSERT_TRUE(rules.applyMove(Move("e2e4")));
+    {
+        UciEngine a(PlayerType::StockfishIA, rules, Color::Black, "", SearchLimits(), pool);
+        UciEngine b(PlayerType::LokiIA, rules, Color::Black, "", SearchLimits(), pool);
+        ASSERT_EQ(0u, pool->idle());
+        ASSERT_EQ("e7e5", a.play(SearchLimits()));
+        ASSERT_EQ("e7e5", b.play(SearchLimits()));
+    }
+
+    // Engines are given back and reused
+    ASSERT_EQ(2u, pool->idle());
+    {
+        UciEngine a(PlayerType::StockfishIA, rules, Color::Black, "", SearchLimits(), pool);
+        ASSERT_EQ(1u, pool->idle());
+        // Same engine process: its statistics are kept
+        ASSERT_EQ(1u, a.session().latency().count);
+    }
+    ASSERT_EQ(0u, pool->restarts());
+
+    // Crashed engine is replaced
+    {
+        std::unique_ptr<UciSession> session = pool->acquire("", SearchLimits());
+        kill(session->pid(), SIGKILL);
+        waitpid(session->pid(), nullptr, 0);
+        pool->release(std::move(session));
+    }
+    ASSERT_EQ(1u, pool->idle());
+    {
+        UciEngine a(PlayerType::StockfishIA, rules, Color::Black, "", SearchLimits(), pool);
+        UciEngine b(PlayerType::StockfishIA, rules, Color::Black, "", SearchLimits(), pool);
+        ASSERT_EQ("e7e5", a.play(SearchLimits()));
+        ASSERT_EQ("e7e5", b.play(SearchLimits()));
+    }
+    ASSERT_EQ(1u, pool->restarts());
+    ASSERT_EQ(2u, pool->idle());
+}
+
+//------------------------------------------------------------------------------
+TEST(EnginePool, NoEngine)
+{
+    ASSERT_THROW(EnginePool(UciEngineConfig("/nonexistent/engine"), 2u), std::string);
+    ASSERT_TRUE(createEnginePools({ { PlayerType::AlphaBetaIA, 2u } }).empty());
+}
@@ -0,0 +1,84 @@
+//=====================================================================
+// ChessNeuNeu: Non serious chess engine for learning neural networks.
+// Copyright 2018 -- 2022 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of ChessNeuNeu.
+//
+// ChessNeuNeu is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+//=====================================================================
+
+#include "main.hpp"
+#include "Chess/Perft.hpp"
+
+//------------------------------------------------------------------------------
+//! \brief Walk the tree of moves and check the incremental key against the
+//! key computed from scratch.
+//------------------------------------------------------------------------------
+static void checkHash(Rules& rules, const uint8_t depth)
+{
+    ASSERT_EQ(rules.computeHash(), rules.hash());
+    if (depth == 0u)
+        return ;
+
+    const MoveList moves = rules.generateValidMoves();
+    for (auto const& move: moves)
+    {
+        const uint64_t hash = rules.hash();
+        rules.makeMove(move);
+        ASSERT_NE(hash, rules.hash());
+        checkHash(rules, uint8_t(depth - 1u));
+        rules.unmakeMove();
+        ASSERT_EQ(hash, rules.hash());
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(Zobrist, Incremental)
+{
+    // Perft positions have castles, en-passant and promotions
+    for (auto const& position: c_perft_suite)
+    {
+        Rules rules(position.fen);
+        checkHash(rules, 2u);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(Zobrist, Transpositions)
+{
+    Rules rules;
+    const uint64_t initial = rules.hash();
+
+    // Same position reached by different moves
+    ASSERT_EQ(true, rules.applyMoves("g1f3 g8f6 f3g1 f6g8", false));
+    ASSERT_EQ(initial, rules.hash());
+
+    Rules other;
+    ASSERT_EQ(true, rules.applyMoves("e2e3 e7e6 d2d3", true));
+    ASSERT_EQ(true, other.applyMoves("d2d3 e7e6 e2e3", true));
+    ASSERT_EQ(other.hash(), rules.hash());
+
+    // Same pieces but different side, castle rights or en-passant
+    ASSERT_NE(Rules("4k3/8/8/8/8/8/8/4K3 w - -").hash(), Rules("4k3/8/8/8/8/8/8/4K3 b - -").hash());
+    ASSERT_NE(Rules("r3k3/8/8/8/8/8/8/4K3 w q -").hash(), Rules("r3k3/8/8/8/8/8/8/4K3 w - -").hash());
+    ASSERT_NE(Rules("4k3/8/8/3pP3/8/8/8/4K3 w - d6").hash(), Rules("4k3/8/8/3pP3/8/8/8/4K3 w - -").hash());
+
+    // Revert restores the key
+    ASSERT_EQ(true, rules.load("r3k2r/8/8/8/8/8/8/R3K2R w KQkq -"));
+    const uint64_t castles = rules.hash();
+    ASSERT_EQ(true, rules.applyMoves("e1g1 e8c8", false));
+    rules.revertLastMove();
+    rules.revertLastMove();
+    ASSERT_EQ(castles, rules.hash());
+}